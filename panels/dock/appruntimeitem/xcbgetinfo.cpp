@@ -1,73 +1,30 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "xcbgetinfo.h"
+#include "xcbeventhub.h"
 #include <QDebug>
-#include <QPointer>
 #include <QCoreApplication>
 
 #define X11 X11Utils::instance()
 
 namespace dock {
-static QPointer<XcbGetInfo> xcbgetinfo;
-
-bool XcbEventFilter::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *)
-{
-    if (eventType != "xcb_generic_event_t")
-        return false;
-
-    auto xcb_event = reinterpret_cast<xcb_generic_event_t*>(message);
-    switch (xcb_event->response_type) {
-    case XCB_PROPERTY_NOTIFY: {
-        auto pE = reinterpret_cast<xcb_property_notify_event_t*>(xcb_event);
-        Q_EMIT xcbgetinfo->windowPropertyChanged(pE->window, pE->atom);
-        break;
-    }
-    case XCB_CREATE_NOTIFY: {
-        auto e = reinterpret_cast<xcb_create_notify_event_t*>(xcb_event);
-        Q_EMIT xcbgetinfo->eventFilterWindowCreated(e);
-        break;
-    }
-    case XCB_DESTROY_NOTIFY: {
-        auto e = reinterpret_cast<xcb_destroy_notify_event_t*>(xcb_event);
-        Q_EMIT xcbgetinfo->eventFilterWindowDestroyed(e);
-    }
-    case XCB_ENTER_NOTIFY: {
-        auto eN = reinterpret_cast<xcb_enter_notify_event_t *>(xcb_event);
-        Q_EMIT xcbgetinfo->windowEnterChanged(eN->event);
-        break;
-    }
-    case XCB_LEAVE_NOTIFY: {
-        auto lN = reinterpret_cast<xcb_leave_notify_event_t *>(xcb_event);
-        Q_EMIT xcbgetinfo->windowLeaveChanged(lN->event);
-        break;
-    }
-    }
-    return false;
-}
-
 XcbGetInfo::XcbGetInfo()
 {
-    xcbgetinfo = this;
-    connect(this, &XcbGetInfo::windowEnterChanged, this, &XcbGetInfo::handleEnterEvent);
-    connect(this, &XcbGetInfo::windowLeaveChanged, this, &XcbGetInfo::handleLeaveEvent);
-    connect(this, &XcbGetInfo::windowPropertyChanged, this, &XcbGetInfo::handlePropertyNotifyEvent);
-    connect(this, &XcbGetInfo::eventFilterWindowCreated, this, &XcbGetInfo::handleCreateNotifyEvent);
-    connect(this, &XcbGetInfo::eventFilterWindowDestroyed, this, &XcbGetInfo::handleDestroyNotifyEvent);
 }
 
 int XcbGetInfo::startGetinfo()
 {
-    uint32_t value_list[] = {
-        0                               | XCB_EVENT_MASK_PROPERTY_CHANGE        |
-        XCB_EVENT_MASK_VISIBILITY_CHANGE    | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY    |
-        XCB_EVENT_MASK_STRUCTURE_NOTIFY     | XCB_EVENT_MASK_FOCUS_CHANGE
-    };
-    xcb_change_window_attributes(X11->getXcbConnection(), X11->getRootWindow(), XCB_CW_EVENT_MASK, value_list);
-    xcb_flush(X11->getXcbConnection());
-    m_xcbEventGet.reset(new XcbEventFilter());
-    qApp->installNativeEventFilter(m_xcbEventGet.get());
+    // the root window events are selected by the hub.
+    auto hub = XcbEventHub::instance();
+    connect(hub, &XcbEventHub::windowEntered, this, &XcbGetInfo::handleEnterEvent);
+    connect(hub, &XcbEventHub::windowLeft, this, &XcbGetInfo::handleLeaveEvent);
+    connect(hub, &XcbEventHub::windowCreated, this, &XcbGetInfo::handleCreateNotifyEvent);
+    connect(hub, &XcbEventHub::windowDestroyed, this, &XcbGetInfo::handleDestroyNotifyEvent);
+    hub->subscribeProperty(this, XCB_WINDOW_NONE, X11->atom(NetWmStateAtom), [this](xcb_window_t window, xcb_atom_t atom) {
+        handlePropertyNotifyEvent(window, atom);
+    });
     return 0;
 }
 
@@ -84,20 +41,20 @@ void XcbGetInfo::handleLeaveEvent(xcb_window_t window)
 
 }
 
-void XcbGetInfo::handleCreateNotifyEvent(xcb_create_notify_event_t *e)
+void XcbGetInfo::handleCreateNotifyEvent(xcb_window_t window, bool overrideRedirect)
 {
-    if (!e->override_redirect) {
-        addWindows(e->window);
-        QString name = m_windows.value(e->window)->title();
+    if (!overrideRedirect) {
+        addWindows(window);
+        QString name = m_windows.value(window)->title();
         if (!name.isEmpty()) {
-            Q_EMIT windowInfoChangedForeground(name, e->window);
+            Q_EMIT windowInfoChangedForeground(name, window);
         }
     }
 }
 
-void XcbGetInfo::handleDestroyNotifyEvent(xcb_destroy_notify_event_t *e)
+void XcbGetInfo::handleDestroyNotifyEvent(xcb_window_t window)
 {
-    Q_EMIT windowDestroyChanged(e->window);
+    Q_EMIT windowDestroyChanged(window);
 }
 
 void XcbGetInfo::handlePropertyNotifyEvent(xcb_window_t window, xcb_atom_t atom)
@@ -108,7 +65,7 @@ void XcbGetInfo::handlePropertyNotifyEvent(xcb_window_t window, xcb_atom_t atom)
         return;
     }
 
-    if (atom == X11->getAtomByName("_NET_WM_STATE")) {
+    if (atom == X11->atom(NetWmStateAtom)) {
         x11Window->updateWindowState();
     }
 }
@@ -146,15 +103,14 @@ void XcbGetInfo::addWindows(xcb_window_t window)
     window_get = QSharedPointer<X11Window>{new X11Window(window, this)};
     m_windows.insert(window, window_get);
     connect(m_windows[window].get(), &AbstractWindow::stateChanged, this, [window, this](){
-        if(m_windows[window]->m_windowStates.contains(X11->getAtomByName("_NET_WM_STATE_FOCUSED"))) {
+        if(m_windows[window]->m_windowStates.contains(X11->atom(NetWmStateFocusedAtom))) {
             Q_EMIT windowEnterChangedActiveName(window,X11->getWindowName(window));
         }
         else {
             Q_EMIT windowLeaveChangedInactiveName(window,X11->getWindowName(window));
         }
     });
-    uint32_t value_list[] = { XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE};
-    xcb_change_window_attributes(X11->getXcbConnection(), window, XCB_CW_EVENT_MASK, value_list);
+    XcbEventHub::instance()->selectWindowEvents(window);
 }
 
 }
@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "xcbeventhub.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+
+#include <QGuiApplication>
+#include <QLoggingCategory>
+#include <QSet>
+#include <QTimer>
+
+Q_LOGGING_CATEGORY(xcbEventHubLog, "org.deepin.dde.shell.dock.xcbeventhub")
+
+namespace dock {
+
+XcbEventHub *XcbEventHub::instance()
+{
+    static XcbEventHub *hub = nullptr;
+    if (hub == nullptr) {
+        hub = new XcbEventHub();
+    }
+    return hub;
+}
+
+XcbEventHub::XcbEventHub()
+    : QObject(qApp)
+{
+    auto *x11Application = qGuiApp->nativeInterface<QNativeInterface::QX11Application>();
+    m_connection = x11Application->connection();
+
+    const xcb_setup_t *setup = xcb_get_setup(m_connection);
+    xcb_screen_iterator_t iter = xcb_setup_roots_iterator(setup);
+    m_rootWindow = iter.data->root;
+
+    xcb_ewmh_init_atoms_replies(&m_ewmh, xcb_ewmh_init_atoms(m_connection, &m_ewmh), nullptr);
+
+    uint32_t value_list[] = {
+            0                               | XCB_EVENT_MASK_PROPERTY_CHANGE        |
+            XCB_EVENT_MASK_VISIBILITY_CHANGE    | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY    |
+            XCB_EVENT_MASK_STRUCTURE_NOTIFY     | XCB_EVENT_MASK_FOCUS_CHANGE
+    };
+    xcb_change_window_attributes(m_connection, m_rootWindow, XCB_CW_EVENT_MASK, value_list);
+    xcb_flush(m_connection);
+
+    updateClientList();
+    qApp->installNativeEventFilter(this);
+}
+
+XcbEventHub::~XcbEventHub()
+{
+    qApp->removeNativeEventFilter(this);
+    xcb_ewmh_connection_wipe(&m_ewmh);
+}
+
+xcb_connection_t *XcbEventHub::connection() const
+{
+    return m_connection;
+}
+
+xcb_window_t XcbEventHub::rootWindow() const
+{
+    return m_rootWindow;
+}
+
+xcb_ewmh_connection_t *XcbEventHub::ewmh()
+{
+    return &m_ewmh;
+}
+
+xcb_atom_t XcbEventHub::atom(const QByteArray &name)
+{
+    return atoms({name}).first();
+}
+
+QList<xcb_atom_t> XcbEventHub::atoms(const QList<QByteArray> &names)
+{
+    // all the requests are sent before waiting for any reply.
+    QList<xcb_intern_atom_cookie_t> cookies(names.size());
+    for (int i = 0; i < names.size(); ++i) {
+        if (!m_atoms.contains(names[i])) {
+            cookies[i] = xcb_intern_atom(m_connection, false, names[i].size(), names[i].constData());
+        }
+    }
+
+    QList<xcb_atom_t> ret(names.size(), XCB_ATOM_NONE);
+    for (int i = 0; i < names.size(); ++i) {
+        auto iter = m_atoms.constFind(names[i]);
+        if (iter != m_atoms.constEnd()) {
+            ret[i] = iter.value();
+            continue;
+        }
+
+        std::unique_ptr<xcb_intern_atom_reply_t, decltype(&free)> reply(xcb_intern_atom_reply(m_connection, cookies[i], nullptr), &free);
+        if (!reply) {
+            qCWarning(xcbEventHubLog) << "failed to intern atom" << names[i];
+            continue;
+        }
+        ret[i] = reply->atom;
+        m_atoms.insert(names[i], reply->atom);
+        m_atomNames.insert(reply->atom, names[i]);
+    }
+    return ret;
+}
+
+QByteArray XcbEventHub::atomName(xcb_atom_t atom)
+{
+    auto iter = m_atomNames.constFind(atom);
+    if (iter != m_atomNames.constEnd())
+        return iter.value();
+
+    xcb_get_atom_name_cookie_t cookie = xcb_get_atom_name(m_connection, atom);
+    std::unique_ptr<xcb_get_atom_name_reply_t, decltype(&free)> reply(xcb_get_atom_name_reply(m_connection, cookie, nullptr), &free);
+    if (!reply) {
+        qCWarning(xcbEventHubLog) << "failed to get the name of atom" << atom;
+        return {};
+    }
+
+    const QByteArray name(xcb_get_atom_name_name(reply.get()), xcb_get_atom_name_name_length(reply.get()));
+    if (!name.isEmpty()) {
+        m_atoms.insert(name, atom);
+        m_atomNames.insert(atom, name);
+    }
+    return name;
+}
+
+void XcbEventHub::subscribeProperty(QObject *context, xcb_window_t window, xcb_atom_t atom, PropertyHandler handler)
+{
+    Q_ASSERT(context);
+    m_subscribers[qMakePair(window, atom)].append(Subscriber{context, std::move(handler)});
+
+    if (!m_contexts.contains(context)) {
+        m_contexts.insert(context, connect(context, &QObject::destroyed, this, [this, context]() {
+            unsubscribe(context);
+        }));
+    }
+}
+
+void XcbEventHub::unsubscribe(QObject *context)
+{
+    auto connection = m_contexts.take(context);
+    if (!connection)
+        return;
+
+    disconnect(connection);
+    for (auto iter = m_subscribers.begin(); iter != m_subscribers.end();) {
+        iter->removeIf([context](const Subscriber &subscriber) {
+            return subscriber.context == context;
+        });
+        if (iter->isEmpty()) {
+            iter = m_subscribers.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void XcbEventHub::selectWindowEvents(xcb_window_t window)
+{
+    uint32_t value_list[] = { XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE };
+    xcb_change_window_attributes(m_connection, window, XCB_CW_EVENT_MASK, value_list);
+}
+
+QList<xcb_window_t> XcbEventHub::clientList() const
+{
+    return m_clientList;
+}
+
+bool XcbEventHub::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *)
+{
+    if (eventType != "xcb_generic_event_t")
+        return false;
+
+    auto xcb_event = reinterpret_cast<xcb_generic_event_t *>(message);
+    switch (xcb_event->response_type & ~0x80) {
+    case XCB_PROPERTY_NOTIFY: {
+        auto pE = reinterpret_cast<xcb_property_notify_event_t *>(xcb_event);
+        handlePropertyNotify(pE->window, pE->atom);
+        break;
+    }
+    case XCB_CREATE_NOTIFY: {
+        auto cE = reinterpret_cast<xcb_create_notify_event_t *>(xcb_event);
+        Q_EMIT windowCreated(cE->window, cE->override_redirect);
+        break;
+    }
+    case XCB_DESTROY_NOTIFY: {
+        auto dE = reinterpret_cast<xcb_destroy_notify_event_t *>(xcb_event);
+        Q_EMIT windowDestroyed(dE->window);
+        break;
+    }
+    case XCB_CONFIGURE_NOTIFY: {
+        auto cE = reinterpret_cast<xcb_configure_notify_event_t *>(xcb_event);
+        Q_EMIT windowConfigured(cE->window);
+        break;
+    }
+    case XCB_ENTER_NOTIFY: {
+        auto eN = reinterpret_cast<xcb_enter_notify_event_t *>(xcb_event);
+        Q_EMIT windowEntered(eN->event);
+        break;
+    }
+    case XCB_LEAVE_NOTIFY: {
+        auto lN = reinterpret_cast<xcb_leave_notify_event_t *>(xcb_event);
+        Q_EMIT windowLeft(lN->event);
+        break;
+    }
+    }
+    return false;
+}
+
+void XcbEventHub::handlePropertyNotify(xcb_window_t window, xcb_atom_t atom)
+{
+    if (window == m_rootWindow && atom == m_ewmh._NET_CLIENT_LIST) {
+        // a burst of changes is diffed once, in the next iteration of the event loop.
+        if (!m_clientListPending) {
+            m_clientListPending = true;
+            QTimer::singleShot(0, this, &XcbEventHub::updateClientList);
+        }
+    }
+
+    if (m_subscribers.isEmpty())
+        return;
+
+    // the subscribers of the window and the atom, of the window, of the atom and of all events.
+    const QPair<xcb_window_t, xcb_atom_t> keys[] = {
+        {window, atom},
+        {window, XCB_ATOM_NONE},
+        {XCB_WINDOW_NONE, atom},
+        {XCB_WINDOW_NONE, XCB_ATOM_NONE},
+    };
+    for (const auto &key : keys) {
+        auto iter = m_subscribers.constFind(key);
+        if (iter == m_subscribers.constEnd())
+            continue;
+
+        // a handler may unsubscribe, the list is copied.
+        const auto subscribers = iter.value();
+        for (const auto &subscriber : subscribers) {
+            if (m_contexts.contains(subscriber.context)) {
+                subscriber.handler(window, atom);
+            }
+        }
+    }
+}
+
+void XcbEventHub::updateClientList()
+{
+    m_clientListPending = false;
+
+    QList<xcb_window_t> clientList;
+    xcb_get_property_cookie_t cookie = xcb_ewmh_get_client_list(&m_ewmh, 0);
+    xcb_ewmh_get_windows_reply_t reply;
+    if (xcb_ewmh_get_client_list_reply(&m_ewmh, cookie, &reply, nullptr)) {
+        for (uint32_t i = 0; i < reply.windows_len; i++) {
+            clientList.push_back(reply.windows[i]);
+        }
+        xcb_ewmh_get_windows_reply_wipe(&reply);
+    }
+    auto sortedClientList = clientList;
+    std::sort(sortedClientList.begin(), sortedClientList.end());
+    sortedClientList.erase(std::unique(sortedClientList.begin(), sortedClientList.end()), sortedClientList.end());
+
+    // both sorted lists are diffed linearly, the added windows are reported in the order of the client list.
+    QList<xcb_window_t> sortedAdded;
+    QList<xcb_window_t> removed;
+    std::set_difference(sortedClientList.cbegin(), sortedClientList.cend(), m_sortedClientList.cbegin(), m_sortedClientList.cend(),
+                        std::back_inserter(sortedAdded));
+    std::set_difference(m_sortedClientList.cbegin(), m_sortedClientList.cend(), sortedClientList.cbegin(), sortedClientList.cend(),
+                        std::back_inserter(removed));
+
+    // a window listed twice is kept at its first position.
+    if (sortedClientList.size() != clientList.size()) {
+        QSet<xcb_window_t> windows;
+        clientList.removeIf([&windows](xcb_window_t window) {
+            if (windows.contains(window))
+                return true;
+            windows.insert(window);
+            return false;
+        });
+    }
+
+    QList<xcb_window_t> added;
+    if (!sortedAdded.isEmpty()) {
+        for (auto window : std::as_const(clientList)) {
+            if (std::binary_search(sortedAdded.cbegin(), sortedAdded.cend(), window))
+                added.push_back(window);
+        }
+    }
+    m_clientList = clientList;
+    m_sortedClientList = sortedClientList;
+
+    if (!added.isEmpty() || !removed.isEmpty()) {
+        Q_EMIT clientListChanged(added, removed);
+    }
+}
+
+}
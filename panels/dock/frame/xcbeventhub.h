@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "dsglobal.h"
+
+#include <functional>
+#include <xcb/xcb.h>
+#include <xcb/xcb_ewmh.h>
+#include <xcb/xproto.h>
+
+#include <QAbstractNativeEventFilter>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+
+namespace dock {
+// The only native event filter of X11 events in the shell process, it's shared by the dock and its plugins.
+// Every event is decoded once and delivered to the subscribers of its window and atom,
+// the connection, the EWMH atoms and the cache of interned atoms are shared too.
+class DS_SHARE XcbEventHub : public QObject, public QAbstractNativeEventFilter
+{
+    Q_OBJECT
+public:
+    using PropertyHandler = std::function<void(xcb_window_t window, xcb_atom_t atom)>;
+
+    static XcbEventHub *instance();
+
+    xcb_connection_t *connection() const;
+    xcb_window_t rootWindow() const;
+    xcb_ewmh_connection_t *ewmh();
+
+    // the atoms which aren't cached yet are interned in one batch.
+    xcb_atom_t atom(const QByteArray &name);
+    QList<xcb_atom_t> atoms(const QList<QByteArray> &names);
+    QByteArray atomName(xcb_atom_t atom);
+
+    // XCB_WINDOW_NONE subscribes to all windows and XCB_ATOM_NONE to all atoms,
+    // the subscriptions of the context are removed when it's destroyed.
+    void subscribeProperty(QObject *context, xcb_window_t window, xcb_atom_t atom, PropertyHandler handler);
+    void unsubscribe(QObject *context);
+    // selects the events of a client window needed by the subscribers.
+    void selectWindowEvents(xcb_window_t window);
+
+    // windows of the root _NET_CLIENT_LIST, in the order of the property, i.e. the mapping order.
+    QList<xcb_window_t> clientList() const;
+
+    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *) override;
+
+Q_SIGNALS:
+    // the changes of the client list since the last signal, added windows are in the order of the client list,
+    // removed ones are sorted by the id.
+    void clientListChanged(const QList<xcb_window_t> &added, const QList<xcb_window_t> &removed);
+    void windowCreated(xcb_window_t window, bool overrideRedirect);
+    void windowDestroyed(xcb_window_t window);
+    void windowConfigured(xcb_window_t window);
+    void windowEntered(xcb_window_t window);
+    void windowLeft(xcb_window_t window);
+
+private:
+    XcbEventHub();
+    ~XcbEventHub() override;
+
+    void handlePropertyNotify(xcb_window_t window, xcb_atom_t atom);
+    void updateClientList();
+
+private:
+    struct Subscriber
+    {
+        QObject *context;
+        PropertyHandler handler;
+    };
+
+    xcb_connection_t *m_connection;
+    xcb_window_t m_rootWindow;
+    xcb_ewmh_connection_t m_ewmh;
+    QHash<QByteArray, xcb_atom_t> m_atoms;
+    QHash<xcb_atom_t, QByteArray> m_atomNames;
+
+    QHash<QPair<xcb_window_t, xcb_atom_t>, QList<Subscriber>> m_subscribers;
+    // connections to the destroyed signal of the subscribed contexts.
+    QHash<QObject *, QMetaObject::Connection> m_contexts;
+
+    QList<xcb_window_t> m_clientList;
+    // the client list sorted by the id, it's diffed with the next one.
+    QList<xcb_window_t> m_sortedClientList;
+    bool m_clientListPending = false;
+};
+}
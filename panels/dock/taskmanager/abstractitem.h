@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -19,7 +19,7 @@ class AbstractItem : public QObject
 
     Q_PROPERTY(QString name READ name NOTIFY nameChanged FINAL)
     Q_PROPERTY(QString menus READ menus NOTIFY menusChanged FINAL)
-    Q_PROPERTY(QString icon READ icon NOTIFY iconChanged FINAL)
+    Q_PROPERTY(QString icon READ dbusIcon NOTIFY iconChanged FINAL)
 
     Q_PROPERTY(bool isActive READ isActive NOTIFY activeChanged FINAL)
     Q_PROPERTY(bool isAttention READ isAttention  NOTIFY attentionChanged FINAL)
@@ -44,6 +44,8 @@ public:
     virtual ItemType itemType() const = 0;
 
     virtual QString icon() const = 0;
+    // the icon exported on D-Bus, icon() may be an url only served in the process.
+    virtual QString dbusIcon() const { return icon(); }
     virtual QString name() const = 0;
     virtual QString menus() const = 0;
 
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -30,6 +30,8 @@ public:
     virtual pid_t pid() = 0;
     virtual QStringList identity() = 0;
     virtual QString icon() = 0;
+    // the icon exported on D-Bus, icon() may be an url only served in the process.
+    virtual QString dbusIcon() { return icon(); }
     virtual QString title() = 0;
     virtual bool isActive() = 0;
     virtual bool allowClose() = 0;
@@ -7,6 +7,8 @@
 #include "globals.h"
 #include "taskmanager.h"
 
+#include <utility>
+
 namespace dock {
 AbstractWindowMonitor::AbstractWindowMonitor(QObject *parent)
     : QAbstractListModel(parent)
@@ -115,44 +117,69 @@ void AbstractWindowMonitor::trackWindow(AbstractWindow* window)
     endInsertRows();
 
     connect(window, &AbstractWindow::pidChanged, this, [this, window]() {
-        auto pos = m_trackedWindows.indexOf(window);
-        auto modelIndex = index(pos);
-        Q_EMIT dataChanged(modelIndex, modelIndex, {TaskManager::PidRole});
+        windowDataChanged(window, {TaskManager::PidRole});
     });
     connect(window, &AbstractWindow::identityChanged, this, [this, window]() {
-        auto pos = m_trackedWindows.indexOf(window);
-        auto modelIndex = index(pos);
-        Q_EMIT dataChanged(modelIndex, modelIndex, {TaskManager::IdentityRole});
+        windowDataChanged(window, {TaskManager::IdentityRole});
     });
     connect(window, &AbstractWindow::iconChanged, this, [this, window]() {
-        auto pos = m_trackedWindows.indexOf(window);
-        auto modelIndex = index(pos);
-        Q_EMIT dataChanged(modelIndex, modelIndex, {TaskManager::WinIconRole});
+        windowDataChanged(window, {TaskManager::WinIconRole});
     });
     connect(window, &AbstractWindow::titleChanged, this, [this, window]() {
-        auto pos = m_trackedWindows.indexOf(window);
-        auto modelIndex = index(pos);
-        Q_EMIT dataChanged(modelIndex, modelIndex, {TaskManager::WinTitleRole});
+        windowDataChanged(window, {TaskManager::WinTitleRole});
     });
 
     connect(window, &AbstractWindow::stateChanged, this, [this, window]() {
-        auto pos = m_trackedWindows.indexOf(window);
-        auto modelIndex = index(pos);
-        Q_EMIT dataChanged(modelIndex, modelIndex, {TaskManager::ActiveRole, TaskManager::AttentionRole});
+        windowDataChanged(window, {TaskManager::ActiveRole, TaskManager::AttentionRole});
     });
     connect(window, &AbstractWindow::shouldSkipChanged, this, [this, window]() {
-        auto pos = m_trackedWindows.indexOf(window);
-        auto modelIndex = index(pos);
-        Q_EMIT dataChanged(modelIndex, modelIndex, {TaskManager::ShouldSkipRole});
+        windowDataChanged(window, {TaskManager::ShouldSkipRole});
     });
 }
 
+void AbstractWindowMonitor::beginWindowUpdate()
+{
+    m_updatingWindows = true;
+}
+
+void AbstractWindowMonitor::endWindowUpdate()
+{
+    m_updatingWindows = false;
+    const auto pendingRoles = std::exchange(m_pendingRoles, {});
+    for (auto iter = pendingRoles.cbegin(); iter != pendingRoles.cend(); ++iter) {
+        auto pos = m_trackedWindows.indexOf(iter.key());
+        if (pos == -1)
+            continue;
+
+        auto modelIndex = index(pos);
+        Q_EMIT dataChanged(modelIndex, modelIndex, iter.value());
+    }
+}
+
+void AbstractWindowMonitor::windowDataChanged(AbstractWindow *window, const QList<int> &roles)
+{
+    // changes of a window in an update are merged into one notification.
+    if (m_updatingWindows) {
+        auto &pendingRoles = m_pendingRoles[window];
+        for (auto role : roles) {
+            if (!pendingRoles.contains(role))
+                pendingRoles.append(role);
+        }
+        return;
+    }
+
+    auto pos = m_trackedWindows.indexOf(window);
+    auto modelIndex = index(pos);
+    Q_EMIT dataChanged(modelIndex, modelIndex, roles);
+}
+
 void AbstractWindowMonitor::destroyWindow(AbstractWindow * window)
 {
     auto pos = m_trackedWindows.indexOf(window);
     if (pos == -1)
         return;
 
+    m_pendingRoles.remove(window);
     beginRemoveRows(QModelIndex(), pos, pos);
     m_trackedWindows.removeAt(pos);
     endRemoveRows();
@@ -165,6 +192,7 @@ void AbstractWindowMonitor::clearTrackedWindows()
 
     beginResetModel();
     m_trackedWindows.clear();
+    m_pendingRoles.clear();
     endResetModel();
 }
 }
@@ -27,6 +27,9 @@ public:
     void trackWindow(AbstractWindow* window);
     void destroyWindow(AbstractWindow * window);
     void clearTrackedWindows();
+    // dataChanged of the windows updated in between is emitted once per window with the merged roles.
+    void beginWindowUpdate();
+    void endWindowUpdate();
 
     AbstractWindowMonitor(QObject* parent = nullptr);
     virtual void start() = 0;
@@ -58,7 +61,12 @@ Q_SIGNALS:
     void WindowMonitorShutdown();
     void previewShouldClear();
 
+private:
+    void windowDataChanged(AbstractWindow *window, const QList<int> &roles);
+
 private:
     QList<AbstractWindow*> m_trackedWindows;
+    bool m_updatingWindows = false;
+    QHash<AbstractWindow *, QList<int>> m_pendingRoles;
 };
 }
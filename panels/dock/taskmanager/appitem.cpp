@@ -70,6 +70,14 @@ QString AppItem::icon() const
     // return icon;
 }
 
+QString AppItem::dbusIcon() const
+{
+    const auto ret = icon();
+    if (!m_currentActiveWindow.isNull() && ret == m_currentActiveWindow->icon())
+        return m_currentActiveWindow->dbusIcon();
+    return ret;
+}
+
 QString AppItem::name() const
 {
     if (m_desktopfileParser && !m_desktopfileParser.isNull())
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -28,6 +28,7 @@ public:
     QString id() const override;
     QString type() const override;
     QString icon() const override;
+    QString dbusIcon() const override;
     QString name() const override;
     QString menus() const override;
 
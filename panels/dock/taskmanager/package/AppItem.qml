@@ -149,7 +149,9 @@ Item {
 
             D.DciIcon {
                 id: icon
-                name: root.iconName
+                // icons of windows are served by the image provider, others are icon names.
+                readonly property bool isWindowIcon: root.iconName.startsWith("image://")
+                name: isWindowIcon ? "" : root.iconName
                 height: iconSize
                 width: iconSize
                 sourceSize: Qt.size(iconSize, iconSize)
@@ -157,6 +159,15 @@ Item {
                 retainWhileLoading: true
                 smooth: false
 
+                Image {
+                    anchors.fill: parent
+                    visible: icon.isWindowIcon
+                    source: icon.isWindowIcon ? root.iconName : ""
+                    sourceSize: icon.sourceSize
+                    fillMode: Image.PreserveAspectFit
+                    smooth: false
+                }
+
                 function mapToScene(px, py) {
                     return parent.mapToItem(Window.window.contentItem, Qt.point(px, py))
                 }
@@ -34,10 +34,12 @@
 #include <QtQml/QtQml>
 
 #include <appletbridge.h>
+#include <qmlengine.h>
 #include <DSGApplication>
 
 #ifdef BUILD_WITH_X11
 #include "x11windowmonitor.h"
+#include "x11windowiconprovider.h"
 #include "x11utils.h"
 #endif
 
@@ -165,6 +167,7 @@ bool TaskManager::load()
 #ifdef BUILD_WITH_X11
     else if (QStringLiteral("xcb") == platformName) {
         m_windowMonitor.reset(new X11WindowMonitor());
+        X11WindowIconProvider::registerTo(DS_NAMESPACE::DQmlEngine().engine());
     }
 #endif
 
@@ -7,6 +7,7 @@
 #include "appitem.h"
 #include "taskmanager.h"
 #include "x11utils.h"
+#include "x11windowiconstore.h"
 #include "x11windowmonitor.h"
 
 #include <cstdint>
@@ -801,7 +802,15 @@ void X11WindowPreviewContainer::updatePreviewIconFromString(const QString &strin
 {
     QPixmap pix;
     const QStringList strs = stringData.split("base64,");
-    if (strs.size() == 2) {
+    const QString windowIconId = X11WindowIconStore::idOfUrl(stringData);
+    if (!windowIconId.isEmpty()) {
+        // is raw window icon, the entry matching the title height is taken
+        const int scaledSize = PREVIEW_TITLE_HEIGHT * qApp->devicePixelRatio();
+        QImage image = X11WindowIconStore::instance()->image(windowIconId, QSize(scaledSize, scaledSize));
+        if (!image.isNull() && image.size() != QSize(scaledSize, scaledSize))
+            image = image.scaled(scaledSize, scaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        pix = QPixmap::fromImage(image);
+    } else if (strs.size() == 2) {
         // is base64 image data
         pix.loadFromData(QByteArray::fromBase64(strs.at(1).toLatin1()));
     } else {
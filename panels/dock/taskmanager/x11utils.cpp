@@ -3,9 +3,15 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "x11utils.h"
+#include "x11windowiconstore.h"
+#include "xcbeventhub.h"
 
 #include <cstddef>
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
 #include <unistd.h>
 #include <xcb/xcb.h>
 #include <xcb/res.h>
@@ -15,8 +21,6 @@
 #include <xcb/xcb_icccm.h>
 
 #include <QList>
-#include <QImage>
-#include <QBuffer>
 #include <QGuiApplication>
 #include <QLoggingCategory>
 
@@ -24,6 +28,46 @@ Q_LOGGING_CATEGORY(x11UtilsLog, "org.deepin.dde.shell.dock.taskmanager.x11utils"
 
 namespace dock {
 
+// in the order of WellKnownAtom.
+static const char *const WellKnownAtomNames[] = {
+    "WM_CLASS",
+    "WM_CHANGE_STATE",
+    "UTF8_STRING",
+    "_MOTIF_WM_HINTS",
+    "_GTK_FRAME_EXTENTS",
+    "_NET_CLIENT_LIST",
+    "_NET_FRAME_EXTENTS",
+    "_NET_WM_PID",
+    "_NET_WM_NAME",
+    "_NET_WM_ICON",
+    "_NET_WM_STATE",
+    "_NET_WM_STATE_FOCUSED",
+    "_NET_WM_STATE_HIDDEN",
+    "_NET_WM_STATE_MODAL",
+    "_NET_WM_STATE_SKIP_TASKBAR",
+    "_NET_WM_STATE_DEMANDS_ATTENTION",
+    "_NET_WM_STATE_MAXIMIZED_VERT",
+    "_NET_WM_STATE_MAXIMIZED_HORZ",
+    "_NET_WM_ALLOWED_ACTIONS",
+    "_NET_WM_ACTION_CLOSE",
+    "_NET_WM_ACTION_MINIMIZE",
+    "_NET_WM_WINDOW_TYPE",
+    "_NET_WM_WINDOW_TYPE_DIALOG",
+    "_NET_WM_WINDOW_TYPE_UTILITY",
+    "_NET_WM_WINDOW_TYPE_COMBO",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_DND",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU",
+    "_NET_WM_WINDOW_TYPE_MENU",
+    "_NET_WM_WINDOW_TYPE_NOTIFICATION",
+    "_NET_WM_WINDOW_TYPE_POPUP_MENU",
+    "_NET_WM_WINDOW_TYPE_SPLASH",
+    "_NET_WM_WINDOW_TYPE_TOOLBAR",
+    "_NET_WM_WINDOW_TYPE_TOOLTIP",
+};
+static_assert(std::size(WellKnownAtomNames) == WellKnownAtomCount, "a name is needed for every well-known atom");
+
 X11Utils* X11Utils::instance()
 {
     static X11Utils* utils = nullptr;
@@ -35,16 +79,12 @@ X11Utils* X11Utils::instance()
 
 X11Utils::X11Utils()
 {
-    auto *x11Application = qGuiApp->nativeInterface<QNativeInterface::QX11Application>();
-    m_connection = x11Application->connection();
-
-    // init rootWidnow
-    const xcb_setup_t *setup = xcb_get_setup(m_connection);
-    xcb_screen_iterator_t iter = xcb_setup_roots_iterator(setup);
-    xcb_screen_t *screen = iter.data;
-    m_rootWindow = screen->root;
-
-    xcb_ewmh_init_atoms_replies(&m_ewmh, xcb_ewmh_init_atoms(m_connection, &m_ewmh), nullptr);
+    // the connection, the EWMH atoms and the atom cache are shared with the other users of the hub.
+    auto hub = XcbEventHub::instance();
+    m_connection = hub->connection();
+    m_rootWindow = hub->rootWindow();
+    m_ewmh = hub->ewmh();
+    internWellKnownAtoms();
 }
 
 X11Utils::~X11Utils()
@@ -65,59 +105,44 @@ xcb_window_t X11Utils::getRootWindow()
 xcb_window_t X11Utils::getActiveWindow()
 {
     xcb_window_t ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_active_window(&m_ewmh, 0);
-    if (!xcb_ewmh_get_active_window_reply(&m_ewmh, cookie, &ret, nullptr)) {
+    xcb_get_property_cookie_t cookie = xcb_ewmh_get_active_window(m_ewmh, 0);
+    if (!xcb_ewmh_get_active_window_reply(m_ewmh, cookie, &ret, nullptr)) {
         qCWarning(x11UtilsLog()) << "getActiveWindow failed";
     }
 
     return ret;
 }
 
-xcb_atom_t X11Utils::getAtomByName(const QString &name)
+void X11Utils::internWellKnownAtoms()
 {
-    xcb_atom_t ret = m_atoms.value(name, 0);
-    if (!ret) {
-        xcb_intern_atom_cookie_t cookie = xcb_intern_atom(getXcbConnection(), false, name.size(), name.toStdString().c_str());
-        QSharedPointer<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(getXcbConnection(), cookie, nullptr), [=](xcb_intern_atom_reply_t* reply){
-            free(reply);}
-        );
+    QList<QByteArray> names;
+    for (auto name : WellKnownAtomNames) {
+        names << QByteArray(name);
+    }
 
-        if (reply) {
-            m_atoms.insert(name, xcb_atom_t(reply->atom));
-            ret = reply->atom;
-        }
+    const auto atoms = XcbEventHub::instance()->atoms(names);
+    for (int i = 0; i < WellKnownAtomCount; ++i) {
+        m_wellKnownAtoms[i] = atoms[i];
     }
-    return ret;
+}
+
+xcb_atom_t X11Utils::getAtomByName(const QString &name)
+{
+    return XcbEventHub::instance()->atom(name.toLatin1());
 }
 
 QString X11Utils::getNameByAtom(const xcb_atom_t &atom)
 {
-    auto name = m_atoms.key(atom);
-    if (name.isEmpty()) {
-        xcb_get_atom_name_cookie_t cookie = xcb_get_atom_name(getXcbConnection(), atom);
-        QSharedPointer<xcb_get_atom_name_reply_t> reply(
-            xcb_get_atom_name_reply(getXcbConnection(), cookie, nullptr),
-            [=](xcb_get_atom_name_reply_t* reply) {free(reply);});
-        if (!reply) {
-            qCWarning(x11UtilsLog()) << "failed to get atom value for " + name;
-            return name;
-        }
-        std::string tmp;
-        tmp.assign(xcb_get_atom_name_name(reply.get()), xcb_get_atom_name_name_length(reply.get()));
-        name = tmp.c_str();
-        if (!name.isEmpty()) {
-            m_atoms.insert(name, atom);
-        }
-    }
-    return name;
+    return QString::fromLatin1(XcbEventHub::instance()->atomName(atom));
 }
+
 QList<xcb_window_t> X11Utils::getWindowClientList(const xcb_window_t &window)
 {
     Q_UNUSED(window)
     QList<xcb_window_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_client_list(&m_ewmh, 0);
+    xcb_get_property_cookie_t cookie = xcb_ewmh_get_client_list(m_ewmh, 0);
     xcb_ewmh_get_windows_reply_t reply;
-    if (xcb_ewmh_get_client_list_reply(&m_ewmh, cookie, &reply, nullptr)) {
+    if (xcb_ewmh_get_client_list_reply(m_ewmh, cookie, &reply, nullptr)) {
         for (uint32_t i = 0; i < reply.windows_len; i++) {
             ret.push_back(reply.windows[i]);
         }
@@ -131,7 +156,11 @@ QList<xcb_window_t> X11Utils::getWindowClientList(const xcb_window_t &window)
 pid_t X11Utils::getWindowPid(const xcb_window_t &window)
 {
     xcb_res_client_id_spec_t spec = { window, XCB_RES_CLIENT_ID_MASK_LOCAL_CLIENT_PID };
-    xcb_res_query_client_ids_cookie_t cookie = xcb_res_query_client_ids_unchecked(getXcbConnection(), 1, &spec);
+    return windowPidReply(window, xcb_res_query_client_ids_unchecked(getXcbConnection(), 1, &spec));
+}
+
+pid_t X11Utils::windowPidReply(const xcb_window_t &window, xcb_res_query_client_ids_cookie_t cookie)
+{
     QSharedPointer<xcb_res_query_client_ids_reply_t> reply(xcb_res_query_client_ids_reply(getXcbConnection(), cookie, NULL),[](xcb_res_query_client_ids_reply_t* reply){
         free(reply);
     });
@@ -149,11 +178,15 @@ pid_t X11Utils::getWindowPid(const xcb_window_t &window)
 }
 
 QString X11Utils::getWindowName(const xcb_window_t &window)
+{
+    return windowNameReply(xcb_ewmh_get_wm_name(m_ewmh, window));
+}
+
+QString X11Utils::windowNameReply(xcb_get_property_cookie_t cookie)
 {
     std::string ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_name(&m_ewmh, window);
     xcb_ewmh_get_utf8_strings_reply_t reply;
-    if (xcb_ewmh_get_wm_name_reply(&m_ewmh, cookie, &reply, nullptr)) {
+    if (xcb_ewmh_get_wm_name_reply(m_ewmh, cookie, &reply, nullptr)) {
         ret.assign(reply.strings, reply.strings_len);
         xcb_ewmh_get_utf8_strings_reply_wipe(&reply);
     }
@@ -163,9 +196,9 @@ QString X11Utils::getWindowName(const xcb_window_t &window)
 QString X11Utils::getWindowIconName(const xcb_window_t &window)
 {
     std::string ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_icon_name(&m_ewmh, window);
+    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_icon_name(m_ewmh, window);
     xcb_ewmh_get_utf8_strings_reply_t reply;
-    if (xcb_ewmh_get_wm_icon_name_reply(&m_ewmh, cookie, &reply, nullptr)) {
+    if (xcb_ewmh_get_wm_icon_name_reply(m_ewmh, cookie, &reply, nullptr)) {
         ret.assign(reply.strings, reply.strings_len);
         xcb_ewmh_get_utf8_strings_reply_wipe(&reply);
     }
@@ -174,62 +207,38 @@ QString X11Utils::getWindowIconName(const xcb_window_t &window)
 
 QString X11Utils::getWindowIcon(const xcb_window_t &window)
 {
-    QString iconContent;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_icon(&m_ewmh, window);
-    xcb_ewmh_get_wm_icon_reply_t reply;
-    do {
-        if(!xcb_ewmh_get_wm_icon_reply(&m_ewmh, cookie, &reply, nullptr)) break;
-
-        QSharedPointer<xcb_ewmh_get_wm_icon_reply_t> replyPtr(&reply,[](xcb_ewmh_get_wm_icon_reply_t *ptr){
-            xcb_ewmh_get_wm_icon_reply_wipe(ptr);
-        });
-    
-        xcb_ewmh_wm_icon_iterator_t iter = xcb_ewmh_get_wm_icon_iterator(replyPtr.get());
-        xcb_ewmh_wm_icon_iterator_t wmIconIt{0, 0, nullptr, 0, 0};
-        for (; iter.rem; xcb_ewmh_get_wm_icon_next(&iter)) {
-            const uint32_t size = iter.width * iter.height;
-            if (size > 0 && size > wmIconIt.width * wmIconIt.height) {
-                wmIconIt = iter;
-            }
-        }
-
-        if (!wmIconIt.data) break;
-
-        QImage img = QImage((uchar *)wmIconIt.data, wmIconIt.width, wmIconIt.height, QImage::Format_ARGB32).copy();
-
-        QBuffer buffer;
-        buffer.open(QIODevice::WriteOnly);
-        img.save(&buffer, "PNG");
-        QString encode = buffer.data().toBase64();
-        iconContent = QString("%1,%2").arg("data:image/png;base64").arg(encode);
-        buffer.close();
+    return windowIconReply(window, xcb_ewmh_get_wm_icon(m_ewmh, window));
+}
 
-    } while(0);
+// the icon is kept raw in X11WindowIconStore, it's neither converted nor encoded here.
+QString X11Utils::windowIconReply(const xcb_window_t &window, xcb_get_property_cookie_t cookie)
+{
+    std::unique_ptr<xcb_get_property_reply_t, decltype(&free)> reply(xcb_get_property_reply(m_connection, cookie, nullptr), &free);
+    if (!reply || reply->format != 32 || reply->type != XCB_ATOM_CARDINAL) {
+        X11WindowIconStore::instance()->remove(window);
+        return {};
+    }
 
-    return iconContent;
+    return X11WindowIconStore::instance()->insert(window, reinterpret_cast<const uint32_t *>(xcb_get_property_value(reply.get())),
+                                                  xcb_get_property_value_length(reply.get()) / sizeof(uint32_t));
 }
 
 QList<xcb_atom_t> X11Utils::getWindowState(const xcb_window_t &window)
 {
-    QList<xcb_atom_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_state(&m_ewmh, window);
-    xcb_ewmh_get_atoms_reply_t reply;
-    if (xcb_ewmh_get_wm_state_reply(&m_ewmh, cookie, &reply, nullptr)) {
-        for (uint32_t i = 0; i < reply.atoms_len; i++) {
-            ret.push_back(reply.atoms[i]);
-        }
-        xcb_ewmh_get_atoms_reply_wipe(&reply);
-    }
-
-    return ret;
+    return windowAtomsReply(xcb_ewmh_get_wm_state(m_ewmh, window));
 }
 
 QList<xcb_atom_t> X11Utils::getWindowAllowedActions(const xcb_window_t &window)
+{
+    return windowAtomsReply(xcb_ewmh_get_wm_allowed_actions(m_ewmh, window));
+}
+
+// _NET_WM_STATE, _NET_WM_ALLOWED_ACTIONS and _NET_WM_WINDOW_TYPE are all lists of atoms.
+QList<xcb_atom_t> X11Utils::windowAtomsReply(xcb_get_property_cookie_t cookie)
 {
     QList<xcb_atom_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_allowed_actions(&m_ewmh, window);
     xcb_ewmh_get_atoms_reply_t reply;
-    if (xcb_ewmh_get_wm_allowed_actions_reply(&m_ewmh, cookie, &reply, nullptr)) {
+    if (xcb_ewmh_get_atoms_reply(m_ewmh, cookie, &reply, nullptr)) {
         for (uint32_t i = 0; i < reply.atoms_len; i++) {
             ret.push_back(reply.atoms[i]);
         }
@@ -241,8 +250,12 @@ QList<xcb_atom_t> X11Utils::getWindowAllowedActions(const xcb_window_t &window)
 
 MotifWMHints X11Utils::getWindowMotifWMHints(const xcb_window_t &window)
 {
-    xcb_atom_t atomWmHints = getAtomByName("_MOTIF_WM_HINTS");
-    xcb_get_property_cookie_t cookie = xcb_get_property(m_connection, false, window, atomWmHints, atomWmHints, 0, 5);
+    xcb_atom_t atomWmHints = atom(MotifWmHintsAtom);
+    return windowMotifWMHintsReply(xcb_get_property(m_connection, false, window, atomWmHints, atomWmHints, 0, 5));
+}
+
+MotifWMHints X11Utils::windowMotifWMHintsReply(xcb_get_property_cookie_t cookie)
+{
     std::unique_ptr<xcb_get_property_reply_t> reply(xcb_get_property_reply(m_connection, cookie, nullptr));
     if (!reply || reply->format != 32 || reply->value_len != 5)
         return MotifWMHints{0, 0, 0, 0, 0};
@@ -258,11 +271,14 @@ MotifWMHints X11Utils::getWindowMotifWMHints(const xcb_window_t &window)
 }
 
 QStringList X11Utils::getWindowWMClass(const xcb_window_t &window)
+{
+    return windowWMClassReply(xcb_icccm_get_wm_class(m_connection, window));
+}
+
+QStringList X11Utils::windowWMClassReply(xcb_get_property_cookie_t cookie)
 {
     xcb_icccm_get_wm_class_reply_t wmClassReply;
-    xcb_get_property_cookie_t wmClassCookie;
-    wmClassCookie = xcb_icccm_get_wm_class(m_connection, window);
-    if (xcb_icccm_get_wm_class_reply(m_connection, wmClassCookie, &wmClassReply, nullptr)) {
+    if (xcb_icccm_get_wm_class_reply(m_connection, cookie, &wmClassReply, nullptr)) {
         QString instanceName = wmClassReply.instance_name;
         QString className = wmClassReply.class_name;
         xcb_icccm_get_wm_class_reply_wipe(&wmClassReply);
@@ -298,12 +314,12 @@ QRect X11Utils::getWindowGeometry(const xcb_window_t &window)
             if (geometry.x() == dgeom->x && geometry.y() == dgeom->y) {
                 // 无标题栏窗口,比如 deepin-editor, dconf-editor
                 xcb_get_property_reply_t *pro =
-                    xcb_get_property_reply(m_connection, xcb_get_property(m_connection, false, window, getAtomByName("_NET_FRAME_EXTENTS"), 6, 0, 4), nullptr);
+                    xcb_get_property_reply(m_connection, xcb_get_property(m_connection, false, window, atom(NetFrameExtentsAtom), 6, 0, 4), nullptr);
                 if (pro) {
                     if (pro->format == 0) {
                         free(pro);
                         pro = xcb_get_property_reply(m_connection,
-                                                     xcb_get_property(m_connection, false, window, getAtomByName("_GTK_FRAME_EXTENTS"), 6, 0, 4),
+                                                     xcb_get_property(m_connection, false, window, atom(GtkFrameExtentsAtom), 6, 0, 4),
                                                      nullptr);
                     }
                     if (pro && pro->format == 32) {
@@ -347,15 +363,59 @@ xcb_window_t X11Utils::getDecorativeWindow(const xcb_window_t &window)
 
 QList<xcb_atom_t> X11Utils::getWindowTypes(const xcb_window_t &window)
 {
-    QList<xcb_atom_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_window_type(&m_ewmh, window);
-    xcb_ewmh_get_atoms_reply_t reply; // a list of Atom
-    if (xcb_ewmh_get_wm_window_type_reply(&m_ewmh, cookie, &reply, nullptr)) {
-        for (uint32_t i = 0; i < reply.atoms_len; i++) {
-            ret.push_back(reply.atoms[i]);
-        }
-        xcb_ewmh_get_atoms_reply_wipe(&reply);
+    return windowAtomsReply(xcb_ewmh_get_wm_window_type(m_ewmh, window));
+}
+
+WindowPropertiesCookie X11Utils::requestWindowProperties(const xcb_window_t &window, uint properties)
+{
+    WindowPropertiesCookie cookie;
+    cookie.window = window;
+    cookie.properties = properties;
+    if (properties & WindowPidProperty) {
+        xcb_res_client_id_spec_t spec = { window, XCB_RES_CLIENT_ID_MASK_LOCAL_CLIENT_PID };
+        cookie.pid = xcb_res_query_client_ids_unchecked(m_connection, 1, &spec);
+    }
+    if (properties & WindowWMClassProperty)
+        cookie.wmClass = xcb_icccm_get_wm_class(m_connection, window);
+    if (properties & WindowNameProperty)
+        cookie.name = xcb_ewmh_get_wm_name(m_ewmh, window);
+    if (properties & WindowIconProperty)
+        cookie.icon = xcb_ewmh_get_wm_icon(m_ewmh, window);
+    if (properties & WindowStateProperty)
+        cookie.state = xcb_ewmh_get_wm_state(m_ewmh, window);
+    if (properties & WindowAllowedActionsProperty)
+        cookie.allowedActions = xcb_ewmh_get_wm_allowed_actions(m_ewmh, window);
+    if (properties & WindowTypesProperty)
+        cookie.types = xcb_ewmh_get_wm_window_type(m_ewmh, window);
+    if (properties & WindowMotifWMHintsProperty) {
+        xcb_atom_t atomWmHints = atom(MotifWmHintsAtom);
+        cookie.motifWMHints = xcb_get_property(m_connection, false, window, atomWmHints, atomWmHints, 0, 5);
     }
+
+    return cookie;
+}
+
+WindowProperties X11Utils::getWindowProperties(const WindowPropertiesCookie &cookie)
+{
+    WindowProperties ret;
+    ret.properties = cookie.properties;
+    if (cookie.properties & WindowPidProperty)
+        ret.pid = windowPidReply(cookie.window, cookie.pid);
+    if (cookie.properties & WindowWMClassProperty)
+        ret.wmClass = windowWMClassReply(cookie.wmClass);
+    if (cookie.properties & WindowNameProperty)
+        ret.name = windowNameReply(cookie.name);
+    if (cookie.properties & WindowIconProperty)
+        ret.icon = windowIconReply(cookie.window, cookie.icon);
+    if (cookie.properties & WindowStateProperty)
+        ret.state = windowAtomsReply(cookie.state);
+    if (cookie.properties & WindowAllowedActionsProperty)
+        ret.allowedActions = windowAtomsReply(cookie.allowedActions);
+    if (cookie.properties & WindowTypesProperty)
+        ret.types = windowAtomsReply(cookie.types);
+    if (cookie.properties & WindowMotifWMHintsProperty)
+        ret.motifWMHints = windowMotifWMHintsReply(cookie.motifWMHints);
+
     return ret;
 }
 
@@ -364,25 +424,25 @@ void X11Utils::minimizeWindow(const xcb_window_t &window)
     uint32_t data[2];
     data[0] = XCB_ICCCM_WM_STATE_ICONIC;
     data[1] = XCB_NONE;
-    xcb_ewmh_send_client_message(m_connection, window, m_rootWindow,getAtomByName("WM_CHANGE_STATE"), 2, data);
+    xcb_ewmh_send_client_message(m_connection, window, m_rootWindow,atom(WmChangeStateAtom), 2, data);
     xcb_flush(m_connection);
 }
 
 void X11Utils::maxmizeWindow(const xcb_window_t &window)
 {
-    xcb_ewmh_request_change_wm_state(&m_ewmh,
+    xcb_ewmh_request_change_wm_state(m_ewmh,
                                     0,
                                     window,
                                     XCB_EWMH_WM_STATE_ADD,
-                                    getAtomByName("_NET_WM_STATE_MAXIMIZED_VERT"),
-                                    getAtomByName("_NET_WM_STATE_MAXIMIZED_HORZ"),
+                                    atom(NetWmStateMaximizedVertAtom),
+                                    atom(NetWmStateMaximizedHorzAtom),
                                     XCB_EWMH_CLIENT_SOURCE_TYPE_OTHER);
     xcb_flush(m_connection);
 }
 
 void X11Utils::closeWindow(const xcb_window_t &window)
 {
-    xcb_ewmh_request_close_window(&m_ewmh, 0, window, 0, XCB_EWMH_CLIENT_SOURCE_TYPE_OTHER);
+    xcb_ewmh_request_close_window(m_ewmh, 0, window, 0, XCB_EWMH_CLIENT_SOURCE_TYPE_OTHER);
 }
 
 void X11Utils::killClient(const xcb_window_t &winid)
@@ -402,20 +462,20 @@ void X11Utils::killClient(const xcb_window_t &winid)
 
 void X11Utils::setActiveWindow(const xcb_window_t &window)
 {
-    xcb_ewmh_request_change_active_window(&m_ewmh, 0, window, XCB_EWMH_CLIENT_SOURCE_TYPE_OTHER, XCB_CURRENT_TIME, XCB_WINDOW_NONE);
+    xcb_ewmh_request_change_active_window(m_ewmh, 0, window, XCB_EWMH_CLIENT_SOURCE_TYPE_OTHER, XCB_CURRENT_TIME, XCB_WINDOW_NONE);
     restackWindow(window);
     xcb_flush(m_connection);
 }
 
 void X11Utils::restackWindow(const xcb_window_t &window)
 {
-    xcb_ewmh_request_restack_window(&m_ewmh, 0, window, 0, XCB_STACK_MODE_ABOVE);
+    xcb_ewmh_request_restack_window(m_ewmh, 0, window, 0, XCB_STACK_MODE_ABOVE);
 }
 
 void X11Utils::setWindowIconGemeotry(const xcb_window_t &window, const QRect &geometry)
 {
     const auto ratio = qApp->devicePixelRatio();
-    xcb_ewmh_set_wm_icon_geometry(&m_ewmh, window, geometry.x() * ratio, geometry.y() * ratio, geometry.width() * ratio, geometry.height() * ratio);
+    xcb_ewmh_set_wm_icon_geometry(m_ewmh, window, geometry.x() * ratio, geometry.y() * ratio, geometry.width() * ratio, geometry.height() * ratio);
 }
 
 }
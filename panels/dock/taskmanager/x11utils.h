@@ -1,16 +1,17 @@
-// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <sys/types.h>
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
+#include <xcb/res.h>
 #include <xcb/xcb_ewmh.h>
 
-#include <QMap>
 #include <QObject>
 #include <QSharedPointer>
 
@@ -36,6 +37,87 @@ typedef struct {
     uint32_t status;
 } MotifWMHints;
 
+// well-known atoms, they're interned in one batch when X11Utils is created, see X11Utils::atom.
+enum WellKnownAtom {
+    WmClassAtom,
+    WmChangeStateAtom,
+    Utf8StringAtom,
+    MotifWmHintsAtom,
+    GtkFrameExtentsAtom,
+    NetClientListAtom,
+    NetFrameExtentsAtom,
+    NetWmPidAtom,
+    NetWmNameAtom,
+    NetWmIconAtom,
+    NetWmStateAtom,
+    NetWmStateFocusedAtom,
+    NetWmStateHiddenAtom,
+    NetWmStateModalAtom,
+    NetWmStateSkipTaskbarAtom,
+    NetWmStateDemandsAttentionAtom,
+    NetWmStateMaximizedVertAtom,
+    NetWmStateMaximizedHorzAtom,
+    NetWmAllowedActionsAtom,
+    NetWmActionCloseAtom,
+    NetWmActionMinimizeAtom,
+    NetWmWindowTypeAtom,
+    NetWmWindowTypeDialogAtom,
+    NetWmWindowTypeUtilityAtom,
+    NetWmWindowTypeComboAtom,
+    NetWmWindowTypeDesktopAtom,
+    NetWmWindowTypeDndAtom,
+    NetWmWindowTypeDockAtom,
+    NetWmWindowTypeDropdownMenuAtom,
+    NetWmWindowTypeMenuAtom,
+    NetWmWindowTypeNotificationAtom,
+    NetWmWindowTypePopupMenuAtom,
+    NetWmWindowTypeSplashAtom,
+    NetWmWindowTypeToolbarAtom,
+    NetWmWindowTypeTooltipAtom,
+    WellKnownAtomCount
+};
+
+// properties of a window which can be fetched in one batch, see X11Utils::requestWindowProperties.
+enum WindowProperty {
+    WindowPidProperty = 1 << 0,
+    WindowWMClassProperty = 1 << 1,
+    WindowNameProperty = 1 << 2,
+    WindowIconProperty = 1 << 3,
+    WindowStateProperty = 1 << 4,
+    WindowAllowedActionsProperty = 1 << 5,
+    WindowTypesProperty = 1 << 6,
+    WindowMotifWMHintsProperty = 1 << 7,
+    AllWindowProperties = (1 << 8) - 1,
+};
+
+// requests of the properties of a window sent but not replied yet.
+struct WindowPropertiesCookie {
+    xcb_window_t window = 0;
+    uint properties = 0;
+    xcb_res_query_client_ids_cookie_t pid{};
+    xcb_get_property_cookie_t wmClass{};
+    xcb_get_property_cookie_t name{};
+    xcb_get_property_cookie_t icon{};
+    xcb_get_property_cookie_t state{};
+    xcb_get_property_cookie_t allowedActions{};
+    xcb_get_property_cookie_t types{};
+    xcb_get_property_cookie_t motifWMHints{};
+};
+
+// only the members in the mask of properties are fetched.
+struct WindowProperties {
+    uint properties = 0;
+    pid_t pid = 0;
+    QStringList wmClass;
+    QString name;
+    // url of the icon in X11WindowIconStore.
+    QString icon;
+    QList<xcb_atom_t> state;
+    QList<xcb_atom_t> allowedActions;
+    QList<xcb_atom_t> types;
+    MotifWMHints motifWMHints{0, 0, 0, 0, 0};
+};
+
 class X11Utils
 {
 public:
@@ -44,10 +126,13 @@ public:
 
     xcb_window_t getRootWindow();
     xcb_window_t getActiveWindow();
+    // no request is sent and no string is handled, it's used on the event path.
+    inline xcb_atom_t atom(WellKnownAtom atom) const { return m_wellKnownAtoms[atom]; }
     xcb_atom_t getAtomByName(const QString &name);
     QString getNameByAtom(const xcb_atom_t &atom);
     pid_t getWindowPid(const xcb_window_t &window);
     QString getWindowName(const xcb_window_t &window);
+    // stores the icon in X11WindowIconStore and returns its url, it's empty if the window has no icon.
     QString getWindowIcon(const xcb_window_t &window);
     QString getWindowIconName(const xcb_window_t &window);
     QList<xcb_atom_t> getWindowState(const xcb_window_t &window);
@@ -59,6 +144,12 @@ public:
     QRect getWindowGeometry(const xcb_window_t &window);
     xcb_window_t getDecorativeWindow(const xcb_window_t &window);
 
+    // sends the requests of the properties without waiting for the replies,
+    // the requests of many windows are sent first and cost one round trip in total.
+    WindowPropertiesCookie requestWindowProperties(const xcb_window_t &window, uint properties);
+    // waits for the replies, every cookie must be collected once.
+    WindowProperties getWindowProperties(const WindowPropertiesCookie &cookie);
+
     void minimizeWindow(const xcb_window_t &window);
     void maxmizeWindow(const xcb_window_t &window);
     void closeWindow(const xcb_window_t &window);
@@ -71,10 +162,19 @@ private:
     X11Utils();
     ~X11Utils();
 
+    void internWellKnownAtoms();
+
+    pid_t windowPidReply(const xcb_window_t &window, xcb_res_query_client_ids_cookie_t cookie);
+    QString windowNameReply(xcb_get_property_cookie_t cookie);
+    QString windowIconReply(const xcb_window_t &window, xcb_get_property_cookie_t cookie);
+    QList<xcb_atom_t> windowAtomsReply(xcb_get_property_cookie_t cookie);
+    MotifWMHints windowMotifWMHintsReply(xcb_get_property_cookie_t cookie);
+    QStringList windowWMClassReply(xcb_get_property_cookie_t cookie);
+
 private:
     xcb_window_t m_rootWindow;
-    xcb_ewmh_connection_t m_ewmh;
-    QMap<QString, xcb_atom_t> m_atoms;
+    xcb_ewmh_connection_t *m_ewmh;
+    std::array<xcb_atom_t, WellKnownAtomCount> m_wellKnownAtoms{};
     xcb_connection_t* m_connection;
 };
 }
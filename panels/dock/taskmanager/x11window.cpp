@@ -1,14 +1,13 @@
-// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "x11window.h"
 #include "abstractwindow.h"
 #include "x11utils.h"
+#include "x11windowiconstore.h"
 #include "appitem.h"
 
-#include <mutex>
-
 #include <QRect>
 #include <QObject>
 #include <QLoggingCategory>
@@ -28,6 +27,7 @@ X11Window::X11Window(xcb_window_t winid, QObject *parent)
 
 X11Window::~X11Window()
 {
+    X11WindowIconStore::instance()->remove(m_windowID);
     qCDebug(x11windowLog()) << "x11 window destroyed";
 }
 
@@ -64,6 +64,12 @@ QString X11Window::icon()
     return m_icon;
 }
 
+QString X11Window::dbusIcon()
+{
+    // the url of the store is only served in the process, the icon is encoded on request.
+    return X11WindowIconStore::instance()->dataUri(m_windowID);
+}
+
 QString X11Window::title()
 {
     if (m_title.isEmpty()) {
@@ -76,7 +82,7 @@ QString X11Window::title()
 bool X11Window::isActive()
 {
     checkWindowState();
-    return m_windowStates.contains(X11->getAtomByName("_NET_WM_STATE_FOCUSED"));
+    return m_windowStates.contains(X11->atom(NetWmStateFocusedAtom));
 }
 
 bool X11Window::shouldSkip()
@@ -86,21 +92,21 @@ bool X11Window::shouldSkip()
         return true;
 
     for (auto atom : m_windowTypes) {
-        if (atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_DIALOG") && !isActionMinimizeAllowed())
+        if (atom == X11->atom(NetWmWindowTypeDialogAtom) && !isActionMinimizeAllowed())
             return true;
 
-        if (atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_UTILITY")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_COMBO")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_DESKTOP")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_DND")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_DOCK")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_DROPDOWN_MENU")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_MENU")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_NOTIFICATION")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_POPUP_MENU")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_SPLASH")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_TOOLBAR")
-        || atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE_TOOLTIP"))
+        if (atom == X11->atom(NetWmWindowTypeUtilityAtom)
+        || atom == X11->atom(NetWmWindowTypeComboAtom)
+        || atom == X11->atom(NetWmWindowTypeDesktopAtom)
+        || atom == X11->atom(NetWmWindowTypeDndAtom)
+        || atom == X11->atom(NetWmWindowTypeDockAtom)
+        || atom == X11->atom(NetWmWindowTypeDropdownMenuAtom)
+        || atom == X11->atom(NetWmWindowTypeMenuAtom)
+        || atom == X11->atom(NetWmWindowTypeNotificationAtom)
+        || atom == X11->atom(NetWmWindowTypePopupMenuAtom)
+        || atom == X11->atom(NetWmWindowTypeSplashAtom)
+        || atom == X11->atom(NetWmWindowTypeToolbarAtom)
+        || atom == X11->atom(NetWmWindowTypeTooltipAtom))
             return true; 
     }
 
@@ -110,7 +116,7 @@ bool X11Window::shouldSkip()
 bool X11Window::isMinimized()
 {
     checkWindowState();
-    return m_windowStates.contains(X11->getAtomByName("_NET_WM_STATE_HIDDEN"));
+    return m_windowStates.contains(X11->atom(NetWmStateHiddenAtom));
 }
 
 bool X11Window::allowClose()
@@ -120,12 +126,12 @@ bool X11Window::allowClose()
         || (m_motifWmHints.functions & MotifFunctionAll) != 0
         || (m_motifWmHints.functions & MotifFunctionClose) != 0)
         return true;
-    return m_windowAllowedActions.contains(X11->getAtomByName("_NET_WM_ACTION_CLOSE"));
+    return m_windowAllowedActions.contains(X11->atom(NetWmActionCloseAtom));
 }
 
 bool X11Window::isAttention()
 {
-    return m_windowStates.contains(X11->getAtomByName("_NET_WM_STATE_DEMANDS_ATTENTION"));
+    return m_windowStates.contains(X11->atom(NetWmStateDemandsAttentionAtom));
 }
 
 void X11Window::close()
@@ -159,6 +165,57 @@ void X11Window::setWindowIconGeometry(const QWindow* baseWindow, const QRect& ge
     X11->setWindowIconGemeotry(m_windowID, QRect(pos.x(), pos.y(), gemeotry.width(), gemeotry.height()));
 }
 
+void X11Window::refresh(const WindowProperties &properties)
+{
+    const auto mask = properties.properties;
+    // identity contains the pid, so the pid is applied first.
+    if (mask & WindowPidProperty) {
+        auto oldPid = m_pid;
+        m_pid = properties.pid;
+        if (oldPid != m_pid)
+            Q_EMIT AbstractWindow::pidChanged();
+    }
+    if (mask & WindowWMClassProperty) {
+        auto newWMclass = properties.wmClass;
+        newWMclass.append(QString::number(pid()));
+        if (newWMclass != m_identity) {
+            m_identity = newWMclass;
+            Q_EMIT identityChanged();
+        }
+    }
+    // the lazy fetches of the lists aren't needed anymore once they're applied.
+    if (mask & WindowStateProperty) {
+        m_windowStates = properties.state;
+        m_windowStatesFetched = true;
+        Q_EMIT stateChanged();
+    }
+    if (mask & WindowAllowedActionsProperty) {
+        m_windowAllowedActions = properties.allowedActions;
+    }
+    if (mask & WindowTypesProperty) {
+        m_windowTypes = properties.types;
+        m_windowTypesFetched = true;
+    }
+    if (mask & WindowMotifWMHintsProperty) {
+        m_motifWmHints = properties.motifWMHints;
+    }
+    if ((mask & WindowAllowedActionsProperty) && (mask & WindowMotifWMHintsProperty)) {
+        m_windowAllowedActionsFetched = true;
+    }
+    if (mask & WindowNameProperty) {
+        auto oldTitle = m_title;
+        m_title = properties.name;
+        if (oldTitle != m_title)
+            Q_EMIT AbstractWindow::titleChanged();
+    }
+    if (mask & WindowIconProperty) {
+        auto oldIcon = m_icon;
+        m_icon = properties.icon;
+        if (oldIcon != m_icon)
+            Q_EMIT AbstractWindow::iconChanged();
+    }
+}
+
 void X11Window::updatePid()
 {
     auto oldPid = m_pid;
@@ -167,17 +224,6 @@ void X11Window::updatePid()
         Q_EMIT AbstractWindow::pidChanged();
 }
 
-void X11Window::updateIdentify()
-{
-    auto newWMclass = X11->getWindowWMClass(m_windowID);
-    newWMclass.append(QString::number(pid()));
-    if (newWMclass == m_identity)
-        return;
-
-    m_identity = newWMclass;
-    Q_EMIT identityChanged();
-}
-
 void X11Window::updateIcon()
 {
     auto oldIcon = m_icon;
@@ -229,9 +275,10 @@ void X11Window::updateWindowState()
 
 void X11Window::checkWindowState()
 {
-    std::call_once(m_windowStateFlag, [this](){
+    if (!m_windowStatesFetched) {
+        m_windowStatesFetched = true;
         updateWindowState();
-    });
+    }
 }
 
 void X11Window::updateWindowAllowedActions()
@@ -242,10 +289,11 @@ void X11Window::updateWindowAllowedActions()
 
 void X11Window::checkWindowAllowedActions()
 {
-    std::call_once(m_windowAllowedActionsFlag, [this](){
+    if (!m_windowAllowedActionsFetched) {
+        m_windowAllowedActionsFetched = true;
         updateMotifWmHints();
         updateWindowAllowedActions();
-    });
+    }
 }
 
 void X11Window::updateWindowTypes()
@@ -256,27 +304,28 @@ void X11Window::updateWindowTypes()
 
 void X11Window::checkWindowTypes()
 {
-    std::call_once(m_windowTypeFlag, [this](){
+    if (!m_windowTypesFetched) {
+        m_windowTypesFetched = true;
         updateWindowTypes();
-    });
+    }
 }
 
 bool X11Window::hasWmStateModal()
 {
     checkWindowState();
-    return m_windowStates.contains(X11->getAtomByName("_NET_WM_STATE_MODAL"));
+    return m_windowStates.contains(X11->atom(NetWmStateModalAtom));
 }
 
 bool X11Window::hasWmStateSkipTaskBar()
 {
     checkWindowState();
-    return m_windowStates.contains(X11->getAtomByName("_NET_WM_STATE_SKIP_TASKBAR"));
+    return m_windowStates.contains(X11->atom(NetWmStateSkipTaskbarAtom));
 }
 
 bool X11Window::isActionMinimizeAllowed()
 {
     checkWindowAllowedActions();
-    return m_windowAllowedActions.contains(X11->getAtomByName("_NET_WM_ACTION_MINIMIZE"));
+    return m_windowAllowedActions.contains(X11->atom(NetWmActionMinimizeAtom));
 }
 
 }
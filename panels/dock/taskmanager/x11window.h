@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2023 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -7,7 +7,6 @@
 #include "x11utils.h"
 #include "abstractwindow.h"
 
-#include <mutex>
 #include <sys/types.h>
 #include <xcb/xproto.h>
 
@@ -23,6 +22,7 @@ public:
     virtual pid_t pid() override;
     virtual QStringList identity() override;
     virtual QString icon() override;
+    virtual QString dbusIcon() override;
     virtual QString title() override;
     virtual bool isActive() override;
     virtual bool shouldSkip() override;
@@ -42,8 +42,9 @@ private:
     X11Window(xcb_window_t winid, QObject *parent = nullptr);
 
 private:
+    // applies the properties fetched by X11Utils::getWindowProperties, see WindowProperty.
+    void refresh(const WindowProperties &properties);
     void updatePid();
-    void updateIdentify();
     void updateIcon();
     void updateTitle();
     void updateIsActive();
@@ -78,8 +79,9 @@ private:
     QList<xcb_atom_t> m_windowAllowedActions;
     MotifWMHints m_motifWmHints;
 
-    std::once_flag m_windowTypeFlag;
-    std::once_flag m_windowStateFlag;
-    std::once_flag m_windowAllowedActionsFlag;
+    // whether the lists are fetched, they're fetched lazily by the check functions otherwise.
+    bool m_windowTypesFetched = false;
+    bool m_windowStatesFetched = false;
+    bool m_windowAllowedActionsFetched = false;
 };
 }
\ No newline at end of file
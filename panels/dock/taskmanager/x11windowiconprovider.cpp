@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "x11windowiconprovider.h"
+#include "x11windowiconstore.h"
+
+#include <QQmlEngine>
+
+namespace dock {
+
+X11WindowIconProvider::X11WindowIconProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage X11WindowIconProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    // the entry of the icon is chosen by the dock icon size, it's scaled only if no entry matches.
+    QImage image = X11WindowIconStore::instance()->image(id, requestedSize);
+    if (size)
+        *size = image.size();
+
+    if (!image.isNull() && !requestedSize.isEmpty() && requestedSize != image.size()) {
+        image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+void X11WindowIconProvider::registerTo(QQmlEngine *engine)
+{
+    if (!engine || engine->imageProvider(X11WindowIconStore::providerId()))
+        return;
+
+    engine->addImageProvider(X11WindowIconStore::providerId(), new X11WindowIconProvider());
+}
+
+}
@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QQuickImageProvider>
+
+class QQmlEngine;
+namespace dock {
+
+// Serves the icons of X11WindowIconStore as image://x11windowicon/<window>/<hash>.
+class X11WindowIconProvider : public QQuickImageProvider
+{
+public:
+    X11WindowIconProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    // registers the provider to the engine if it's not registered.
+    static void registerTo(QQmlEngine *engine);
+};
+
+}
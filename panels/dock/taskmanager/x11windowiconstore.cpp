@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "x11windowiconstore.h"
+
+#include <QBuffer>
+#include <QHashFunctions>
+
+namespace dock {
+
+static const QString ProviderId("x11windowicon");
+static const QString IconUrlPrefix(QString("image://%1/").arg(ProviderId));
+
+// returns the offset of the entry fitting the size best, it's -1 if there is no valid entry.
+static qsizetype bestEntry(const uint32_t *data, qsizetype length, const QSize &size)
+{
+    qsizetype best = -1;
+    quint64 bestArea = 0;
+    bool bestCovers = false;
+    for (qsizetype offset = 0; offset + 2 <= length;) {
+        const quint64 width = data[offset];
+        const quint64 height = data[offset + 1];
+        const quint64 area = width * height;
+        // the rest of the data is broken.
+        if (area > quint64(length - offset - 2))
+            break;
+
+        if (area > 0) {
+            const bool covers = !size.isEmpty() && width >= quint64(size.width()) && height >= quint64(size.height());
+            // the smallest of the entries covering the size, otherwise the largest one.
+            if (best < 0 || (covers && (!bestCovers || area < bestArea)) || (!covers && !bestCovers && area > bestArea)) {
+                best = offset;
+                bestArea = area;
+                bestCovers = covers;
+            }
+        }
+        offset += 2 + area;
+    }
+    return best;
+}
+
+X11WindowIconStore *X11WindowIconStore::instance()
+{
+    static X11WindowIconStore *gInstance = nullptr;
+    static QMutex gMutex;
+    QMutexLocker locker(&gMutex);
+    if (!gInstance) {
+        gInstance = new X11WindowIconStore();
+    }
+    return gInstance;
+}
+
+QString X11WindowIconStore::providerId()
+{
+    return ProviderId;
+}
+
+QString X11WindowIconStore::iconUrl(xcb_window_t window, size_t hash)
+{
+    // the hash changes the url of a changed icon, then qml requests it again.
+    return IconUrlPrefix + QString::number(window) + '/' + QString::number(hash, 16);
+}
+
+QString X11WindowIconStore::idOfUrl(const QString &url)
+{
+    if (!url.startsWith(IconUrlPrefix))
+        return {};
+
+    return url.mid(IconUrlPrefix.size());
+}
+
+QString X11WindowIconStore::insert(xcb_window_t window, const uint32_t *data, int length)
+{
+    if (!data || bestEntry(data, length, {}) < 0) {
+        remove(window);
+        return {};
+    }
+
+    const auto bytes = length * sizeof(uint32_t);
+    const size_t hash = qHashBits(data, bytes);
+
+    QMutexLocker locker(&m_mutex);
+    auto iter = m_icons.find(window);
+    if (iter == m_icons.end() || iter->hash != hash) {
+        m_icons.insert(window, Icon{hash, QByteArray(reinterpret_cast<const char *>(data), bytes)});
+    }
+    return iconUrl(window, hash);
+}
+
+void X11WindowIconStore::remove(xcb_window_t window)
+{
+    QMutexLocker locker(&m_mutex);
+    m_icons.remove(window);
+}
+
+QImage X11WindowIconStore::image(const QString &id, const QSize &size)
+{
+    // the id is window/hash, the current icon of the window is served for an outdated hash.
+    bool ok = false;
+    const xcb_window_t window = id.section('/', 0, 0).toUInt(&ok);
+    if (!ok)
+        return {};
+
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto iter = m_icons.constFind(window);
+        if (iter == m_icons.constEnd())
+            return {};
+        data = iter->data;
+    }
+
+    const auto values = reinterpret_cast<const uint32_t *>(data.constData());
+    const auto offset = bestEntry(values, data.size() / qsizetype(sizeof(uint32_t)), size);
+    if (offset < 0)
+        return {};
+
+    // the image refers to the stored data, which is released with the last image of it.
+    return QImage(reinterpret_cast<const uchar *>(values + offset + 2), values[offset], values[offset + 1], QImage::Format_ARGB32,
+                  [](void *info) {
+                      delete static_cast<QByteArray *>(info);
+                  },
+                  new QByteArray(data));
+}
+
+QString X11WindowIconStore::dataUri(xcb_window_t window)
+{
+    const QImage icon = image(QString::number(window), {});
+    if (icon.isNull())
+        return {};
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    icon.save(&buffer, "PNG");
+    return QString("data:image/png;base64,%1").arg(QString::fromLatin1(buffer.data().toBase64()));
+}
+
+}
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <xcb/xcb.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+namespace dock {
+
+// Raw _NET_WM_ICON data of the windows, keyed by the window and the hash of the content.
+// The data isn't encoded, the entry fitting the requested size is wrapped into an image on request.
+class X11WindowIconStore
+{
+public:
+    static X11WindowIconStore *instance();
+
+    // id of the image provider serving the icons to qml.
+    static QString providerId();
+    static QString iconUrl(xcb_window_t window, size_t hash);
+    // returns the id of the url for the provider, it's empty if it isn't an icon url.
+    static QString idOfUrl(const QString &url);
+
+    // data is the value of _NET_WM_ICON, i.e. width, height and pixels of every entry,
+    // returns the url of the icon, it's empty if there is no valid entry.
+    QString insert(xcb_window_t window, const uint32_t *data, int length);
+    void remove(xcb_window_t window);
+
+    // the smallest entry covering the size, or the largest one if none does.
+    QImage image(const QString &id, const QSize &size);
+    // the largest entry of the icon of the window as a PNG data uri, it's empty if there is no icon.
+    QString dataUri(xcb_window_t window);
+
+private:
+    X11WindowIconStore() = default;
+
+private:
+    struct Icon
+    {
+        size_t hash;
+        QByteArray data;
+    };
+
+    QMutex m_mutex;
+    QHash<xcb_window_t, Icon> m_icons;
+};
+
+}
@@ -7,15 +7,19 @@
 #include "x11preview.h"
 #include "abstractwindow.h"
 #include "x11windowmonitor.h"
+#include "xcbeventhub.h"
 #include "abstractwindowmonitor.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <utility>
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
 
 #include <DDBusSender>
 
 #include <QPointer>
+#include <QTimer>
 #include <QWindow>
 #include <QGuiApplication>
 #include <QLoggingCategory>
@@ -25,31 +29,18 @@
 Q_LOGGING_CATEGORY(x11Log, "org.deepin.dde.shell.dock.taskmanager.x11windowmonitor")
 
 namespace dock {
-static QPointer<X11WindowMonitor> monitor;
-bool XcbEventFilter::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *)
-{
-    if (eventType != "xcb_generic_event_t" || monitor.isNull())
-        return false;
-
-    auto xcb_event = reinterpret_cast<xcb_generic_event_t*>(message);
-    switch (xcb_event->response_type) {
-        case XCB_PROPERTY_NOTIFY: {
-            auto pE = reinterpret_cast<xcb_property_notify_event_t*>(xcb_event);
-            Q_EMIT monitor->windowPropertyChanged(pE->window, pE->atom);
-            break;
-        }
-    }
-    return false;
-};
+// bursts of property changes are flushed at most once in the interval.
+static const int FlushInterval = 50;
 
 X11WindowMonitor::X11WindowMonitor(QObject* parent)
     : AbstractWindowMonitor(parent)
     , m_opacity(0.2)
+    , m_flushTimer(new QTimer(this))
 {
-    monitor = this;
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &X11WindowMonitor::flushDirtyWindows);
     connect(this, &X11WindowMonitor::windowMapped, this, &X11WindowMonitor::onWindowMapped);
     connect(this, &X11WindowMonitor::windowDestroyed, this, &X11WindowMonitor::onWindowDestroyed);
-    connect(this, &X11WindowMonitor::windowPropertyChanged, this, &X11WindowMonitor::onWindowPropertyChanged);
 }
 
 X11WindowMonitor::~X11WindowMonitor()
@@ -62,35 +53,45 @@ X11WindowMonitor::~X11WindowMonitor()
 
 void X11WindowMonitor::start()
 {
-    const xcb_setup_t *setup = xcb_get_setup(X11->getXcbConnection());
-    xcb_screen_iterator_t iter = xcb_setup_roots_iterator(setup);
-    xcb_screen_t *screen = iter.data;
-    m_rootWindow = screen->root;
-
-    uint32_t value_list[] = {
-            0                               | XCB_EVENT_MASK_PROPERTY_CHANGE        |
-            XCB_EVENT_MASK_VISIBILITY_CHANGE    | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY    |
-            XCB_EVENT_MASK_STRUCTURE_NOTIFY     | XCB_EVENT_MASK_FOCUS_CHANGE
+    auto hub = XcbEventHub::instance();
+
+    // the atoms are interned already, dispatching a property event is an integer lookup.
+    m_windowProperties = {
+        {X11->atom(NetWmStateAtom), WindowStateProperty},
+        {X11->atom(NetWmPidAtom), WindowPidProperty},
+        {X11->atom(NetWmNameAtom), WindowNameProperty},
+        {X11->atom(NetWmIconAtom), WindowIconProperty},
+        {X11->atom(NetWmAllowedActionsAtom), WindowAllowedActionsProperty},
+        {X11->atom(NetWmWindowTypeAtom), WindowTypesProperty},
+        {X11->atom(MotifWmHintsAtom), WindowMotifWMHintsProperty},
+        {X11->atom(WmClassAtom), WindowWMClassProperty},
     };
+    // only the events of the atoms are delivered by the hub.
+    for (auto iter = m_windowProperties.cbegin(); iter != m_windowProperties.cend(); ++iter) {
+        hub->subscribeProperty(this, XCB_WINDOW_NONE, iter.key(), [this](xcb_window_t window, xcb_atom_t atom) {
+            onWindowPropertyChanged(window, atom);
+        });
+    }
+    connect(hub, &XcbEventHub::clientListChanged, this, &X11WindowMonitor::onClientListChanged);
 
-    xcb_change_window_attributes(X11->getXcbConnection(), m_rootWindow, XCB_CW_EVENT_MASK, value_list);
-    xcb_flush(X11->getXcbConnection());
-
-    m_xcbEventFilter.reset(new XcbEventFilter());
-    qApp->installNativeEventFilter(m_xcbEventFilter.get());
-    QMetaObject::invokeMethod(this, &X11WindowMonitor::handleRootWindowClientListChanged);
+    QMetaObject::invokeMethod(this, [this]() {
+        addWindows(XcbEventHub::instance()->clientList());
+    }, Qt::QueuedConnection);
 }
 
 void X11WindowMonitor::stop()
 {
-    qApp->removeNativeEventFilter(m_xcbEventFilter.get());
-    m_xcbEventFilter.reset(nullptr);
+    auto hub = XcbEventHub::instance();
+    hub->unsubscribe(this);
+    disconnect(hub, nullptr, this, nullptr);
     Q_EMIT AbstractWindowMonitor::WindowMonitorShutdown();
 }
 
 
 void X11WindowMonitor::clear()
 {
+    m_flushTimer->stop();
+    m_dirtyWindows.clear();
     clearTrackedWindows();
     m_windows.clear();
     m_windowPreview.reset(nullptr);
@@ -176,21 +177,41 @@ void X11WindowMonitor::clearPreviewState()
 
 void X11WindowMonitor::onWindowMapped(xcb_window_t xcb_window)
 {
-    auto window = m_windows.value(xcb_window, nullptr);
-    if (window) return;
-    window = QSharedPointer<X11Window>{new X11Window(xcb_window, this)};
-    m_windows.insert(xcb_window, window);
+    addWindows({xcb_window});
+}
 
-    if (window->pid() == qApp->applicationPid()) return;
+void X11WindowMonitor::addWindows(const QList<xcb_window_t> &xcbWindows)
+{
+    QList<QSharedPointer<X11Window>> windows;
+    QList<WindowPropertiesCookie> cookies;
+    for (auto xcbWindow : xcbWindows) {
+        if (m_windows.contains(xcbWindow))
+            continue;
+
+        auto window = QSharedPointer<X11Window>{new X11Window(xcbWindow, this)};
+        m_windows.insert(xcbWindow, window);
+        windows << window;
+        // all the requests are sent before waiting for any reply.
+        cookies << X11->requestWindowProperties(xcbWindow, AllWindowProperties);
+    }
+
+    for (int i = 0; i < windows.size(); ++i) {
+        windows[i]->refresh(X11->getWindowProperties(cookies[i]));
+    }
 
-    uint32_t value_list[] = { XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE};
-    xcb_change_window_attributes(X11->getXcbConnection(), xcb_window, XCB_CW_EVENT_MASK, value_list);
-    trackWindow(window.get());
-    Q_EMIT AbstractWindowMonitor::windowAdded(static_cast<QPointer<AbstractWindow>>(window.get()));
+    for (const auto &window : std::as_const(windows)) {
+        if (window->pid() == qApp->applicationPid())
+            continue;
+
+        XcbEventHub::instance()->selectWindowEvents(window->id());
+        trackWindow(window.get());
+        Q_EMIT AbstractWindowMonitor::windowAdded(static_cast<QPointer<AbstractWindow>>(window.get()));
+    }
 }
 
 void X11WindowMonitor::onWindowDestroyed(xcb_window_t xcb_window)
 {
+    m_dirtyWindows.remove(xcb_window);
     auto window = m_windows.value(xcb_window, nullptr);
     if (window) {
         destroyWindow(window.get());
@@ -198,59 +219,65 @@ void X11WindowMonitor::onWindowDestroyed(xcb_window_t xcb_window)
     }
 }
 
+void X11WindowMonitor::onClientListChanged(const QList<xcb_window_t> &added, const QList<xcb_window_t> &removed)
+{
+    // the properties of the new windows are fetched in one batch.
+    addWindows(added);
+
+    for (auto window : removed) {
+        Q_EMIT windowDestroyed(window);
+    }
+}
+
 void X11WindowMonitor::onWindowPropertyChanged(xcb_window_t window, xcb_atom_t atom)
 {
-    if (window == m_rootWindow) {
-        handleRootWindowPropertyNotifyEvent(atom);
+    if (!m_windows.contains(window)) {
         return;
     }
 
-    auto x11Window = m_windows.value(window);
-    if (!x11Window) {
+    // the property is refetched when the changes are flushed, a burst of changes costs one fetch.
+    const auto property = windowProperty(atom);
+    if (property == 0)
         return;
-    }
 
-    if (atom == X11->getAtomByName("_NET_WM_STATE")) {
-        x11Window->updateWindowState();
-    }else if (atom == X11->getAtomByName("_NET_WM_PID")) {
-        x11Window->updatePid();
-    } else if (atom == X11->getAtomByName("_NET_WM_NAME")) {
-        x11Window->updateTitle();
-    } else if (atom == X11->getAtomByName("_NET_WM_ICON")) {
-        x11Window->updateIcon();
-    } else if (atom == X11->getAtomByName("_NET_WM_ALLOWED_ACTIONS")) {
-        x11Window->updateWindowAllowedActions();
-    } else if (atom == X11->getAtomByName("_NET_WM_WINDOW_TYPE")) {
-        x11Window->updateWindowTypes();
-    } else if (atom == X11->getAtomByName("_MOTIF_WM_HINTS")) {
-        x11Window->updateMotifWmHints();
-    } else if (atom == X11->getAtomByName("WM_CLASS")) {
-        x11Window->updateIdentify();
-    }
+    m_dirtyWindows[window] |= property;
+    scheduleFlush();
 }
 
-void X11WindowMonitor::handleRootWindowPropertyNotifyEvent(xcb_atom_t atom)
+uint X11WindowMonitor::windowProperty(xcb_atom_t atom) const
 {
-    if (atom == X11->getAtomByName("_NET_CLIENT_LIST")) {
-        handleRootWindowClientListChanged();
-    }
+    return m_windowProperties.value(atom, 0);
 }
 
-void X11WindowMonitor::handleRootWindowClientListChanged()
+void X11WindowMonitor::scheduleFlush()
 {
-    auto currentOpenedWindowList = X11->getWindowClientList(m_rootWindow);
+    if (m_flushTimer->isActive())
+        return;
 
-    for (auto openedWindows : currentOpenedWindowList) {
-        if (!m_windows.contains(openedWindows)) {
-            onWindowMapped(openedWindows);
-        }
-    }
+    // it's flushed in the next iteration of the event loop, unless it's flushed recently.
+    const auto elapsed = m_lastFlush.isValid() ? m_lastFlush.elapsed() : FlushInterval;
+    m_flushTimer->start(static_cast<int>(std::max<qint64>(0, FlushInterval - elapsed)));
+}
 
-    for (auto alreadyOpenedWindow : m_windows.keys()) {
-        if (!currentOpenedWindowList.contains(alreadyOpenedWindow)) {
-            Q_EMIT windowDestroyed(alreadyOpenedWindow);
+void X11WindowMonitor::flushDirtyWindows()
+{
+    m_lastFlush.start();
+
+    const auto dirtyWindows = std::exchange(m_dirtyWindows, {});
+    QList<QSharedPointer<X11Window>> windows;
+    QList<WindowPropertiesCookie> cookies;
+    for (auto iter = dirtyWindows.cbegin(); iter != dirtyWindows.cend(); ++iter) {
+        if (auto x11Window = m_windows.value(iter.key())) {
+            windows << x11Window;
+            cookies << X11->requestWindowProperties(iter.key(), iter.value());
         }
     }
 
+    beginWindowUpdate();
+    for (int i = 0; i < windows.size(); ++i) {
+        windows[i]->refresh(X11->getWindowProperties(cookies[i]));
+    }
+    endWindowUpdate();
 }
+
 }
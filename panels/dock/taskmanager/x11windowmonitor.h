@@ -14,17 +14,13 @@
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
 
+#include <QElapsedTimer>
 #include <QHash>
 #include <QScopedPointer>
-#include <QAbstractNativeEventFilter>
 
-namespace dock {
-class XcbEventFilter: public QAbstractNativeEventFilter
-{
-public:
-    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *) override;
-};
+class QTimer;
 
+namespace dock {
 class X11WindowMonitor : public AbstractWindowMonitor
 {
     Q_OBJECT
@@ -51,24 +47,31 @@ public:
 Q_SIGNALS:
     void windowMapped(xcb_window_t window);
     void windowDestroyed(xcb_window_t window);
-    void windowPropertyChanged(xcb_window_t window, xcb_atom_t atom);
 
 private Q_SLOTS:
     void onWindowMapped(xcb_window_t window);
     void onWindowDestroyed(xcb_window_t window);
+    void onClientListChanged(const QList<xcb_window_t> &added, const QList<xcb_window_t> &removed);
     void onWindowPropertyChanged(xcb_window_t window, xcb_atom_t atom);
 
 private:
     void monitorX11Event();
-    void handleRootWindowPropertyNotifyEvent(xcb_atom_t atom);
-    void handleRootWindowClientListChanged();
+    void addWindows(const QList<xcb_window_t> &windows);
+    uint windowProperty(xcb_atom_t atom) const;
+    void scheduleFlush();
+    void flushDirtyWindows();
 
 private:
-    xcb_window_t m_rootWindow;
-    QScopedPointer<XcbEventFilter> m_xcbEventFilter;
     std::unique_ptr<X11WindowPreviewContainer> m_windowPreview;
     QHash<xcb_window_t, QSharedPointer<X11Window>> m_windows;
+    // window properties of the atoms, see WindowProperty.
+    QHash<xcb_atom_t, uint> m_windowProperties;
     double m_opacity;
 
+    // changed properties of the windows since the last flush, see WindowProperty.
+    QHash<xcb_window_t, uint> m_dirtyWindows;
+    QTimer *m_flushTimer = nullptr;
+    QElapsedTimer m_lastFlush;
+
 };
 }
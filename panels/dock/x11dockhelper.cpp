@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -6,13 +6,13 @@
 #include "constants.h"
 #include "dockhelper.h"
 #include "dockpanel.h"
+#include "xcbeventhub.h"
 
 #include <algorithm>
 #include <xcb/res.h>
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
 
-#include <QAbstractNativeEventFilter>
 #include <QGuiApplication>
 #include <QPointer>
 #include <QDBusConnection>
@@ -41,32 +41,46 @@ struct WindowData
     }
 };
 
-XcbEventFilter::XcbEventFilter(X11DockHelper *helper)
-    : m_helper(helper)
+XcbHelper::XcbHelper(X11DockHelper *helper)
+    : QObject(helper)
+    , m_helper(helper)
     , m_currentWorkspace(0)
 {
-    auto *x11Application = qGuiApp->nativeInterface<QNativeInterface::QX11Application>();
-    m_connection = x11Application->connection();
-    xcb_ewmh_init_atoms_replies(&m_ewmh, xcb_ewmh_init_atoms(m_connection, &m_ewmh), nullptr);
-
-    const xcb_setup_t *setup = xcb_get_setup(m_connection);
-    xcb_screen_iterator_t iter = xcb_setup_roots_iterator(setup);
-    xcb_screen_t *screen = iter.data;
-    m_rootWindow = screen->root;
-
-    uint32_t value_list[] = { XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_VISIBILITY_CHANGE | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE };
+    auto hub = XcbEventHub::instance();
+    m_connection = hub->connection();
+    m_rootWindow = hub->rootWindow();
+    m_ewmh = hub->ewmh();
 
-    xcb_change_window_attributes(m_connection, m_rootWindow, XCB_CW_EVENT_MASK, value_list);
-    xcb_flush(m_connection);
+    hub->subscribeProperty(this, m_rootWindow, m_ewmh->_NET_CURRENT_DESKTOP, [this](xcb_window_t, xcb_atom_t) {
+        checkCurrentWorkspace();
+    });
+    // only the state and the workspace of the client windows are watched.
+    for (auto property : {getAtomByName("WM_STATE"), m_ewmh->_NET_WM_DESKTOP}) {
+        hub->subscribeProperty(this, XCB_WINDOW_NONE, property, [this](xcb_window_t window, xcb_atom_t atom) {
+            if (window != m_rootWindow)
+                Q_EMIT windowPropertyChanged(window, atom);
+        });
+    }
+    connect(hub, &XcbEventHub::clientListChanged, this, &XcbHelper::windowClientListChanged);
+    connect(hub, &XcbEventHub::windowConfigured, this, &XcbHelper::windowGeometryChanged);
+    connect(hub, &XcbEventHub::windowEntered, this, [this](xcb_window_t window) {
+        processEnterLeave(window, true);
+    });
+    connect(hub, &XcbEventHub::windowLeft, this, [this](xcb_window_t window) {
+        processEnterLeave(window, false);
+    });
 }
 
-bool XcbEventFilter::inTriggerArea(xcb_window_t win) const
+bool XcbHelper::inTriggerArea(xcb_window_t win) const
 {
     return m_helper->m_areas.contains(win);
 }
 
-void XcbEventFilter::processEnterLeave(xcb_window_t win, bool enter)
+void XcbHelper::processEnterLeave(xcb_window_t win, bool enter)
 {
+    if (m_helper.isNull())
+        return;
+
     if (inTriggerArea(win)) {
         if (enter) {
             m_helper->enterScreen(m_helper->m_areas.value(win)->screen());
@@ -76,106 +90,27 @@ void XcbEventFilter::processEnterLeave(xcb_window_t win, bool enter)
     }
 }
 
-bool XcbEventFilter::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *)
+xcb_atom_t XcbHelper::getAtomByName(const QString &name)
 {
-    if (eventType != "xcb_generic_event_t" || m_helper.isNull())
-        return false;
-
-    auto xcb_event = reinterpret_cast<xcb_generic_event_t *>(message);
-    switch (xcb_event->response_type & ~0x80) {
-    case XCB_ENTER_NOTIFY: {
-        auto eN = reinterpret_cast<xcb_enter_notify_event_t *>(xcb_event);
-        processEnterLeave(eN->event, true);
-        break;
-    }
-    case XCB_LEAVE_NOTIFY: {
-        auto lN = reinterpret_cast<xcb_leave_notify_event_t *>(xcb_event);
-        processEnterLeave(lN->event, false);
-        break;
-    }
-    case XCB_PROPERTY_NOTIFY: {
-        auto pE = reinterpret_cast<xcb_property_notify_event_t *>(xcb_event);
-        if (pE->window == m_rootWindow) {
-            if (pE->atom == getAtomByName("_NET_CLIENT_LIST")) {
-                Q_EMIT windowClientListChanged();
-            } else if (pE->atom == getAtomByName("_NET_CURRENT_DESKTOP")) {
-                checkCurrentWorkspace();
-            }
-        } else {
-            Q_EMIT windowPropertyChanged(pE->window, pE->atom);
-        }
-        break;
-    }
-    case XCB_CONFIGURE_NOTIFY: {
-        auto cE = reinterpret_cast<xcb_configure_notify_event_t *>(xcb_event);
-        Q_EMIT windowGeometryChanged(cE->window);
-        break;
-    }
-    }
-    return false;
+    return XcbEventHub::instance()->atom(name.toLatin1());
 }
 
-xcb_atom_t XcbEventFilter::getAtomByName(const QString &name)
+QString XcbHelper::getNameByAtom(const xcb_atom_t &atom)
 {
-    xcb_atom_t ret = m_atoms.value(name, 0);
-    if (!ret) {
-        xcb_intern_atom_cookie_t cookie = xcb_intern_atom(m_connection, false, name.size(), name.toStdString().c_str());
-        QSharedPointer<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(m_connection, cookie, nullptr), [](xcb_intern_atom_reply_t *reply) {
-            free(reply);
-        });
-
-        if (reply) {
-            m_atoms.insert(name, xcb_atom_t(reply->atom));
-            ret = reply->atom;
-        }
-    }
-    return ret;
+    return QString::fromLatin1(XcbEventHub::instance()->atomName(atom));
 }
 
-QString XcbEventFilter::getNameByAtom(const xcb_atom_t &atom)
+QList<xcb_window_t> XcbHelper::getWindowClientList()
 {
-    auto name = m_atoms.key(atom);
-    if (name.isEmpty()) {
-        xcb_get_atom_name_cookie_t cookie = xcb_get_atom_name(m_connection, atom);
-        QSharedPointer<xcb_get_atom_name_reply_t> reply(xcb_get_atom_name_reply(m_connection, cookie, nullptr), [](xcb_get_atom_name_reply_t *reply) {
-            free(reply);
-        });
-        if (!reply) {
-            qCWarning(dockX11Log) << "failed to get atom value for " + name;
-            return name;
-        }
-        std::string tmp;
-        tmp.assign(xcb_get_atom_name_name(reply.get()), xcb_get_atom_name_name_length(reply.get()));
-        name = tmp.c_str();
-        if (!name.isEmpty()) {
-            m_atoms.insert(name, atom);
-        }
-    }
-    return name;
+    return XcbEventHub::instance()->clientList();
 }
 
-QList<xcb_window_t> XcbEventFilter::getWindowClientList()
-{
-    QList<xcb_window_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_client_list(&m_ewmh, 0);
-    xcb_ewmh_get_windows_reply_t reply;
-    if (xcb_ewmh_get_client_list_reply(&m_ewmh, cookie, &reply, nullptr)) {
-        for (uint32_t i = 0; i < reply.windows_len; i++) {
-            ret.push_back(reply.windows[i]);
-        }
-
-        xcb_ewmh_get_windows_reply_wipe(&reply);
-    }
-
-    return ret;
-}
-
-QList<xcb_atom_t> XcbEventFilter::getWindowState(const xcb_window_t &window)
+QList<xcb_atom_t> XcbHelper::getWindowState(const xcb_window_t &window)
 {
     QList<xcb_atom_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_state(&m_ewmh, window);
+    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_state(m_ewmh, window);
     xcb_ewmh_get_atoms_reply_t reply;
-    if (xcb_ewmh_get_wm_state_reply(&m_ewmh, cookie, &reply, nullptr)) {
+    if (xcb_ewmh_get_wm_state_reply(m_ewmh, cookie, &reply, nullptr)) {
         for (uint32_t i = 0; i < reply.atoms_len; i++) {
             ret.push_back(reply.atoms[i]);
         }
@@ -185,12 +120,12 @@ QList<xcb_atom_t> XcbEventFilter::getWindowState(const xcb_window_t &window)
     return ret;
 }
 
-QList<xcb_atom_t> XcbEventFilter::getWindowTypes(const xcb_window_t &window)
+QList<xcb_atom_t> XcbHelper::getWindowTypes(const xcb_window_t &window)
 {
     QList<xcb_atom_t> ret;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_window_type(&m_ewmh, window);
+    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_window_type(m_ewmh, window);
     xcb_ewmh_get_atoms_reply_t reply; // a list of Atom
-    if (xcb_ewmh_get_wm_window_type_reply(&m_ewmh, cookie, &reply, nullptr)) {
+    if (xcb_ewmh_get_wm_window_type_reply(m_ewmh, cookie, &reply, nullptr)) {
         for (uint32_t i = 0; i < reply.atoms_len; i++) {
             ret.push_back(reply.atoms[i]);
         }
@@ -199,7 +134,7 @@ QList<xcb_atom_t> XcbEventFilter::getWindowTypes(const xcb_window_t &window)
     return ret;
 }
 
-QRect XcbEventFilter::getWindowGeometry(const xcb_window_t &window)
+QRect XcbHelper::getWindowGeometry(const xcb_window_t &window)
 {
     QRect geometry;
     xcb_get_geometry_cookie_t cookie = xcb_get_geometry(m_connection, window);
@@ -245,7 +180,7 @@ QRect XcbEventFilter::getWindowGeometry(const xcb_window_t &window)
     return geometry;
 }
 
-xcb_window_t XcbEventFilter::getDecorativeWindow(const xcb_window_t &window)
+xcb_window_t XcbHelper::getDecorativeWindow(const xcb_window_t &window)
 {
     xcb_window_t win = window;
     for (int i = 0; i < 10; i++) {
@@ -264,14 +199,14 @@ xcb_window_t XcbEventFilter::getDecorativeWindow(const xcb_window_t &window)
     return 0;
 }
 
-uint32_t XcbEventFilter::getWindowWorkspace(const xcb_window_t &window)
+uint32_t XcbHelper::getWindowWorkspace(const xcb_window_t &window)
 {
     uint32_t desktop = XCB_NONE;
-    xcb_ewmh_get_wm_desktop_reply(&m_ewmh, xcb_ewmh_get_wm_desktop(&m_ewmh, window), &desktop, nullptr);
+    xcb_ewmh_get_wm_desktop_reply(m_ewmh, xcb_ewmh_get_wm_desktop(m_ewmh, window), &desktop, nullptr);
     return desktop;
 }
 
-uint32_t XcbEventFilter::getCurrentWorkspace()
+uint32_t XcbHelper::getCurrentWorkspace()
 {
     if (m_currentWorkspace <= 0) {
         checkCurrentWorkspace();
@@ -279,10 +214,10 @@ uint32_t XcbEventFilter::getCurrentWorkspace()
     return m_currentWorkspace;
 }
 
-void XcbEventFilter::checkCurrentWorkspace()
+void XcbHelper::checkCurrentWorkspace()
 {
     uint32_t desktop = XCB_NONE;
-    int ret = xcb_ewmh_get_current_desktop_reply(&m_ewmh, xcb_ewmh_get_current_desktop(&m_ewmh, 0), &desktop, nullptr);
+    int ret = xcb_ewmh_get_current_desktop_reply(m_ewmh, xcb_ewmh_get_current_desktop(m_ewmh, 0), &desktop, nullptr);
     if (ret > 0) {
         if (desktop != m_currentWorkspace) {
             m_currentWorkspace = desktop;
@@ -293,7 +228,7 @@ void XcbEventFilter::checkCurrentWorkspace()
     }
 }
 
-bool XcbEventFilter::shouldSkip(const xcb_window_t &window)
+bool XcbHelper::shouldSkip(const xcb_window_t &window)
 {
     QList<xcb_atom_t> windowTypes = getWindowTypes(window);
     for (auto atom : windowTypes) {
@@ -307,20 +242,19 @@ bool XcbEventFilter::shouldSkip(const xcb_window_t &window)
     return false;
 }
 
-void XcbEventFilter::monitorWindowChange(const xcb_window_t &window)
+void XcbHelper::monitorWindowChange(const xcb_window_t &window)
 {
-    uint32_t value_list[] = { XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE };
-    xcb_change_window_attributes(m_connection, window, XCB_CW_EVENT_MASK, value_list);
-};
+    XcbEventHub::instance()->selectWindowEvents(window);
+}
 
-void XcbEventFilter::setWindowState(const xcb_window_t& window, uint32_t list_len, xcb_atom_t *state)
+void XcbHelper::setWindowState(const xcb_window_t& window, uint32_t list_len, xcb_atom_t *state)
 {
-    xcb_ewmh_set_wm_state(&m_ewmh, window, list_len, state);
+    xcb_ewmh_set_wm_state(m_ewmh, window, list_len, state);
 }
 
 X11DockHelper::X11DockHelper(DockPanel *panel)
     : DockHelper(panel)
-    , m_xcbHelper(new XcbEventFilter(this))
+    , m_xcbHelper(new XcbHelper(this))
     , m_updateDockAreaTimer(new QTimer(this))
     , m_showingDesktop(false)
 {
@@ -336,7 +270,6 @@ X11DockHelper::X11DockHelper(DockPanel *panel)
     connect(panel, &DockPanel::showInPrimaryChanged, m_updateDockAreaTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
     connect(panel, &DockPanel::dockScreenChanged, m_updateDockAreaTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
 
-    qGuiApp->installNativeEventFilter(m_xcbHelper);
     setupKWinDBusConnection();
     onHideModeChanged(panel->hideMode());
 }
@@ -369,11 +302,11 @@ void X11DockHelper::onHideModeChanged(HideMode mode)
 
     switch (mode) {
     case SmartHide: {
-        onWindowClientListChanged();
-        connect(m_xcbHelper, &XcbEventFilter::windowClientListChanged, this, &X11DockHelper::onWindowClientListChanged);
-        connect(m_xcbHelper, &XcbEventFilter::windowPropertyChanged, this, &X11DockHelper::onWindowPropertyChanged);
-        connect(m_xcbHelper, &XcbEventFilter::windowGeometryChanged, this, &X11DockHelper::onWindowGeometryChanged);
-        connect(m_xcbHelper, &XcbEventFilter::currentWorkspaceChanged, this, [this]() {
+        onWindowClientListChanged(m_xcbHelper->getWindowClientList(), {});
+        connect(m_xcbHelper, &XcbHelper::windowClientListChanged, this, &X11DockHelper::onWindowClientListChanged);
+        connect(m_xcbHelper, &XcbHelper::windowPropertyChanged, this, &X11DockHelper::onWindowPropertyChanged);
+        connect(m_xcbHelper, &XcbHelper::windowGeometryChanged, this, &X11DockHelper::onWindowGeometryChanged);
+        connect(m_xcbHelper, &XcbHelper::currentWorkspaceChanged, this, [this]() {
             static bool updating = false;
             if (updating)
                 return;
@@ -399,23 +332,19 @@ void X11DockHelper::onHideModeChanged(HideMode mode)
     }
 }
 
-void X11DockHelper::onWindowClientListChanged()
+void X11DockHelper::onWindowClientListChanged(const QList<xcb_window_t> &added, const QList<xcb_window_t> &removed)
 {
-    QList<xcb_window_t> windows = m_xcbHelper->getWindowClientList();
-    for (auto &&window : windows) {
+    for (auto &&window : added) {
         if (!m_windows.contains(window) && !m_xcbHelper->shouldSkip(window)) {
             m_windows.insert(window, new WindowData());
             onWindowAdded(window);
         }
     }
     bool mightNeedRecheckDockOverlap = false;
-    for (auto it = m_windows.cbegin(); it != m_windows.cend();) {
-        if (!windows.contains(it.key())) {
-            delete it.value();
-            it = m_windows.erase(it);
+    for (auto &&window : removed) {
+        if (auto data = m_windows.take(window)) {
+            delete data;
             mightNeedRecheckDockOverlap = true;
-        } else {
-            it++;
         }
     }
     if (mightNeedRecheckDockOverlap) {
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 #pragma once
@@ -14,12 +14,12 @@ class X11DockWakeUpArea;
 class X11DockHelper;
 struct WindowData;
 
-class XcbEventFilter: public QObject, public QAbstractNativeEventFilter
+// X11 helpers of the dock, the events are delivered by the shared XcbEventHub.
+class XcbHelper: public QObject
 {
     Q_OBJECT
 public:
-    XcbEventFilter(X11DockHelper* helper);
-    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *) override;
+    XcbHelper(X11DockHelper* helper);
 
     xcb_atom_t getAtomByName(const QString& name);
     QString getNameByAtom(const xcb_atom_t& atom);
@@ -36,7 +36,8 @@ public:
     void setWindowState(const xcb_window_t& window, uint32_t list_len, xcb_atom_t *state);
 
 Q_SIGNALS:
-    void windowClientListChanged();
+    // both lists are sorted.
+    void windowClientListChanged(const QList<xcb_window_t> &added, const QList<xcb_window_t> &removed);
     void windowPropertyChanged(xcb_window_t window, xcb_atom_t atom);
     void windowGeometryChanged(xcb_window_t window);
     void currentWorkspaceChanged();
@@ -46,10 +47,9 @@ private:
     void processEnterLeave(xcb_window_t win, bool enter);
 
     QPointer<X11DockHelper> m_helper;
-    QMap<QString, xcb_atom_t> m_atoms;
     xcb_connection_t* m_connection;
     xcb_window_t m_rootWindow;
-    xcb_ewmh_connection_t m_ewmh;
+    xcb_ewmh_connection_t *m_ewmh;
     uint32_t m_currentWorkspace;
 };
 
@@ -70,7 +70,7 @@ protected:
 private Q_SLOTS:
     void onHideModeChanged(HideMode mode);
 
-    void onWindowClientListChanged();
+    void onWindowClientListChanged(const QList<xcb_window_t> &added, const QList<xcb_window_t> &removed);
     void onWindowAdded(xcb_window_t window);
     void onWindowPropertyChanged(xcb_window_t window, xcb_atom_t atom);
     void onWindowGeometryChanged(xcb_window_t window);
@@ -84,14 +84,14 @@ private Q_SLOTS:
     void onShowingDesktopChanged(bool showing);
 
 private:
-    friend class XcbEventFilter;
+    friend class XcbHelper;
     void setupKWinDBusConnection();
 
 private:
     QHash<xcb_window_t, X11DockWakeUpArea *> m_areas;
     QRect m_dockArea;
     QHash<xcb_window_t, WindowData*> m_windows;
-    XcbEventFilter *m_xcbHelper;
+    XcbHelper *m_xcbHelper;
     QTimer *m_updateDockAreaTimer;
     bool m_showingDesktop;
 };
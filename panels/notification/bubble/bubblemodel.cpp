@@ -5,15 +5,19 @@
 #include "bubblemodel.h"
 
 #include <notifysetting.h>
+#include <notifytimeticker.h>
 
 #include "bubbleitem.h"
 
+#include <QDateTime>
 #include <QTimer>
 #include <QLoggingCategory>
 #include <QImage>
 #include <QTemporaryFile>
 #include <QUrl>
 
+#include <limits>
+
 namespace notification {
 Q_DECLARE_LOGGING_CATEGORY(notifyLog)
 }
@@ -22,18 +26,17 @@ namespace notification {
 
 BubbleModel::BubbleModel(QObject *parent)
     : QAbstractListModel(parent)
-    , m_updateTimeTipTimer(new QTimer(this))
     , m_processPendingTimer(new QTimer(this))
+    , m_timeTipUpdated(QDateTime::currentMSecsSinceEpoch())
 {
-    m_updateTimeTipTimer->setInterval(1000);
-    m_updateTimeTipTimer->setSingleShot(false);
-
     m_processPendingTimer->setInterval(300);
     m_processPendingTimer->setSingleShot(true);
 
     m_maxKeep = NotifySetting::instance()->bubbleCount() + 2; // max keep folds.
 
-    connect(m_updateTimeTipTimer, &QTimer::timeout, this, &BubbleModel::updateBubbleTimeTip);
+    NotifyTimeTicker::instance()->attach(this, [this](qint64 current) {
+        return updateBubbleTimeTip(current);
+    });
     connect(m_processPendingTimer, &QTimer::timeout, this, [this] {
         if (!m_pendingBubbles.isEmpty()) {
             auto bubble = m_pendingBubbles.dequeue();
@@ -56,9 +59,8 @@ BubbleModel::~BubbleModel()
 
 void BubbleModel::push(BubbleItem *bubble)
 {
-    if (!m_updateTimeTipTimer->isActive()) {
-        m_updateTimeTipTimer->start();
-    }
+    const auto deadline = NotifyEntity::nextRelativeTimeChange(bubble->ctime(), QDateTime::currentMSecsSinceEpoch());
+    NotifyTimeTicker::instance()->schedule(this, deadline);
 
     if (m_processPendingTimer->isActive()) {
         m_pendingBubbles.enqueue(bubble);
@@ -98,6 +100,9 @@ BubbleItem *BubbleModel::replaceBubble(BubbleItem *bubble)
     m_bubbles.replace(replaceIndex, bubble);
     Q_EMIT dataChanged(index(replaceIndex), index(replaceIndex));
 
+    const auto deadline = NotifyEntity::nextRelativeTimeChange(bubble->ctime(), QDateTime::currentMSecsSinceEpoch());
+    NotifyTimeTicker::instance()->schedule(this, deadline);
+
     return oldBubble;
 }
 
@@ -116,7 +121,7 @@ void BubbleModel::clear()
     m_bubbles.clear();
     endResetModel();
 
-    m_updateTimeTipTimer->stop();
+    NotifyTimeTicker::instance()->cancel(this);
 }
 
 QList<BubbleItem *> BubbleModel::items() const
@@ -270,21 +275,23 @@ int BubbleModel::replaceBubbleIndex(const BubbleItem *bubble) const
     return -1;
 }
 
-void BubbleModel::updateBubbleTimeTip()
+qint64 BubbleModel::updateBubbleTimeTip(qint64 current)
 {
-    if (m_bubbles.isEmpty()) {
-        m_updateTimeTipTimer->stop();
-        return;
-    }
-
-    for (auto item : m_bubbles) {
-        QString timeTip = NotifyEntity::formatRelativeTime(item->ctime());
-        if (!timeTip.isEmpty()) {
-            item->setTimeTip(timeTip);
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < m_bubbles.size(); i++) {
+        auto item = m_bubbles[i];
+        // only the bubbles whose time tip changed since the last update are refreshed.
+        if (NotifyEntity::nextRelativeTimeChange(item->ctime(), m_timeTipUpdated) <= current) {
+            QString timeTip = NotifyEntity::formatRelativeTime(item->ctime());
+            if (!timeTip.isEmpty()) {
+                item->setTimeTip(timeTip);
+                Q_EMIT dataChanged(index(i), index(i), {BubbleModel::TimeTip});
+            }
         }
+        deadline = std::min(deadline, NotifyEntity::nextRelativeTimeChange(item->ctime(), current));
     }
-
-    Q_EMIT dataChanged(index(0), index(m_bubbles.size() - 1), {BubbleModel::TimeTip});
+    m_timeTipUpdated = current;
+    return deadline;
 }
 
 void BubbleModel::updateContentRowCount(int rowCount)
@@ -65,12 +65,12 @@ private:
     void insertBubble(BubbleItem *bubble);
     void updateBubbleCount(int count);
     int replaceBubbleIndex(const BubbleItem *bubble) const;
-    void updateBubbleTimeTip();
+    qint64 updateBubbleTimeTip(qint64 current);
     void updateContentRowCount(int rowCount);
 
 private:
-    QTimer *m_updateTimeTipTimer = nullptr;
     QTimer *m_processPendingTimer = nullptr;
+    qint64 m_timeTipUpdated = 0;
     QList<BubbleItem *> m_bubbles;
     QQueue<BubbleItem *> m_pendingBubbles;
     int m_maxKeep{5};
@@ -6,6 +6,8 @@
 #include "bubbleitem.h"
 #include "bubblemodel.h"
 #include "dataaccessorproxy.h"
+#include "notifyentitychannel.h"
+#include "notifyimageprovider.h"
 #include "pluginfactory.h"
 
 #include <QTimer>
@@ -13,6 +15,7 @@
 #include <QQueue>
 
 #include <appletbridge.h>
+#include <qmlengine.h>
 
 namespace notification {
 Q_DECLARE_LOGGING_CATEGORY(notifyLog)
@@ -39,6 +42,7 @@ bool BubblePanel::load()
 
 bool BubblePanel::init()
 {
+    NotifyImageProvider::registerTo(DS_NAMESPACE::DQmlEngine().engine());
     DPanel::init();
     DS_NAMESPACE::DAppletBridge bridge("org.deepin.ds.notificationserver");
     m_notificationServer = bridge.applet();
@@ -125,7 +129,10 @@ void BubblePanel::onBubbleCountChanged()
 
 void BubblePanel::addBubble(qint64 id)
 {
-    const auto entity = m_accessor->fetchEntity(id);
+    // the entity is handed over by the server if it's in this process.
+    auto entity = NotifyEntityChannel::instance()->find(id, NotifyEntity::NotProcessed);
+    if (!entity.isValid())
+        entity = m_accessor->fetchEntity(id);
 
     // Validate entity before creating bubble to prevent invalid notification banners
     if (!entity.isValid()) {
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -18,7 +18,11 @@ FocusScope {
     property alias viewPanelShown: view.viewPanelShown
     property int maxViewHeight: 400
     property int stagingViewCount: 0
+    // notifies are removed from the search results while the overview is hidden.
+    property bool overviewStale: false
     readonly property int viewCount: view.viewCount
+    // the history is searched while the search text isn't empty.
+    readonly property bool searching: searchEdit.text.trim().length > 0
 
     signal gotoStagingLast()  // Signal to Shift+Tab to staging last button
     signal gotoStagingFirst() // Signal to Tab cycle to staging first item
@@ -42,6 +46,28 @@ FocusScope {
         id: notifyModel
     }
 
+    NotifySearchModel {
+        id: searchModel
+        query: root.searching ? searchEdit.text : ""
+        onRemoved: root.overviewStale = true
+    }
+
+    onViewPanelShownChanged: {
+        if (!viewPanelShown)
+            searchEdit.text = ""
+    }
+
+    // the overview is loaded again once the search ends, a hidden panel loads it when it's shown.
+    onSearchingChanged: {
+        if (searching || !overviewStale)
+            return
+        overviewStale = false
+        if (viewPanelShown) {
+            notifyModel.close()
+            notifyModel.open()
+        }
+    }
+
     Item {
         objectName: "notificationCenter"
         anchors.fill: parent
@@ -71,11 +97,23 @@ FocusScope {
             }
         }
 
+        SearchEdit {
+            id: searchEdit
+            objectName: "searchNotify"
+            anchors {
+                top: header.bottom
+                left: parent.left
+                leftMargin: NotifyStyle.leftMargin
+            }
+            width: NotifyStyle.contentItem.width
+        }
+
         NotifyView {
             id: view
+            visible: !root.searching
             anchors {
                 left: parent.left
-                top: header.bottom
+                top: searchEdit.bottom
                 right: parent.right
                 rightMargin: NotifyStyle.scrollBarPadding
                 bottom: parent.bottom
@@ -94,11 +132,37 @@ FocusScope {
             onGotoHeaderLast: header.focusLastButton()
         }
 
+        NotifySearchView {
+            id: searchView
+            visible: root.searching
+            anchors {
+                left: parent.left
+                top: searchEdit.bottom
+                right: parent.right
+                rightMargin: NotifyStyle.scrollBarPadding
+                bottom: parent.bottom
+            }
+
+            height: Math.min(maxViewHeight, viewHeight)
+            searchModel: searchModel
+        }
+
         DropShadowText {
             text: qsTr("No recent notifications")
-            visible: root.stagingViewCount === 0 && view.viewCount === 0
+            visible: !root.searching && root.stagingViewCount === 0 && view.viewCount === 0
             anchors {
-                top: header.bottom
+                top: searchEdit.bottom
+                topMargin: 10
+                horizontalCenter: parent.horizontalCenter
+            }
+            height: 40
+        }
+
+        DropShadowText {
+            text: qsTr("No matching notifications")
+            visible: root.searching && !searchModel.searching && searchView.viewCount === 0
+            anchors {
+                top: searchEdit.bottom
                 topMargin: 10
                 horizontalCenter: parent.horizontalCenter
             }
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+import QtQuick
+import QtQuick.Controls
+import org.deepin.dtk 1.0
+import org.deepin.ds.notification
+import org.deepin.ds.notificationcenter
+
+Control {
+    id: root
+
+    required property NotifySearchModel searchModel
+    readonly property real viewHeight: view.contentHeight
+    readonly property int viewCount: view.count
+
+    contentItem: ListView {
+        id: view
+        clip: true
+        spacing: 10
+        snapMode: ListView.NoSnap
+        keyNavigationEnabled: false
+        activeFocusOnTab: false
+        boundsBehavior: Flickable.StopAtBounds
+        ScrollBar.vertical: ScrollBar { }
+        topMargin: 20
+        bottomMargin: 10
+        leftMargin: NotifyStyle.leftMargin
+
+        // the next page is fetched by the view when the last loaded result is shown.
+        model: root.searchModel
+        delegate: NormalNotify {
+            objectName: "search-" + model.appName
+            width: NotifyStyle.contentItem.width
+            activeFocusOnTab: false
+
+            appName: model.appName
+            iconName: model.iconName
+            date: model.time
+            actions: model.actions
+            title: model.title
+            content: model.content
+            strongInteractive: model.strongInteractive
+            contentIcon: model.contentIcon
+            contentRowCount: model.contentRowCount
+            defaultAction: model.defaultAction
+            indexInGroup: model.indexInGroup
+
+            onRemove: function () {
+                console.log("remove searched", model.id)
+                root.searchModel.remove(model.id)
+            }
+            onDismiss: function () {
+                console.log("dismiss searched", model.id)
+                root.searchModel.remove(model.id)
+            }
+            onActionInvoked: function (actionId) {
+                console.log("action searched", model.id, actionId)
+                root.searchModel.invokeAction(model.id, actionId)
+            }
+        }
+    }
+
+    background: BoundingRectangle {}
+}
@@ -112,6 +112,17 @@ DelegateChooser {
             defaultAction: model.defaultAction
             indexInGroup: model.indexInGroup
 
+            Component.onCompleted: {
+                // expanded apps are loaded page by page, the next page is loaded when the last loaded notify is shown.
+                if (model.indexInGroup >= 0) {
+                    let appName = model.appName
+                    let indexInGroup = model.indexInGroup
+                    Qt.callLater(function () {
+                        notifyModel.fetchMoreApp(appName, indexInGroup)
+                    })
+                }
+            }
+
             // Mouse/other devices right-click for context menu
             // Note: TouchScreen is excluded because its events bypass acceptedButtons check in Qt
             TapHandler {
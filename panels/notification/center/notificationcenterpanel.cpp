@@ -6,12 +6,14 @@
 
 #include "notificationcenterdbusadaptor.h"
 #include "notificationcenterproxy.h"
+#include "notifyimageprovider.h"
 
 #include <pluginfactory.h>
 #include <pluginloader.h>
 #include <applet.h>
 #include <containment.h>
 #include <appletbridge.h>
+#include <qmlengine.h>
 
 #include <QQueue>
 #include <QDBusConnection>
@@ -66,6 +68,7 @@ bool NotificationCenterPanel::init()
     }
     new NotificationCenterDBusAdaptor(m_proxy);
 
+    NotifyImageProvider::registerTo(DQmlEngine().engine());
     DPanel::init();
 
     return true;
@@ -12,6 +12,7 @@
 #include <DConfig>
 
 #include "dataaccessorproxy.h"
+#include "notifyentitychannel.h"
 
 #include <wayland/xdgactivation.h>
 
@@ -113,6 +114,16 @@ NotifyEntity NotifyAccessor::fetchEntity(qint64 id) const
     return ret;
 }
 
+NotifyEntity NotifyAccessor::fetchReceivedEntity(qint64 id, int processedType) const
+{
+    // the entity is handed over by the server if it's in this process.
+    auto ret = NotifyEntityChannel::instance()->find(id, processedType);
+    if (ret.isValid())
+        return ret;
+
+    return fetchEntity(id);
+}
+
 int NotifyAccessor::fetchEntityCount(const QString &appName) const
 {
     qDebug(notifyLog) << "Fetch entity count for the app" << appName;
@@ -134,6 +145,20 @@ QList<NotifyEntity> NotifyAccessor::fetchEntities(const QString &appName, int ma
     return ret;
 }
 
+QList<NotifyEntity> NotifyAccessor::fetchEntities(const QString &appName, int maxCount, qint64 cursorTime, qint64 cursorId)
+{
+    qDebug(notifyLog) << "Fetch entities page for the app" << appName << ", cursor" << cursorTime << cursorId;
+    auto ret = m_accessor->fetchEntities(appName, NotifyEntity::Processed, maxCount, cursorTime, cursorId);
+    return ret;
+}
+
+QList<NotifyEntity> NotifyAccessor::search(const QString &query, const QString &appName, int maxCount, qint64 cursor) const
+{
+    qDebug(notifyLog) << "Search entities for the app" << appName << ", cursor" << cursor;
+    auto ret = m_accessor->search(query, appName, maxCount, cursor);
+    return ret;
+}
+
 QStringList NotifyAccessor::fetchApps(int maxCount) const
 {
     qDebug(notifyLog) << "Fetch apps count" << maxCount;
@@ -141,6 +166,13 @@ QStringList NotifyAccessor::fetchApps(int maxCount) const
     return ret;
 }
 
+QList<AppSummary> NotifyAccessor::fetchAppSummaries(int topCount)
+{
+    qDebug(notifyLog) << "Fetch app summaries, top count" << topCount;
+    auto ret = m_accessor->fetchAppSummaries(NotifyEntity::Processed, topCount);
+    return ret;
+}
+
 void NotifyAccessor::removeEntity(qint64 id)
 {
     qDebug(notifyLog) << "Remove notify" << id;
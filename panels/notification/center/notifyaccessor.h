@@ -6,6 +6,7 @@
 
 #include <QObject>
 #include <QtQml/qqml.h>
+#include "dataaccessor.h"
 #include "notifyentity.h"
 
 class QQmlEngine;
@@ -47,10 +48,16 @@ public:
     Q_INVOKABLE void onNotificationStateChanged(qint64 id, int processedType);
 
     NotifyEntity fetchEntity(qint64 id) const;
+    // entity of a state change, it's only read from the store if the server isn't in this process.
+    NotifyEntity fetchReceivedEntity(qint64 id, int processedType) const;
     int fetchEntityCount(const QString &appName) const;
     NotifyEntity fetchLastEntity(const QString &appName) const;
     QList<NotifyEntity> fetchEntities(const QString &appName, int maxCount = -1);
+    QList<NotifyEntity> fetchEntities(const QString &appName, int maxCount, qint64 cursorTime, qint64 cursorId);
     QStringList fetchApps(int maxCount = -1) const;
+    QList<AppSummary> fetchAppSummaries(int topCount);
+    // it's called by NotifySearchModel out of the gui thread.
+    QList<NotifyEntity> search(const QString &query, const QString &appName, int maxCount, qint64 cursor) const;
     void removeEntity(qint64 id);
     void removeEntityByApp(const QString &appName);
     void clear();
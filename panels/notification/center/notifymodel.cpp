@@ -4,19 +4,25 @@
 
 #include "notifymodel.h"
 
-#include <QTimerEvent>
+#include <QDateTime>
 #include <QLoggingCategory>
 
+#include <limits>
+
 #include "notifyentity.h"
 #include "notifyitem.h"
 #include "notifyaccessor.h"
 #include "notifysetting.h"
+#include "notifytimeticker.h"
 
 namespace notification {
 Q_DECLARE_LOGGING_CATEGORY(notifyLog)
 }
 namespace notifycenter {
 
+// entities of an expanded app are loaded a screen at a time.
+static const int ExpandPageSize = 20;
+
 NotifyModel::NotifyModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_accessor(NotifyAccessor::instance())
@@ -24,6 +30,17 @@ NotifyModel::NotifyModel(QObject *parent)
     connect(m_accessor, &NotifyAccessor::entityReceived, this, &NotifyModel::doEntityReceived);
     connect(this, &NotifyModel::countChanged, this, &NotifyModel::onCountChanged);
     connect(NotifySetting::instance(), &NotifySetting::contentRowCountChanged, this, &NotifyModel::updateContentRowCount);
+    m_timeUpdated = QDateTime::currentMSecsSinceEpoch();
+    NotifyTimeTicker::instance()->attach(this, [this](qint64 current) {
+        return updateTime(current);
+    });
+    // rows are ticked from the time they're shown.
+    connect(this, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        scheduleTimeUpdate(first, last);
+    });
+    connect(this, &QAbstractItemModel::modelReset, this, [this] {
+        scheduleTimeUpdate(0, m_appNotifies.size() - 1);
+    });
 
     updateCollapseStatus();
 
@@ -59,7 +76,7 @@ void NotifyModel::expandApp(int row)
     endRemoveRows();
     notify->deleteLater();
 
-    auto entities = m_accessor->fetchEntities(appName);
+    auto entities = m_accessor->fetchEntities(appName, ExpandPageSize, 0, 0);
     if(entities.size() >= 2) {
         QList<AppNotifyItem *> notifies;
         for (auto entity: entities) {
@@ -81,6 +98,78 @@ void NotifyModel::expandApp(int row)
         }
         endInsertRows();
     }
+
+    m_groupCursors.remove(appName);
+    if (entities.size() >= ExpandPageSize) {
+        const auto &last = entities.last();
+        m_groupCursors.insert(appName, {last.cTime(), last.id()});
+    }
+}
+
+void NotifyModel::fetchMoreApp(const QString &appName, int indexInGroup)
+{
+    auto cursor = m_groupCursors.find(appName);
+    if (cursor == m_groupCursors.end())
+        return;
+
+    // only the last loaded notify of the group loads the next page.
+    const int loadedCount = notifyCount(appName, NotifyType::Normal);
+    if (indexInGroup >= 0 && indexInGroup + 1 < loadedCount)
+        return;
+
+    const auto groupRow = firstNotifyIndex(appName, NotifyType::Group);
+    if (groupRow < 0) {
+        m_groupCursors.erase(cursor);
+        return;
+    }
+
+    qDebug(notifyLog) << "Fetch more notifies for the app" << appName << ", from" << loadedCount;
+    const auto entities = m_accessor->fetchEntities(appName, ExpandPageSize, cursor->cTime, cursor->id);
+
+    // the page follows the loaded notifies of the group.
+    int start = groupRow + 1;
+    while (start < m_appNotifies.size() && m_appNotifies[start]->appName() == appName
+           && m_appNotifies[start]->type() == NotifyType::Normal) {
+        start++;
+    }
+
+    if (!entities.isEmpty()) {
+        beginInsertRows(QModelIndex(), start, start + entities.size() - 1);
+        for (int i = 0; i < entities.size(); i++) {
+            auto item = new AppNotifyItem(entities[i]);
+            item->setIndexInGroup(loadedCount + i);
+            m_appNotifies.insert(start + i, item);
+        }
+        endInsertRows();
+    }
+
+    if (entities.size() < ExpandPageSize) {
+        m_groupCursors.erase(cursor);
+    } else {
+        const auto &last = entities.last();
+        cursor->cTime = last.cTime();
+        cursor->id = last.id();
+    }
+}
+
+bool NotifyModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_groupCursors.isEmpty();
+}
+
+void NotifyModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+
+    // the view reaches the end, continue the topmost incomplete app.
+    for (const auto item : std::as_const(m_appNotifies)) {
+        if (item->type() == NotifyType::Group && m_groupCursors.contains(item->appName())) {
+            fetchMoreApp(item->appName(), -1);
+            return;
+        }
+    }
+    m_groupCursors.clear();
 }
 
 void NotifyModel::collapseApp(int row)
@@ -95,6 +184,7 @@ void NotifyModel::collapseApp(int row)
         return;
 
     const auto appName = notify->appName();
+    m_groupCursors.remove(appName);
 
     QList<AppNotifyItem *> notifies;
     for (int i = row; i < m_appNotifies.size(); i++) {
@@ -135,44 +225,26 @@ void NotifyModel::close()
 {
     qDebug(notifyLog) << "close";
 
+    m_groupCursors.clear();
     beginResetModel();
     qDeleteAll(m_appNotifies);
     m_appNotifies.clear();
     endResetModel();
+    // the center is hidden, nothing needs to be ticked.
+    NotifyTimeTicker::instance()->cancel(this);
 }
 
 void NotifyModel::open()
 {
     qDebug(notifyLog) << "Open";
 
-    auto apps = fetchLastApps();
-    for (auto appName : apps) {
-        const auto tmp = m_accessor->fetchEntities(appName, 3);
-        if (tmp.isEmpty())
-            continue;
-
-        const auto &entity = tmp.first();
-        Q_ASSERT(entity.isValid());
-
-        if (tmp.size() >= 2) {
-            // add overlap
-            qDebug(notifyLog) << "Add ovelay for the notify" << entity.id();
-
-            const int start = m_appNotifies.size();
-            auto overlap = new OverlapAppNotifyItem(entity);
-            overlap->updateCount(tmp.size());
-            beginInsertRows(QModelIndex(), start, start);
-            m_appNotifies.append(overlap);
-            endInsertRows();
-        } else {
-            // add normal
-            const int start = m_appNotifies.size();
-            beginInsertRows(QModelIndex(), start, start);
-            auto notify = new AppNotifyItem(entity);
-            m_appNotifies.append(notify);
-            endInsertRows();
-        }
+    // the overview is fetched in one query and applied in one reset.
+    const auto summaries = fetchLastAppSummaries();
+    beginResetModel();
+    for (const auto &summary : summaries) {
+        m_appNotifies.append(createAppItem(summary));
     }
+    endResetModel();
 }
 
 void NotifyModel::append(const NotifyEntity &entity)
@@ -262,6 +334,7 @@ void NotifyModel::append(const NotifyEntity &entity)
                 }
                 endMoveRows();
             }
+            updateIndexInGroup(appName);
         }
     } else {
         // add normal
@@ -271,48 +344,37 @@ void NotifyModel::append(const NotifyEntity &entity)
         m_appNotifies.insert(start, notify);
         endInsertRows();
     }
-
-    if (m_refreshTimer < 0) {
-        m_refreshTimer = startTimer(std::chrono::milliseconds(1000));
-    }
 }
 
-QList<QString> NotifyModel::fetchLastApps(int maxCount) const
+QList<AppSummary> NotifyModel::fetchLastAppSummaries() const
 {
-    qDebug(notifyLog) << "Fetch last apps count" << maxCount;
-    QStringList pinnedApps;
-    auto allApps = m_accessor->fetchApps(-1);
-    for (auto item : allApps) {
-        if (m_accessor->applicationPin(item)) {
-            pinnedApps << item;
-            if (maxCount >= 0 && pinnedApps.size() >= maxCount)
-                break;
-        }
-    }
-
-    QList<NotifyEntity> lastEntities;
-    for (auto item : allApps) {
-        const auto entity = m_accessor->fetchLastEntity(item);
-        if (!entity.isValid())
-            continue;
-        lastEntities << entity;
+    // an overlap shows at most 3 entities of the app.
+    auto summaries = m_accessor->fetchAppSummaries(3);
+    QHash<QString, bool> pins;
+    for (const auto &summary : std::as_const(summaries)) {
+        pins.insert(summary.appName, m_accessor->applicationPin(summary.appName));
     }
 
-    std::sort(lastEntities.begin(), lastEntities.end(), [this] (
-                                                            const NotifyEntity &item1,
-                                                            const NotifyEntity &item2) {
-        return greaterNotify(item1, item2);
+    // summaries are ordered by the last time, pinned apps are moved ahead of them.
+    std::stable_sort(summaries.begin(), summaries.end(), [&pins](const AppSummary &item1, const AppSummary &item2) {
+        return pins.value(item1.appName) && !pins.value(item2.appName);
     });
+    qDebug(notifyLog) << "Fetched last apps count" << summaries.size();
+    return summaries;
+}
 
-    QStringList ret;
-    for (int i = 0; i < lastEntities.size(); i++) {
-        const auto entity = lastEntities[i];
-        if (maxCount >= 0 && i >= maxCount)
-            break;
+AppNotifyItem *NotifyModel::createAppItem(const AppSummary &summary) const
+{
+    const auto &entity = summary.entities.first();
+    Q_ASSERT(entity.isValid());
 
-        ret << entity.appName();
+    if (summary.entities.size() >= 2) {
+        qDebug(notifyLog) << "Add ovelay for the notify" << entity.id();
+        auto overlap = new OverlapAppNotifyItem(entity);
+        overlap->updateCount(summary.entities.size());
+        return overlap;
     }
-    return ret;
+    return new AppNotifyItem(entity);
 }
 
 NotifyEntity NotifyModel::greaterNotifyEntity(const AppNotifyItem *notifyItem) const
@@ -385,6 +447,28 @@ void NotifyModel::trayUpdateGroupLastEntity(const QString &appName)
     }
 }
 
+// the notifies of a group are numbered by their rows, which are shifted by inserting and removing.
+void NotifyModel::updateIndexInGroup(const QString &appName)
+{
+    const auto groupRow = firstNotifyIndex(appName, NotifyType::Group);
+    if (groupRow < 0)
+        return;
+
+    for (int row = groupRow + 1; row < m_appNotifies.size(); row++) {
+        auto item = m_appNotifies[row];
+        if (item->appName() != appName || item->type() != NotifyType::Normal)
+            break;
+
+        const int indexInGroup = row - groupRow - 1;
+        if (item->indexInGroup() == indexInGroup)
+            continue;
+
+        item->setIndexInGroup(indexInGroup);
+        const auto index = this->index(row);
+        dataChanged(index, index, {NotifyIndexInGroup});
+    }
+}
+
 void NotifyModel::updateCollapseStatus()
 {
     auto iter = std::find_if(m_appNotifies.begin(), m_appNotifies.end(), [](const AppNotifyItem *item) {
@@ -458,6 +542,7 @@ void NotifyModel::remove(qint64 id)
             endRemoveRows();
 
             trayUpdateGroupLastEntity(appName);
+            updateIndexInGroup(appName);
 
         } else if (notify->type() == NotifyType::Overlap) {
             // overlap -> reduce overlap count && update || to normal
@@ -518,6 +603,11 @@ void NotifyModel::remove(qint64 id)
             }
         }
 
+        // the group isn't done while it has entities to load.
+        if (notifyCount(appName, NotifyType::Normal) <= 1) {
+            fetchMoreApp(appName, -1);
+        }
+
         int row = -1;
         for (int i = 0; i < m_appNotifies.size(); i++) {
             auto item = m_appNotifies[i];
@@ -580,12 +670,14 @@ void NotifyModel::removeByApp(const QString &appName)
         endRemoveRows();
 
     }
+    m_groupCursors.remove(appName);
     m_accessor->removeEntityByApp(appName);
     notify->deleteLater();
 }
 
 void NotifyModel::clear()
 {
+    m_groupCursors.clear();
     beginResetModel();
     qDeleteAll(m_appNotifies);
     m_appNotifies.clear();
@@ -609,35 +701,21 @@ void NotifyModel::expandAllApp()
         existApps << item->appName();
     }
 
-    const auto apps = fetchLastApps();
-    for (auto appName : std::as_const(apps)) {
-        if (existApps.contains(appName))
+    QList<AppNotifyItem *> items;
+    const auto summaries = fetchLastAppSummaries();
+    for (const auto &summary : summaries) {
+        if (existApps.contains(summary.appName))
             continue;
 
-        const auto tmp = m_accessor->fetchEntities(appName, 3);
-
-        auto entity = tmp.first();
-        Q_ASSERT(entity.isValid());
-
-        if (tmp.size() >= 2) {
-            // add overlap
-            qDebug(notifyLog) << "Add ovelay for the notify" << entity.id();
-
-            const int start = m_appNotifies.size();
-            auto overlap = new OverlapAppNotifyItem(entity);
-            overlap->updateCount(tmp.size());
-            beginInsertRows(QModelIndex(), start, start);
-            m_appNotifies.append(overlap);
-            endInsertRows();
-        } else {
-            // add normal
-            const int start = m_appNotifies.size();
-            beginInsertRows(QModelIndex(), start, start);
-            auto notify = new AppNotifyItem(entity);
-            m_appNotifies.append(notify);
-            endInsertRows();
-        }
+        items << createAppItem(summary);
     }
+    if (items.isEmpty())
+        return;
+
+    const int start = m_appNotifies.size();
+    beginInsertRows(QModelIndex(), start, start + items.size() - 1);
+    m_appNotifies.append(items);
+    endInsertRows();
 }
 
 void NotifyModel::invokeAction(qint64 id, const QString &actionId)
@@ -753,16 +831,32 @@ int NotifyModel::firstNotifyIndex(const QString &appName, const NotifyType &type
     return -1;
 }
 
-void NotifyModel::updateTime()
+qint64 NotifyModel::updateTime(qint64 current)
 {
-    if (m_appNotifies.isEmpty())
-        return;
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < m_appNotifies.size(); i++) {
+        auto item = m_appNotifies[i];
+        const auto cTime = item->entity().cTime();
+        // only the rows whose time changed since the last update are refreshed.
+        if (NotifyEntity::nextRelativeTimeChange(cTime, m_timeUpdated) <= current) {
+            item->updateTime();
+            const auto index = this->index(i, 0);
+            dataChanged(index, index, {NotifyTime});
+        }
+        deadline = std::min(deadline, NotifyEntity::nextRelativeTimeChange(cTime, current));
+    }
+    m_timeUpdated = current;
+    return deadline;
+}
 
-    QList<AppNotifyItem *> tmp = m_appNotifies;
-    for (auto item : tmp) {
-        item->updateTime();
+void NotifyModel::scheduleTimeUpdate(int first, int last)
+{
+    const auto current = QDateTime::currentMSecsSinceEpoch();
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (int i = first; i <= last && i < m_appNotifies.size(); i++) {
+        deadline = std::min(deadline, NotifyEntity::nextRelativeTimeChange(m_appNotifies[i]->entity().cTime(), current));
     }
-    dataChanged(index(0), index(rowCount(QModelIndex()) - 1), {NotifyTime});
+    NotifyTimeTicker::instance()->schedule(this, deadline);
 }
 
 QHash<int, QByteArray> NotifyModel::roleNames() const
@@ -789,7 +883,7 @@ QHash<int, QByteArray> NotifyModel::roleNames() const
 void NotifyModel::doEntityReceived(qint64 id)
 {
     qDebug(notifyLog) << "Receive entity" << id;
-    auto entity = m_accessor->fetchEntity(id);
+    auto entity = m_accessor->fetchReceivedEntity(id, NotifyEntity::Processed);
     if (!entity.isValid()) {
         qWarning(notifyLog) << "Received invalid entity:" << id << ", appName:" << entity.appName();
         return;
@@ -819,19 +913,6 @@ int NotifyModel::notifyCount(const QString &appName) const
     return count;
 }
 
-void NotifyModel::timerEvent(QTimerEvent *event)
-{
-    if (event->timerId() == m_refreshTimer) {
-        updateTime();
-
-        if (m_appNotifies.isEmpty()) {
-            killTimer(m_refreshTimer);
-            m_refreshTimer = -1;
-        }
-    }
-    return QAbstractListModel::timerEvent(event);
-}
-
 void NotifyModel::sort(int column, Qt::SortOrder order)
 {
     Q_UNUSED(column)
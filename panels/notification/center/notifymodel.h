@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -7,6 +7,7 @@
 #include <QAbstractItemModel>
 #include <QObject>
 #include <QtQml/qqml.h>
+#include "dataaccessor.h"
 #include "notifyitem.h"
 
 namespace notifycenter {
@@ -49,6 +50,8 @@ public:
     Q_INVOKABLE void clear();
     Q_INVOKABLE void collapseAllApp();
     Q_INVOKABLE void expandAllApp();
+    // loads the next page of the expanded app when the item at indexInGroup is its last loaded one.
+    Q_INVOKABLE void fetchMoreApp(const QString &appName, int indexInGroup);
 
     Q_INVOKABLE void open();
     Q_INVOKABLE void close();
@@ -70,8 +73,9 @@ public:
     virtual int rowCount(const QModelIndex &parent) const override;
     virtual QVariant data(const QModelIndex &index, int role) const override;
     virtual QHash<int, QByteArray> roleNames() const override;
-    virtual void timerEvent(QTimerEvent *event) override;
     virtual void sort(int column, Qt::SortOrder order) override;
+    virtual bool canFetchMore(const QModelIndex &parent) const override;
+    virtual void fetchMore(const QModelIndex &parent) override;
 
 private slots:
     void doEntityReceived(qint64 id);
@@ -83,9 +87,11 @@ private:
     int notifyCount(const QString &appName, const NotifyType &type) const;
     int firstNotifyIndex(const QString &appName, const NotifyType &type) const;
 
-    void updateTime();
+    qint64 updateTime(qint64 current);
+    void scheduleTimeUpdate(int first, int last);
     void append(const NotifyEntity &entity);
-    QList<QString> fetchLastApps(int maxCount = -1) const;
+    QList<AppSummary> fetchLastAppSummaries() const;
+    AppNotifyItem *createAppItem(const AppSummary &summary) const;
     NotifyEntity greaterNotifyEntity(const AppNotifyItem *notifyItem) const;
     bool greaterNotify(const AppNotifyItem *item1, const AppNotifyItem *item2) const;
     bool greaterNotify(const NotifyEntity &item1, const NotifyEntity &item2) const;
@@ -94,13 +100,23 @@ private:
     void sortNotifies();
     void trayUpdateGroupLastEntity(const NotifyEntity &entity);
     void trayUpdateGroupLastEntity(const QString &appName);
+    void updateIndexInGroup(const QString &appName);
     void updateCollapseStatus();
     void updateContentRowCount(int rowCount);
 
 private:
+    // position of an expanded app which has more entities to load.
+    struct GroupCursor
+    {
+        qint64 cTime = 0;
+        qint64 id = 0;
+    };
+
     QList<AppNotifyItem *> m_appNotifies;
+    QHash<QString, GroupCursor> m_groupCursors;
     QPointer<NotifyAccessor> m_accessor;
-    int m_refreshTimer = -1;
+    // the last time the time of the rows was updated.
+    qint64 m_timeUpdated = 0;
     bool m_collapse = false;
     int m_contentRowCount = 6;
 };
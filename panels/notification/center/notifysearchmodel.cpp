@@ -0,0 +1,264 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifysearchmodel.h"
+
+#include <QLoggingCategory>
+
+#include "dataaccessor.h"
+#include "notifyaccessor.h"
+#include "notifymodel.h"
+#include "notifysetting.h"
+
+namespace notification {
+Q_DECLARE_LOGGING_CATEGORY(notifyLog)
+}
+namespace notifycenter {
+
+static const int SearchPageSize = 50;
+
+NotifySearchModel::NotifySearchModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_accessor(NotifyAccessor::instance())
+    , m_appName(DataAccessor::AllApp())
+{
+    // queries are run one by one, a newer query makes the pending ones stale.
+    m_pool.setMaxThreadCount(1);
+}
+
+NotifySearchModel::~NotifySearchModel()
+{
+    ++m_generation;
+    m_pool.waitForDone();
+    qDeleteAll(m_notifies);
+}
+
+QString NotifySearchModel::query() const
+{
+    return m_query;
+}
+
+void NotifySearchModel::setQuery(const QString &query)
+{
+    if (m_query == query)
+        return;
+
+    m_query = query;
+    emit queryChanged();
+
+    reset();
+    search(0);
+}
+
+QString NotifySearchModel::appName() const
+{
+    return m_appName;
+}
+
+void NotifySearchModel::setAppName(const QString &appName)
+{
+    const auto name = appName.isEmpty() ? DataAccessor::AllApp() : appName;
+    if (m_appName == name)
+        return;
+
+    m_appName = name;
+    emit appNameChanged();
+
+    reset();
+    search(0);
+}
+
+bool NotifySearchModel::searching() const
+{
+    return m_searching;
+}
+
+void NotifySearchModel::setSearching(bool searching)
+{
+    if (m_searching == searching)
+        return;
+
+    m_searching = searching;
+    emit searchingChanged();
+}
+
+void NotifySearchModel::remove(qint64 id)
+{
+    for (int i = 0; i < m_notifies.size(); i++) {
+        auto notify = m_notifies[i];
+        if (notify->id() != id)
+            continue;
+
+        beginRemoveRows(QModelIndex(), i, i);
+        m_notifies.removeAt(i);
+        endRemoveRows();
+        notify->deleteLater();
+        break;
+    }
+
+    m_accessor->removeEntity(id);
+    emit removed(id);
+}
+
+void NotifySearchModel::invokeAction(qint64 id, const QString &actionId)
+{
+    qDebug(notifyLog) << "Invoke action for the searched notify" << id << actionId;
+    auto entity = m_accessor->fetchEntity(id);
+    if (!entity.isValid())
+        return;
+
+    m_accessor->invokeAction(entity, actionId);
+
+    remove(id);
+}
+
+void NotifySearchModel::reset()
+{
+    ++m_generation;
+    m_hasMore = false;
+
+    if (m_notifies.isEmpty())
+        return;
+
+    beginResetModel();
+    for (auto item : std::as_const(m_notifies)) {
+        item->deleteLater();
+    }
+    m_notifies.clear();
+    endResetModel();
+}
+
+void NotifySearchModel::search(qint64 cursor)
+{
+    if (!m_accessor || m_query.trimmed().isEmpty()) {
+        setSearching(false);
+        return;
+    }
+
+    setSearching(true);
+    const quint64 generation = m_generation;
+    const auto query = m_query;
+    const auto appName = m_appName;
+    QPointer<NotifyAccessor> accessor(m_accessor);
+    m_pool.start([this, accessor, generation, query, appName, cursor]() {
+        // skip the query if it's been replaced before it's started.
+        if (generation != m_generation || !accessor)
+            return;
+
+        const auto entities = accessor->search(query, appName, SearchPageSize, cursor);
+        // posted events of the model are removed when it's destroyed.
+        QMetaObject::invokeMethod(this, [this, generation, cursor, entities]() {
+            onSearchFinished(generation, cursor, entities);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void NotifySearchModel::onSearchFinished(quint64 generation, qint64 cursor, const QList<NotifyEntity> &entities)
+{
+    if (generation != m_generation)
+        return;
+
+    qDebug(notifyLog) << "Searched notifies" << entities.size() << ", cursor" << cursor;
+    setSearching(false);
+    m_hasMore = entities.size() >= SearchPageSize;
+    if (entities.isEmpty())
+        return;
+
+    const int first = m_notifies.size();
+    beginInsertRows(QModelIndex(), first, first + entities.size() - 1);
+    for (const auto &entity : entities) {
+        m_notifies.append(new AppNotifyItem(entity));
+    }
+    endInsertRows();
+}
+
+int NotifySearchModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return m_notifies.size();
+}
+
+QVariant NotifySearchModel::data(const QModelIndex &index, int role) const
+{
+    int row = index.row();
+    if (row < 0 || row >= m_notifies.size())
+        return QVariant();
+
+    auto notify = m_notifies[row];
+    switch (role) {
+    case NotifyModel::NotifyItemType:
+        return QLatin1String("normal");
+    case NotifyModel::NotifyId:
+        return notify->id();
+    case NotifyModel::NotifyAppId:
+        return notify->appId();
+    case NotifyModel::NotifyAppName:
+        return notify->appName();
+    case NotifyModel::NotifyIconName:
+        return notify->entity().appIconResolved();
+    case NotifyModel::NotifyTitle:
+        return notify->entity().summary();
+    case NotifyModel::NotifyContent:
+        return notify->entity().body();
+    case NotifyModel::NotifyActions:
+        return notify->actions();
+    case NotifyModel::NotifyDefaultAction:
+        return notify->defaultAction();
+    case NotifyModel::NotifyTime:
+        return notify->time();
+    case NotifyModel::NotifyPinned:
+        return notify->pinned();
+    case NotifyModel::NotifyStrongInteractive:
+        return notify->strongInteractive();
+    case NotifyModel::NotifyContentIcon:
+        return notify->contentIcon();
+    case NotifyModel::NotifyOverlapCount:
+        return 0;
+    case NotifyModel::NotifyContentRowCount:
+        return NotifySetting::instance()->contentRowCount();
+    case NotifyModel::NotifyIndexInGroup:
+        return -1;
+    default:
+        break;
+    }
+    return QVariant::fromValue(notify);
+}
+
+QHash<int, QByteArray> NotifySearchModel::roleNames() const
+{
+    static const QHash<int, QByteArray> roles{{NotifyModel::NotifyItemType, "type"},
+                                              {NotifyModel::NotifyId, "id"},
+                                              {NotifyModel::NotifyAppId, "appId"},
+                                              {NotifyModel::NotifyAppName, "appName"},
+                                              {NotifyModel::NotifyIconName, "iconName"},
+                                              {NotifyModel::NotifyActions, "actions"},
+                                              {NotifyModel::NotifyDefaultAction, "defaultAction"},
+                                              {NotifyModel::NotifyTime, "time"},
+                                              {NotifyModel::NotifyTitle, "title"},
+                                              {NotifyModel::NotifyContent, "content"},
+                                              {NotifyModel::NotifyPinned, "pinned"},
+                                              {NotifyModel::NotifyStrongInteractive, "strongInteractive"},
+                                              {NotifyModel::NotifyContentIcon, "contentIcon"},
+                                              {NotifyModel::NotifyOverlapCount, "overlapCount"},
+                                              {NotifyModel::NotifyContentRowCount, "contentRowCount"},
+                                              {NotifyModel::NotifyIndexInGroup, "indexInGroup"}};
+    return roles;
+}
+
+bool NotifySearchModel::canFetchMore(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return m_hasMore && !m_searching;
+}
+
+void NotifySearchModel::fetchMore(const QModelIndex &parent)
+{
+    Q_UNUSED(parent)
+    if (!canFetchMore(parent) || m_notifies.isEmpty())
+        return;
+
+    // the next page starts after the oldest loaded notify.
+    search(m_notifies.last()->entity().id());
+}
+}
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QObject>
+#include <QPointer>
+#include <QThreadPool>
+#include <QtQml/qqml.h>
+
+#include <atomic>
+
+#include "notifyitem.h"
+
+namespace notifycenter {
+class NotifyAccessor;
+/**
+ * @brief The NotifySearchModel class
+ * Results of the full-text search over the notification history, it has the same roles as NotifyModel.
+ * Queries run out of the gui thread and results are loaded page by page.
+ */
+using namespace notification;
+class NotifySearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged FINAL)
+    Q_PROPERTY(QString appName READ appName WRITE setAppName NOTIFY appNameChanged FINAL)
+    Q_PROPERTY(bool searching READ searching NOTIFY searchingChanged FINAL)
+public:
+    NotifySearchModel(QObject *parent = nullptr);
+    ~NotifySearchModel() override;
+
+    QString query() const;
+    void setQuery(const QString &query);
+    QString appName() const;
+    void setAppName(const QString &appName);
+    bool searching() const;
+
+    Q_INVOKABLE void remove(qint64 id);
+    Q_INVOKABLE void invokeAction(qint64 id, const QString &actionId);
+
+signals:
+    void queryChanged();
+    void appNameChanged();
+    void searchingChanged();
+    // the notify is removed from the history, views of the history which aren't shown are stale.
+    void removed(qint64 id);
+
+public:
+    virtual int rowCount(const QModelIndex &parent) const override;
+    virtual QVariant data(const QModelIndex &index, int role) const override;
+    virtual QHash<int, QByteArray> roleNames() const override;
+    virtual bool canFetchMore(const QModelIndex &parent) const override;
+    virtual void fetchMore(const QModelIndex &parent) override;
+
+private:
+    void search(qint64 cursor);
+    void onSearchFinished(quint64 generation, qint64 cursor, const QList<NotifyEntity> &entities);
+    void reset();
+    void setSearching(bool searching);
+
+private:
+    QList<AppNotifyItem *> m_notifies;
+    QPointer<NotifyAccessor> m_accessor;
+    QString m_query;
+    QString m_appName;
+    // results of earlier queries are dropped when they arrive.
+    std::atomic<quint64> m_generation = 0;
+    bool m_searching = false;
+    bool m_hasMore = false;
+    QThreadPool m_pool;
+};
+}
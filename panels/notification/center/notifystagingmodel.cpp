@@ -4,14 +4,17 @@
 
 #include "notifystagingmodel.h"
 
-#include <QTimerEvent>
+#include <QDateTime>
 #include <QLoggingCategory>
 
+#include <limits>
+
 #include "dataaccessorproxy.h"
 #include "notifyaccessor.h"
 #include "notifyentity.h"
 #include "notifyitem.h"
 #include "notifysetting.h"
+#include "notifytimeticker.h"
 
 namespace notification {
 Q_DECLARE_LOGGING_CATEGORY(notifyLog)
@@ -25,6 +28,17 @@ NotifyStagingModel::NotifyStagingModel(QObject *parent)
     connect(NotifyAccessor::instance(), &NotifyAccessor::stagingEntityReceived, this, &NotifyStagingModel::doEntityReceived);
     connect(NotifyAccessor::instance(), &NotifyAccessor::stagingEntityClosed, this, &NotifyStagingModel::onEntityClosed);
     connect(NotifySetting::instance(), &NotifySetting::contentRowCountChanged, this, &NotifyStagingModel::updateContentRowCount);
+    m_timeUpdated = QDateTime::currentMSecsSinceEpoch();
+    NotifyTimeTicker::instance()->attach(this, [this](qint64 current) {
+        return updateTime(current);
+    });
+    // rows are ticked from the time they're shown.
+    connect(this, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        scheduleTimeUpdate(first, last);
+    });
+    connect(this, &QAbstractItemModel::modelReset, this, [this] {
+        scheduleTimeUpdate(0, m_appNotifies.size() - 1);
+    });
 }
 
 void NotifyStagingModel::close()
@@ -35,6 +49,8 @@ void NotifyStagingModel::close()
     qDeleteAll(m_appNotifies);
     m_appNotifies.clear();
     endResetModel();
+    // the staging is hidden, nothing needs to be ticked.
+    NotifyTimeTicker::instance()->cancel(this);
 }
 
 void NotifyStagingModel::push(const NotifyEntity &entity)
@@ -62,10 +78,6 @@ void NotifyStagingModel::push(const NotifyEntity &entity)
         auto count = m_accessor->fetchEntityCount(DataAccessor::AllApp(), NotifyEntity::NotProcessed);
         updateOverlapCount(count);
     }
-
-    if (m_refreshTimer < 0) {
-        m_refreshTimer = startTimer(std::chrono::milliseconds(1000));
-    }
 }
 
 void NotifyStagingModel::closeNotify(qint64 id, int reason)
@@ -224,16 +236,32 @@ QVariant NotifyStagingModel::data(const QModelIndex &index, int role) const
     return QVariant::fromValue(notify);
 }
 
-void NotifyStagingModel::updateTime()
+qint64 NotifyStagingModel::updateTime(qint64 current)
 {
-    if (m_appNotifies.isEmpty())
-        return;
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < m_appNotifies.size(); i++) {
+        auto item = m_appNotifies[i];
+        const auto cTime = item->entity().cTime();
+        // only the rows whose time changed since the last update are refreshed.
+        if (NotifyEntity::nextRelativeTimeChange(cTime, m_timeUpdated) <= current) {
+            item->updateTime();
+            const auto index = this->index(i, 0);
+            dataChanged(index, index, {NotifyTime});
+        }
+        deadline = std::min(deadline, NotifyEntity::nextRelativeTimeChange(cTime, current));
+    }
+    m_timeUpdated = current;
+    return deadline;
+}
 
-    QList<AppNotifyItem *> tmp = m_appNotifies;
-    for (auto item : tmp) {
-        item->updateTime();
+void NotifyStagingModel::scheduleTimeUpdate(int first, int last)
+{
+    const auto current = QDateTime::currentMSecsSinceEpoch();
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (int i = first; i <= last && i < m_appNotifies.size(); i++) {
+        deadline = std::min(deadline, NotifyEntity::nextRelativeTimeChange(m_appNotifies[i]->entity().cTime(), current));
     }
-    dataChanged(index(0), index(rowCount(QModelIndex()) - 1), {NotifyTime});
+    NotifyTimeTicker::instance()->schedule(this, deadline);
 }
 
 NotifyEntity NotifyStagingModel::notifyById(qint64 id) const
@@ -278,19 +306,6 @@ QHash<int, QByteArray> NotifyStagingModel::roleNames() const
     return roles;
 }
 
-void NotifyStagingModel::timerEvent(QTimerEvent *event)
-{
-    if (event->timerId() == m_refreshTimer) {
-        updateTime();
-
-        if (m_appNotifies.isEmpty()) {
-            killTimer(m_refreshTimer);
-            m_refreshTimer = -1;
-        }
-    }
-    return QAbstractListModel::timerEvent(event);
-}
-
 int NotifyStagingModel::overlapCount() const
 {
     return m_overlapCount;
@@ -299,7 +314,7 @@ int NotifyStagingModel::overlapCount() const
 void NotifyStagingModel::doEntityReceived(qint64 id)
 {
     qDebug(notifyLog) << "Receive entity" << id;
-    auto entity = m_accessor->fetchEntity(id);
+    auto entity = NotifyAccessor::instance()->fetchReceivedEntity(id, NotifyEntity::NotProcessed);
     if (!entity.isValid()) {
         qWarning(notifyLog) << "Received invalid entity:" << id << ", appName:" << entity.appName();
         return;
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -48,7 +48,6 @@ public:
     virtual int rowCount(const QModelIndex &parent) const override;
     virtual QVariant data(const QModelIndex &index, int role) const override;
     virtual QHash<int, QByteArray> roleNames() const override;
-    virtual void timerEvent(QTimerEvent *event) override;
 
     int overlapCount() const;
     void updateOverlapCount(int count);
@@ -62,14 +61,16 @@ private slots:
 
 private:
     void remove(qint64 id);
-    void updateTime();
+    qint64 updateTime(qint64 current);
+    void scheduleTimeUpdate(int first, int last);
     NotifyEntity notifyById(qint64 id) const;
 
 private:
     QList<AppNotifyItem *> m_appNotifies;
     const int BubbleMaxCount{3};
     const int OverlayMaxCount{2};
-    int m_refreshTimer = -1;
+    // the last time the time of the rows was updated.
+    qint64 m_timeUpdated = 0;
     DataAccessor *m_accessor = nullptr;
     int m_overlapCount = 0;
     int m_contentRowCount = 6;
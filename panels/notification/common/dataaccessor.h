@@ -1,16 +1,46 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include <QHash>
 #include <QList>
 #include <QString>
 
+#include <algorithm>
+#include <functional>
+
 #include "notifyentity.h"
 
 namespace notification {
 
+// bounds of the stored history, a bound of 0 is unlimited.
+struct RetentionPolicy
+{
+    int maxCount = 0;
+    qint64 maxBytes = 0;
+    qint64 maxAgeMSecs = 0;
+};
+
+// count of the stored entities of an app in a processed type.
+struct EntityCount
+{
+    QString appName;
+    int processedType = 0;
+    int count = 0;
+};
+
+// notifications of an app in the overview of the notification center.
+struct AppSummary
+{
+    QString appName;
+    int count = 0;
+    qint64 lastCTime = 0;
+    // the newest entities of the app, ordered by (CTime, ID) descending.
+    QList<NotifyEntity> entities;
+};
+
 class DataAccessor
 {
 public:
@@ -33,6 +63,8 @@ public:
 
     virtual NotifyEntity fetchEntity(qint64 id) { Q_UNUSED(id); return {}; }
     virtual int fetchEntityCount(const QString &appName, int processedType) const { Q_UNUSED(appName); Q_UNUSED(processedType); return 0; }
+    // entity count of every app for the processedType, it's used to reconcile cached counters.
+    virtual QHash<QString, int> fetchEntityCounts(int processedType) const { Q_UNUSED(processedType); return {}; }
     virtual NotifyEntity fetchLastEntity(const QString &appName, int processedType) { Q_UNUSED(appName); Q_UNUSED(processedType); return {}; }
     virtual NotifyEntity fetchLastEntity(uint notifyId)
     {
@@ -46,7 +78,48 @@ public:
         Q_UNUSED(maxCount)
         return {};
     }
+    // entities ordered by (CTime, ID) descending which are older than the cursor,
+    // the cursor is the last entity of the previous page, it's (0, 0) for the first page.
+    virtual QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId)
+    {
+        Q_UNUSED(appName)
+        Q_UNUSED(processedType);
+        Q_UNUSED(maxCount)
+        Q_UNUSED(cursorTime)
+        Q_UNUSED(cursorId)
+        return {};
+    }
     virtual QList<QString> fetchApps(int maxCount) const { Q_UNUSED(maxCount); return {}; }
+    // summaries of the apps ordered by their last time descending, accessors may fetch them in one query.
+    virtual QList<AppSummary> fetchAppSummaries(int processedType, int topCount)
+    {
+        QList<AppSummary> ret;
+        const auto counts = fetchEntityCounts(processedType);
+        for (auto iter = counts.cbegin(); iter != counts.cend(); ++iter) {
+            AppSummary summary;
+            summary.appName = iter.key();
+            summary.count = iter.value();
+            summary.entities = fetchEntities(iter.key(), processedType, topCount);
+            if (summary.entities.isEmpty())
+                continue;
+            summary.lastCTime = summary.entities.first().cTime();
+            ret << summary;
+        }
+        std::sort(ret.begin(), ret.end(), [](const AppSummary &left, const AppSummary &right) {
+            return left.lastCTime > right.lastCTime;
+        });
+        return ret;
+    }
+    // processed entities matching all words of the query, newest first,
+    // cursor is the id of the last entity of the previous page, it's 0 for the first page.
+    virtual QList<NotifyEntity> search(const QString &query, const QString &appName, int maxCount, qint64 cursor)
+    {
+        Q_UNUSED(query)
+        Q_UNUSED(appName)
+        Q_UNUSED(maxCount)
+        Q_UNUSED(cursor)
+        return {};
+    }
 
     virtual void removeEntity(qint64 id) { Q_UNUSED(id); }
     virtual void removeEntityByApp(const QString &appName) { Q_UNUSED(appName); }
@@ -55,6 +128,14 @@ public:
         Q_UNUSED(expiredTime);
     }
     virtual void clear() {}
+
+    virtual void setRetentionPolicy(const RetentionPolicy &policy) { Q_UNUSED(policy); }
+    // trims the history by the retention policy and reclaims the space, it runs in the background.
+    // idle is true if the session is idle or locked, blocking steps like rebuilding the database only run then.
+    virtual void compact(bool idle) { Q_UNUSED(idle); }
+    // the handler is called with the counts of the entities the accessor removed by itself, i.e. by compact()
+    // and removeEntitiesByExpiredTime(), once they're removed, it may be called out of the caller's thread.
+    virtual void setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler) { Q_UNUSED(handler); }
     inline static QString AllApp()
     {
         return QLatin1String("AllApp");
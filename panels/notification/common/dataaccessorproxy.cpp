@@ -41,6 +41,21 @@ void DataAccessorProxy::setSource(DataAccessor *source)
         delete m_source;
     }
     m_source = source;
+    // entities removed by the source itself are reported by the counts, the counters drop them.
+    m_source->setRemovedHandler([this](const QList<EntityCount> &counts) {
+        std::function<void(const QList<EntityCount> &)> handler;
+        {
+            QMutexLocker locker(&m_countMutex);
+            for (const auto &item : counts) {
+                updateCount(item.appName, item.processedType, -item.count);
+            }
+            handler = m_removedHandler;
+        }
+        if (handler)
+            handler(counts);
+    });
+
+    reconcileCounts();
 }
 
 qint64 DataAccessorProxy::addEntity(const NotifyEntity &entity)
@@ -49,7 +64,12 @@ qint64 DataAccessorProxy::addEntity(const NotifyEntity &entity)
         return m_impl->addEntity(entity);
     } else {
         if (!filterToSource(entity)) {
-            return m_source->addEntity(entity);
+            const auto sId = m_source->addEntity(entity);
+            if (sId > 0) {
+                QMutexLocker locker(&m_countMutex);
+                updateCount(entity.appName(), entity.processedType(), 1);
+            }
+            return sId;
         }
     }
     return -1;
@@ -60,7 +80,15 @@ qint64 DataAccessorProxy::replaceEntity(qint64 id, const NotifyEntity &entity)
     if (entity.processedType() == NotifyEntity::NotProcessed) {
         return m_impl->replaceEntity(id, entity);
     } else {
-        return m_source->replaceEntity(id, entity);
+        // a point read by the primary key, it sees the writes which aren't committed yet.
+        const auto old = m_source->fetchEntity(id);
+        const auto sId = m_source->replaceEntity(id, entity);
+        QMutexLocker locker(&m_countMutex);
+        if (sId > 0 && old.isValid()) {
+            updateCount(old.appName(), old.processedType(), -1);
+            updateCount(entity.appName(), entity.processedType(), 1);
+        }
+        return sId;
     }
 }
 
@@ -74,12 +102,20 @@ void DataAccessorProxy::updateEntityProcessedType(qint64 id, int processedType)
             if (sId > 0) {
                 m_impl->removeEntity(id);
                 entity.setId(sId);
+                QMutexLocker locker(&m_countMutex);
+                updateCount(entity.appName(), entity.processedType(), 1);
             }
         } else {
             m_impl->removeEntity(id);
         }
     } else {
-        return m_source->updateEntityProcessedType(id, processedType);
+        const auto old = m_source->fetchEntity(id);
+        m_source->updateEntityProcessedType(id, processedType);
+        QMutexLocker locker(&m_countMutex);
+        if (old.isValid()) {
+            updateCount(old.appName(), old.processedType(), -1);
+            updateCount(old.appName(), processedType, 1);
+        }
     }
 }
 
@@ -94,6 +130,13 @@ NotifyEntity DataAccessorProxy::fetchEntity(qint64 id)
 
 int DataAccessorProxy::fetchEntityCount(const QString &appName, int processedType) const
 {
+    if (processedType == NotifyEntity::Processed) {
+        QMutexLocker locker(&m_countMutex);
+        if (appName == DataAccessor::AllApp())
+            return m_processedCount;
+        return m_processedCounts.value(appName);
+    }
+
     if (processedType == NotifyEntity::NotProcessed) {
         return m_impl->fetchEntityCount(appName, processedType);
     } else {
@@ -127,33 +170,112 @@ QList<NotifyEntity> DataAccessorProxy::fetchEntities(const QString &appName, int
     return m_source->fetchEntities(appName, processedType, maxCount);
 }
 
+QList<NotifyEntity> DataAccessorProxy::fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId)
+{
+    if (processedType == NotifyEntity::NotProcessed) {
+        return m_impl->fetchEntities(appName, processedType, maxCount, cursorTime, cursorId);
+    }
+
+    return m_source->fetchEntities(appName, processedType, maxCount, cursorTime, cursorId);
+}
+
 QList<QString> DataAccessorProxy::fetchApps(int maxCount) const
 {
     return m_source->fetchApps(maxCount);
 }
 
+QList<AppSummary> DataAccessorProxy::fetchAppSummaries(int processedType, int topCount)
+{
+    if (processedType == NotifyEntity::NotProcessed) {
+        return m_impl->fetchAppSummaries(processedType, topCount);
+    }
+
+    return m_source->fetchAppSummaries(processedType, topCount);
+}
+
+QList<NotifyEntity> DataAccessorProxy::search(const QString &query, const QString &appName, int maxCount, qint64 cursor)
+{
+    return m_source->search(query, appName, maxCount, cursor);
+}
+
 void DataAccessorProxy::removeEntity(qint64 id)
 {
     if (m_impl->fetchEntity(id).isValid()) {
         m_impl->removeEntity(id);
     } else {
+        const auto old = m_source->fetchEntity(id);
         m_source->removeEntity(id);
+        QMutexLocker locker(&m_countMutex);
+        if (old.isValid()) {
+            updateCount(old.appName(), old.processedType(), -1);
+        }
     }
 }
 
 void DataAccessorProxy::removeEntityByApp(const QString &appName)
 {
     m_source->removeEntityByApp(appName);
+
+    QMutexLocker locker(&m_countMutex);
+    m_processedCount -= m_processedCounts.take(appName);
 }
 
 void DataAccessorProxy::removeEntitiesByExpiredTime(qint64 expiredTime)
 {
+    // the source reports the counts of the expired entities once they're removed.
     m_source->removeEntitiesByExpiredTime(expiredTime);
 }
 
 void DataAccessorProxy::clear()
 {
     m_source->clear();
+
+    QMutexLocker locker(&m_countMutex);
+    m_processedCounts.clear();
+    m_processedCount = 0;
+}
+
+void DataAccessorProxy::setRetentionPolicy(const RetentionPolicy &policy)
+{
+    m_source->setRetentionPolicy(policy);
+}
+
+void DataAccessorProxy::compact(bool idle)
+{
+    m_source->compact(idle);
+}
+
+void DataAccessorProxy::setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler)
+{
+    QMutexLocker locker(&m_countMutex);
+    m_removedHandler = handler;
+}
+
+// it's called once the source is set, later mutations update the counters by the deltas.
+void DataAccessorProxy::reconcileCounts()
+{
+    const auto counts = m_source->fetchEntityCounts(NotifyEntity::Processed);
+
+    QMutexLocker locker(&m_countMutex);
+    m_processedCounts.clear();
+    m_processedCount = 0;
+    for (auto iter = counts.cbegin(); iter != counts.cend(); ++iter) {
+        updateCount(iter.key(), NotifyEntity::Processed, iter.value());
+    }
+}
+
+// m_countMutex must be held by the caller.
+void DataAccessorProxy::updateCount(const QString &appName, int processedType, int delta)
+{
+    if (processedType != NotifyEntity::Processed)
+        return;
+
+    auto &count = m_processedCounts[appName];
+    count = qMax(0, count + delta);
+    if (count == 0) {
+        m_processedCounts.remove(appName);
+    }
+    m_processedCount = qMax(0, m_processedCount + delta);
 }
 
 bool DataAccessorProxy::routerToSource(qint64 id, int processedType) const
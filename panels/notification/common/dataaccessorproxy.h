@@ -1,9 +1,10 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include <QHash>
 #include <QList>
 #include <QMutex>
 #include <QString>
@@ -32,20 +33,37 @@ public:
     virtual NotifyEntity fetchLastEntity(const QString &appName, int processedType) override;
     virtual NotifyEntity fetchLastEntity(uint notifyId) override;
     virtual QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount) override;
+    virtual QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId) override;
     virtual QList<QString> fetchApps(int maxCount) const override;
+    virtual QList<AppSummary> fetchAppSummaries(int processedType, int topCount) override;
+    virtual QList<NotifyEntity> search(const QString &query, const QString &appName, int maxCount, qint64 cursor) override;
 
     virtual void removeEntity(qint64 id) override;
     virtual void removeEntityByApp(const QString &appName) override;
     virtual void removeEntitiesByExpiredTime(qint64 expiredTime) override;
     virtual void clear() override;
 
+    virtual void setRetentionPolicy(const RetentionPolicy &policy) override;
+    virtual void compact(bool idle) override;
+    virtual void setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler) override;
+
 private:
     bool routerToSource(qint64 id, int processedType) const;
     bool filterToSource(const NotifyEntity &entity) const;
 
+    void reconcileCounts();
+    void updateCount(const QString &appName, int processedType, int delta);
+
 private:
     DataAccessor *m_source = nullptr;
     DataAccessor *m_impl = nullptr;
+
+    // processed entities of the source, updated on each mutation instead of counting in the source,
+    // they're loaded once by the grouped counts, a mutation reads at most the entity it changes.
+    mutable QMutex m_countMutex;
+    QHash<QString, int> m_processedCounts;
+    int m_processedCount = 0;
+    std::function<void(const QList<EntityCount> &)> m_removedHandler;
 };
 
 }
@@ -4,17 +4,25 @@
 
 #include "dbaccessor.h"
 #include "notifyentity.h"
+#include "notifyimagestore.h"
 
 #include <QCoreApplication>
+#include <QDeadlineTimer>
 #include <QDir>
 #include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+#include <limits>
 
 namespace notification {
 Q_DECLARE_LOGGING_CATEGORY(notifyLog)
@@ -24,6 +32,12 @@ Q_LOGGING_CATEGORY(notifyDBLog, "org.deepin.dde.shell.notification.db", QtMsgTyp
 
 static const QString TableName = "notifications";
 static const QString TableName_v2 = "notifications2";
+static const QString TableName_v3 = "notifications3";
+// full-text index of notifications3, it's an external content table kept in sync by triggers.
+static const QString SearchTableName = "notifications3_fts";
+// reads go through this view while rows are still being migrated from notifications2.
+static const QString MigrationViewName = "notifications_migrating";
+static const int SchemaVersion = 3;
 static const QString ColumnId = "ID";
 static const QString ColumnIcon = "Icon";
 static const QString ColumnSummary = "Summary";
@@ -38,6 +52,18 @@ static const QString ColumnNotifyId = "NotifyId";
 static const QString ColumnReplacesId = "ReplacesId";
 static const QString ColumnTimeout = "Timeout";
 
+// queued writes are committed once the batch is full or the oldest one waited this long.
+static const int WriteBatchSize = 64;
+static const int WriteFlushIntervalMSecs = 200;
+// legacy rows are moved to the new schema in slices when the storage thread is idle.
+static const int MigrationSliceSize = 1000;
+static const int MigrationIntervalMSecs = 50;
+// compaction removes the oldest rows out of the retention policy and then reclaims free pages, in slices.
+static const int RetentionSliceSize = 500;
+static const int VacuumSlicePages = 256;
+// the trigram tokenizer matches substrings of at least this length.
+static const int TrigramLength = 3;
+
 static const QStringList EntityFields {
     ColumnId,
     ColumnIcon,
@@ -109,6 +135,72 @@ private:
 #define BENCHMARK() \
     Benchmark __benchmark__(__FUNCTION__);
 
+// adds the count to the entry of the app and the processed type.
+static void addEntityCount(QList<EntityCount> &counts, const QString &appName, int processedType, int count)
+{
+    for (auto &item : counts) {
+        if (item.appName == appName && item.processedType == processedType) {
+            item.count += count;
+            return;
+        }
+    }
+    counts << EntityCount{appName, processedType, count};
+}
+
+// resets a cached statement when leaving the scope, so it doesn't keep the read transaction open.
+class StatementReset
+{
+public:
+    explicit StatementReset(QSqlQuery &query)
+        : m_query(query)
+    {
+    }
+    ~StatementReset()
+    {
+        m_query.finish();
+    }
+private:
+    QSqlQuery &m_query;
+};
+
+// a read runs on the read only connection of the calling thread, it sees the last committed snapshot
+// and never waits for the writer, neither for m_mutex.
+class DBAccessor::ReadScope
+{
+public:
+    explicit ReadScope(const DBAccessor *accessor)
+        : m_accessor(accessor)
+        , m_reader(accessor->readerConnection())
+    {
+    }
+
+    QSqlQuery &statement(Statement id) const
+    {
+        // legacy rows are read through the temporary view of the connection while migrating.
+        const auto &table = m_reader->migrating ? MigrationViewName : TableName_v3;
+        return m_accessor->cachedStatement(m_reader->statements[id], m_reader->connection, id, table);
+    }
+
+    QSqlDatabase connection() const
+    {
+        return m_reader->connection;
+    }
+
+private:
+    const DBAccessor *m_accessor = nullptr;
+    ReaderConnection *m_reader = nullptr;
+};
+
+DBAccessor::ReaderConnection::~ReaderConnection()
+{
+    // called on exiting the thread, the connection must be released before it's removed.
+    const auto name = connection.connectionName();
+    statements.clear();
+    connection.close();
+    connection = QSqlDatabase();
+    QSqlDatabase::removeDatabase(name);
+}
+
 DBAccessor::DBAccessor(const QString &key)
     : m_key(key)
 {
@@ -136,12 +228,22 @@ DBAccessor::DBAccessor(const QString &key)
 
         if (dbOpened) {
             tryToCreateTable();
+            m_lastRowId = lastRowId();
+            startWriter();
         }
     }
 }
 
 DBAccessor::~DBAccessor()
 {
+    QObject::disconnect(m_quitConnection);
+    stopWriter();
+    sync();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        clearStatements();
+    }
     if (m_connection.isOpen()) {
         m_connection.close();
     }
@@ -158,7 +260,8 @@ DBAccessor *DBAccessor::instance()
 
 bool DBAccessor::open(const QString &dataPath)
 {
-    m_connection = QSqlDatabase::addDatabase("QSQLITE", "QSQLITE" + m_key);
+    m_connectionName = "QSQLITE" + m_key;
+    m_connection = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
     m_connection.setDatabaseName(dataPath);
     qDebug(notifyLog) << "Open database path" << dataPath;
 
@@ -190,6 +293,11 @@ bool DBAccessor::open(const QString &dataPath)
         qWarning(notifyLog) << "Failed to optimize:" << query.lastError().text();
     }
 
+    // Truncate the WAL file to this size after checkpoints, so it doesn't keep its peak size
+    if (!query.exec("PRAGMA journal_size_limit=4194304")) {
+        qWarning(notifyLog) << "Failed to set journal_size_limit:" << query.lastError().text();
+    }
+
     // Enable read_uncommitted for better concurrency with WAL
     if (!query.exec("PRAGMA read_uncommitted=0")) {
         qWarning(notifyLog) << "Failed to set read_uncommitted:" << query.lastError().text();
@@ -210,127 +318,57 @@ bool DBAccessor::isValid() const
 
 qint64 DBAccessor::addEntity(const NotifyEntity &entity)
 {
-    BENCHMARK();
-
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-
-    QString columns = QStringList{
-            ColumnIcon,
-            ColumnSummary,
-            ColumnBody,
-            ColumnAppName,
-            ColumnAppId,
-            ColumnCTime,
-            ColumnAction,
-            ColumnHint,
-            ColumnReplacesId,
-            ColumnNotifyId,
-            ColumnProcessedType
-    }.join(", ");
-
-    QString sqlCmd = QString("INSERT INTO %1 (%2) VALUES (%3)")
-            .arg(TableName_v2)
-            .arg(columns)
-            .arg(":icon, :summary, :body, :appName, :appId, :ctime, :action, :hint, :replacesId, :notifyId, :processedType");
-
-    query.prepare(sqlCmd);
-    query.bindValue(":icon", entity.appIcon());
-    query.bindValue(":summary", entity.summary());
-    query.bindValue(":body", entity.body());
-    query.bindValue(":appName", entity.appName());
-    query.bindValue(":appId", entity.appId());
-    query.bindValue(":ctime", entity.cTime());
-    query.bindValue(":action", entity.actionsString());
-    query.bindValue(":hint", entity.hintsString());
-    query.bindValue(":replacesId", entity.replacesId());
-    query.bindValue(":notifyId", entity.bubbleId());
-    query.bindValue(":processedType", entity.processedType());
-
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "insert value to database failed: " << query.lastError().text() << query.lastQuery() << entity.bubbleId() << entity.cTime();
+    if (!m_writer)
         return -1;
-    }
 
-    // to get entity's id in database
-    qint64 storageId = query.lastInsertId().toLongLong();
+    PendingWrite write;
+    write.type = InsertWrite;
+    write.entity = entityValues(entity);
+    {
+        // row id is allocated here, so the caller doesn't wait for the insert.
+        QMutexLocker locker(&m_queueMutex);
+        write.id = ++m_lastRowId;
+    }
+    const auto storageId = write.id;
+    enqueueWrite(std::move(write));
 
-    qDebug(notifyDBLog) << "Insert entity bubbleId:" << entity.bubbleId() << ", id:" << storageId;
+    qDebug(notifyDBLog) << "Queue entity bubbleId:" << entity.bubbleId() << ", id:" << storageId;
 
     return storageId;
 }
 
 qint64 DBAccessor::replaceEntity(qint64 id, const NotifyEntity &entity)
 {
-    BENCHMARK();
-
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-
-    QString columns = QStringList{QString("%1 = :icon").arg(ColumnIcon),
-                                  QString("%1 = :summary").arg(ColumnSummary),
-                                  QString("%1 = :body").arg(ColumnBody),
-                                  QString("%1 = :appName").arg(ColumnAppName),
-                                  QString("%1 = :appId").arg(ColumnAppId),
-                                  QString("%1 = :ctime").arg(ColumnCTime),
-                                  QString("%1 = :action").arg(ColumnAction),
-                                  QString("%1 = :hint").arg(ColumnHint),
-                                  QString("%1 = :replacesId").arg(ColumnReplacesId),
-                                  QString("%1 = :notifyId").arg(ColumnNotifyId),
-                                  QString("%1 = :processedType").arg(ColumnProcessedType)}
-                          .join(", ");
-
-    QString sqlCmd = QString("UPDATE %1 SET %2 WHERE ID = :id").arg(TableName_v2).arg(columns);
-
-    query.prepare(sqlCmd);
-    query.bindValue(":icon", entity.appIcon());
-    query.bindValue(":summary", entity.summary());
-    query.bindValue(":body", entity.body());
-    query.bindValue(":appName", entity.appName());
-    query.bindValue(":appId", entity.appId());
-    query.bindValue(":ctime", entity.cTime());
-    query.bindValue(":action", entity.actionsString());
-    query.bindValue(":hint", entity.hintsString());
-    query.bindValue(":replacesId", entity.replacesId());
-    query.bindValue(":notifyId", entity.bubbleId());
-    query.bindValue(":processedType", entity.processedType());
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "Update value to database failed: " << query.lastError().text() << query.lastQuery() << entity.bubbleId() << entity.cTime();
+    if (!m_writer)
         return -1;
-    }
 
-    qDebug(notifyDBLog) << "Update entity bubbleId:" << entity.bubbleId() << ", id:" << id << ", affected rows:" << query.numRowsAffected();
+    PendingWrite write;
+    write.type = ReplaceWrite;
+    write.id = id;
+    write.entity = entityValues(entity);
+    enqueueWrite(std::move(write));
 
     return id;
 }
 
 void DBAccessor::updateEntityProcessedType(qint64 id, int processedType)
 {
-    BENCHMARK();
-
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-
-    QString cmd = QString("UPDATE %1 SET ProcessedType = :processed WHERE ID = :id").arg(TableName_v2);
-    query.prepare(cmd);
-    query.bindValue(":id", id);
-    query.bindValue(":processed", processedType);
-
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "update processed type execution error:" << query.lastError().text();
-    }
+    PendingWrite write;
+    write.type = ProcessedTypeWrite;
+    write.id = id;
+    write.processedType = processedType;
+    enqueueWrite(std::move(write));
 }
 
 NotifyEntity DBAccessor::fetchEntity(qint64 id)
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-    QString cmd = QString("SELECT %1 FROM notifications2 WHERE ID = :id").arg(EntityFields.join(","));
-    query.prepare(cmd);
+    // the queued writes are taken before the snapshot is read, so none of them is missed.
+    const auto writes = queuedWrites();
+    const ReadScope scope(this);
+    QSqlQuery &query = scope.statement(FetchEntityStatement);
+    const StatementReset reset(query);
     query.bindValue(":id", id);
 
     if (!query.exec()) {
@@ -338,24 +376,22 @@ NotifyEntity DBAccessor::fetchEntity(qint64 id)
         return {};
     }
 
+    NotifyEntity entity;
     if (query.next())
-        return parseEntity(query);
+        entity = parseEntity(query);
 
-    return {};
+    return applyQueuedWrites(id, entity, writes);
 }
 
 int DBAccessor::fetchEntityCount(const QString &appName, int processedType) const
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-    if (appName == DataAccessor::AllApp()) {
-        QString cmd = QString("SELECT COUNT(*) FROM notifications2 WHERE (ProcessedType = :processedType OR ProcessedType IS NULL)");
-        query.prepare(cmd);
-    } else {
-        QString cmd = QString("SELECT COUNT(*) FROM notifications2 WHERE AppName = :appName AND (ProcessedType = :processedType OR ProcessedType IS NULL)");
-        query.prepare(cmd);
+    const ReadScope scope(this);
+    const bool allApp = appName == DataAccessor::AllApp();
+    QSqlQuery &query = scope.statement(allApp ? FetchCountStatement : FetchAppCountStatement);
+    const StatementReset reset(query);
+    if (!allApp) {
         query.bindValue(":appName", appName);
     }
 
@@ -372,17 +408,41 @@ int DBAccessor::fetchEntityCount(const QString &appName, int processedType) cons
     return 0;
 }
 
+QHash<QString, int> DBAccessor::fetchEntityCounts(int processedType) const
+{
+    BENCHMARK();
+
+    const ReadScope scope(this);
+    QSqlQuery &query = scope.statement(FetchCountsStatement);
+    const StatementReset reset(query);
+    query.bindValue(":processedType", processedType);
+
+    if (!query.exec()) {
+        qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
+        return {};
+    }
+
+    QHash<QString, int> ret;
+    while (query.next()) {
+        ret.insert(query.value(0).toString(), query.value(1).toInt());
+    }
+
+    qDebug(notifyDBLog) << "Fetched entity counts of apps" << ret.size();
+    return ret;
+}
+
 NotifyEntity DBAccessor::fetchLastEntity(const QString &appName, int processedType)
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-    QString cmd =
-        QString(
-            "SELECT %1 FROM notifications2 WHERE AppName = :appName AND (ProcessedType = :processedType OR ProcessedType IS NULL) ORDER BY CTime DESC LIMIT 1")
-            .arg(EntityFields.join(","));
-    query.prepare(cmd);
+    // the center reads the last entity of the app right after removing one, it's found with the queued writes applied.
+    const auto writes = queuedWrites();
+    if (!writes.isEmpty())
+        return lastQueuedEntity(appName, processedType, writes);
+
+    const ReadScope scope(this);
+    QSqlQuery &query = scope.statement(FetchLastEntityStatement);
+    const StatementReset reset(query);
     query.bindValue(":appName", appName);
     query.bindValue(":processedType", processedType);
 
@@ -404,31 +464,17 @@ QList<NotifyEntity> DBAccessor::fetchEntities(const QString &appName, int proces
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-    if (appName == DataAccessor::AllApp()) {
-        if (maxCount >= 0) {
-            QString cmd = QString("SELECT %1 FROM notifications2 WHERE (ProcessedType = :processedType OR ProcessedType IS NULL) ORDER BY CTime DESC LIMIT :limit").arg(EntityFields.join(","));
-            query.prepare(cmd);
-            query.bindValue(":limit", maxCount);
-        } else {
-            QString cmd = QString("SELECT %1 FROM notifications2 WHERE (ProcessedType = :processedType OR ProcessedType IS NULL) ORDER BY CTime DESC").arg(EntityFields.join(","));
-            query.prepare(cmd);
-        }
-    } else {
-        if (maxCount >= 0) {
-            QString cmd = QString("SELECT %1 FROM notifications2 WHERE AppName = :appName AND (ProcessedType = :processedType OR ProcessedType IS NULL) ORDER BY CTime DESC LIMIT :limit").arg(EntityFields.join(","));
-            query.prepare(cmd);
-            query.bindValue(":appName", appName);
-            query.bindValue(":limit", maxCount);
-        } else {
-            QString cmd = QString("SELECT %1 FROM notifications2 WHERE AppName = :appName AND (ProcessedType = :processedType OR ProcessedType IS NULL) ORDER BY CTime DESC").arg(EntityFields.join(","));
-            query.prepare(cmd);
-            query.bindValue(":appName", appName);
-        }
+    const ReadScope scope(this);
+    const bool allApp = appName == DataAccessor::AllApp();
+    QSqlQuery &query = scope.statement(allApp ? FetchEntitiesStatement : FetchAppEntitiesStatement);
+    const StatementReset reset(query);
+    if (!allApp) {
+        query.bindValue(":appName", appName);
     }
 
     query.bindValue(":processedType", processedType);
+    // negative limit means no limit in sqlite.
+    query.bindValue(":limit", maxCount >= 0 ? maxCount : -1);
 
     if (!query.exec()) {
         qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
@@ -447,14 +493,77 @@ QList<NotifyEntity> DBAccessor::fetchEntities(const QString &appName, int proces
     return ret;
 }
 
+QList<NotifyEntity> DBAccessor::fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId)
+{
+    BENCHMARK();
+
+    const ReadScope scope(this);
+    const bool allApp = appName == DataAccessor::AllApp();
+    // the app index is ordered by CTime and then by the row id, a page is a range scan of it.
+    QSqlQuery &query = scope.statement(allApp ? FetchEntitiesPageStatement : FetchAppEntitiesPageStatement);
+    const StatementReset reset(query);
+    if (!allApp) {
+        query.bindValue(":appName", appName);
+    }
+
+    const bool firstPage = cursorTime <= 0 && cursorId <= 0;
+    query.bindValue(":processedType", processedType);
+    query.bindValue(":cursorTime", firstPage ? std::numeric_limits<qint64>::max() : cursorTime);
+    query.bindValue(":cursorId", firstPage ? std::numeric_limits<qint64>::max() : cursorId);
+    query.bindValue(":limit", maxCount >= 0 ? maxCount : -1);
+
+    if (!query.exec()) {
+        qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
+        return {};
+    }
+
+    QList<NotifyEntity> ret;
+    while (query.next()) {
+        auto entity = parseEntity(query);
+        if (!entity.isValid())
+            continue;
+        ret.append(entity);
+    }
+
+    qDebug(notifyDBLog) << "Fetched entities page size:" << ret.size() << ", cursor:" << cursorTime << cursorId;
+    return ret;
+}
+
+// a queued write removes one of the last entities of the snapshot or all of them, the expired ones are the oldest,
+// so the last entity left is in the first writes.size() + 1 ones or it's written by the queued writes.
+NotifyEntity DBAccessor::lastQueuedEntity(const QString &appName, int processedType, const QList<PendingWrite> &writes)
+{
+    QList<NotifyEntity> entities;
+    QSet<qint64> ids;
+    for (const auto &entity : fetchEntities(appName, processedType, writes.size() + 1)) {
+        entities << applyQueuedWrites(entity.id(), entity, writes);
+        ids << entity.id();
+    }
+    for (const auto &write : writes) {
+        const bool written = write.type == InsertWrite || write.type == ReplaceWrite || write.type == ProcessedTypeWrite;
+        if (written && !ids.contains(write.id)) {
+            entities << fetchEntity(write.id);
+            ids << write.id;
+        }
+    }
+
+    NotifyEntity ret;
+    for (const auto &entity : std::as_const(entities)) {
+        if (!entity.isValid() || entity.appName() != appName || entity.processedType() != processedType)
+            continue;
+        if (!ret.isValid() || qMakePair(entity.cTime(), entity.id()) > qMakePair(ret.cTime(), ret.id()))
+            ret = entity;
+    }
+    return ret;
+}
+
 NotifyEntity DBAccessor::fetchLastEntity(uint notifyId)
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-    QString cmd = QString("SELECT %1 FROM notifications2 WHERE notifyId = :notifyId ORDER BY CTime DESC LIMIT 1").arg(EntityFields.join(","));
-    query.prepare(cmd);
+    const ReadScope scope(this);
+    QSqlQuery &query = scope.statement(FetchLastBubbleStatement);
+    const StatementReset reset(query);
     query.bindValue(":notifyId", notifyId);
 
     if (!query.exec()) {
@@ -475,16 +584,10 @@ QList<QString> DBAccessor::fetchApps(int maxCount) const
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-    if (maxCount >= 0) {
-        QString cmd("SELECT DISTINCT AppName FROM notifications2 ORDER BY CTime DESC LIMIT :limit");
-        query.prepare(cmd);
-        query.bindValue(":limit", maxCount);
-    } else {
-        QString cmd("SELECT DISTINCT AppName FROM notifications2 ORDER BY CTime DESC");
-        query.prepare(cmd);
-    }
+    const ReadScope scope(this);
+    QSqlQuery &query = scope.statement(FetchAppsStatement);
+    const StatementReset reset(query);
+    query.bindValue(":limit", maxCount >= 0 ? maxCount : -1);
 
     if (!query.exec()) {
         qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
@@ -502,116 +605,861 @@ QList<QString> DBAccessor::fetchApps(int maxCount) const
     return ret;
 }
 
-void DBAccessor::removeEntity(qint64 id)
+QList<AppSummary> DBAccessor::fetchAppSummaries(int processedType, int topCount)
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
-
-    QString cmd("DELETE FROM notifications2 WHERE ID = :id");
-    query.prepare(cmd);
-    query.bindValue(":id", id);
+    const ReadScope scope(this);
+    QSqlQuery &query = scope.statement(FetchAppSummariesStatement);
+    const StatementReset reset(query);
+    query.bindValue(":processedType", processedType);
+    query.bindValue(":topCount", topCount);
 
     if (!query.exec()) {
         qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
-        return;
+        return {};
+    }
+
+    // rows of an app are adjacent, ordered by the rank.
+    QList<AppSummary> ret;
+    while (query.next()) {
+        auto entity = parseEntity(query);
+        if (!entity.isValid())
+            continue;
+
+        if (ret.isEmpty() || ret.last().appName != entity.appName()) {
+            AppSummary summary;
+            summary.appName = entity.appName();
+            summary.count = query.value("AppCount").toInt();
+            summary.lastCTime = query.value("LastCTime").toLongLong();
+            ret << summary;
+        }
+        ret.last().entities << entity;
     }
 
-    qDebug(notifyDBLog) << "Delete notify count" << query.numRowsAffected();
+    qDebug(notifyDBLog) << "Fetched app summaries count" << ret.size();
+    return ret;
 }
 
-void DBAccessor::removeEntityByApp(const QString &appName)
+QList<NotifyEntity> DBAccessor::search(const QString &query, const QString &appName, int maxCount, qint64 cursor)
 {
     BENCHMARK();
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
+    const auto terms = query.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (terms.isEmpty())
+        return {};
 
-    QString cmd("DELETE FROM notifications2 WHERE AppName = :appName");
-    query.prepare(cmd);
-    query.bindValue(":appName", appName);
+    // the tokenizer is only set on opening the database.
+    if (m_searchTokenizer.isEmpty())
+        return {};
 
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
-        return;
+    // only the table of the current schema is indexed, rows of the legacy table are found once they're migrated.
+    const ReadScope scope(this);
+
+    // terms are quoted to be matched as strings rather than the fts5 query syntax,
+    // terms shorter than a trigram can't use the index and are matched by LIKE.
+    const bool trigram = m_searchTokenizer == QLatin1String("trigram");
+    QStringList matchTerms;
+    QStringList likeTerms;
+    for (const auto &term : terms) {
+        if (trigram && term.size() < TrigramLength) {
+            QString pattern(term);
+            pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+            likeTerms << QString("%%1%").arg(pattern);
+        } else {
+            const auto quoted = QString("\"%1\"").arg(QString(term).replace("\"", "\"\""));
+            matchTerms << (trigram ? quoted : quoted + "*");
+        }
     }
 
-    qDebug(notifyDBLog) << "Delete notify count" << query.numRowsAffected();
-}
+    QStringList fields;
+    for (const auto &field : EntityFields) {
+        fields << QString("n.%1 AS %1").arg(field);
+    }
+    QStringList conditions {
+        QString("f.rowid < :cursor"),
+        QString("n.%1 = :processedType").arg(ColumnProcessedType)
+    };
+    if (!matchTerms.isEmpty()) {
+        conditions << QString("f.%1 MATCH :match").arg(SearchTableName);
+    }
+    for (int i = 0; i < likeTerms.size(); i++) {
+        conditions << QString("(f.%1 LIKE :like%4 ESCAPE '\\' OR f.%2 LIKE :like%4 ESCAPE '\\' OR f.%3 LIKE :like%4 ESCAPE '\\')")
+                          .arg(ColumnSummary, ColumnBody, ColumnAppName)
+                          .arg(i);
+    }
+    if (appName != DataAccessor::AllApp()) {
+        conditions << QString("n.%1 = :appName").arg(ColumnAppName);
+    }
 
-void DBAccessor::removeEntitiesByExpiredTime(qint64 expiredTime)
-{
-    BENCHMARK();
+    // the newest matches come first, walking the index in rowid order stops at the limit without sorting.
+    const auto sql = QString("SELECT %1 FROM %2 AS f JOIN %3 AS n ON n.%4 = f.rowid WHERE %5 ORDER BY f.rowid DESC LIMIT :limit")
+                         .arg(fields.join(","), SearchTableName, TableName_v3, ColumnId, conditions.join(" AND "));
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
+    QSqlQuery sqlQuery(scope.connection());
+    sqlQuery.setForwardOnly(true);
+    if (!sqlQuery.prepare(sql)) {
+        qWarning(notifyDBLog) << "Failed to prepare search query:" << sqlQuery.lastError().text();
+        return {};
+    }
+    sqlQuery.bindValue(":cursor", cursor > 0 ? cursor : std::numeric_limits<qint64>::max());
+    sqlQuery.bindValue(":processedType", NotifyEntity::Processed);
+    if (!matchTerms.isEmpty()) {
+        sqlQuery.bindValue(":match", matchTerms.join(" "));
+    }
+    for (int i = 0; i < likeTerms.size(); i++) {
+        sqlQuery.bindValue(QString(":like%1").arg(i), likeTerms[i]);
+    }
+    if (appName != DataAccessor::AllApp()) {
+        sqlQuery.bindValue(":appName", appName);
+    }
+    sqlQuery.bindValue(":limit", maxCount >= 0 ? maxCount : -1);
 
-    QString cmd("DELETE FROM notifications2 WHERE CTime < :expiredTime");
-    query.prepare(cmd);
-    query.bindValue(":expiredTime", expiredTime);
+    if (!sqlQuery.exec()) {
+        qWarning(notifyDBLog) << "Search execution error:" << sqlQuery.lastError().text();
+        return {};
+    }
 
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
-        return;
+    QList<NotifyEntity> ret;
+    while (sqlQuery.next()) {
+        auto entity = parseEntity(sqlQuery);
+        if (!entity.isValid())
+            continue;
+        ret.append(entity);
     }
 
-    qDebug(notifyDBLog) << "Delete notify count" << query.numRowsAffected();
+    qDebug(notifyDBLog) << "Searched entities size:" << ret.size();
+    return ret;
+}
+
+void DBAccessor::removeEntity(qint64 id)
+{
+    PendingWrite write;
+    write.type = RemoveWrite;
+    write.id = id;
+    enqueueWrite(std::move(write));
+}
+
+void DBAccessor::removeEntityByApp(const QString &appName)
+{
+    PendingWrite write;
+    write.type = RemoveByAppWrite;
+    write.appName = appName;
+    enqueueWrite(std::move(write));
+}
+
+void DBAccessor::removeEntitiesByExpiredTime(qint64 expiredTime)
+{
+    PendingWrite write;
+    write.type = RemoveExpiredWrite;
+    write.expiredTime = expiredTime;
+    enqueueWrite(std::move(write));
 }
 
 void DBAccessor::clear()
 {
-    BENCHMARK();
+    PendingWrite write;
+    write.type = ClearWrite;
+    enqueueWrite(std::move(write));
+}
 
-    QMutexLocker locker(&m_mutex);
-    QSqlQuery query(m_connection);
+void DBAccessor::setRetentionPolicy(const RetentionPolicy &policy)
+{
+    qInfo(notifyLog) << "Notification retention policy, maxCount:" << policy.maxCount << ", maxBytes:" << policy.maxBytes
+                     << ", maxAge:" << policy.maxAgeMSecs;
+    QMutexLocker locker(&m_queueMutex);
+    m_retentionPolicy = policy;
+}
 
-    QString cmd("DELETE FROM notifications2");
-    query.prepare(cmd);
+void DBAccessor::compact(bool idle)
+{
+    QMutexLocker locker(&m_queueMutex);
+    if (!m_writer)
+        return;
 
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "Query execution error:" << query.lastError().text();
+    // a running compaction may rebuild the database once the session turns idle.
+    m_compactIdle = m_compactIdle || idle;
+    if (m_compactPending)
         return;
-    }
 
-    qDebug(notifyDBLog) << "Delete notify count" << query.numRowsAffected();
+    qDebug(notifyDBLog) << "Request compaction, idle:" << idle;
+    m_compactPending = true;
+    m_queueCondition.wakeAll();
 }
 
-void DBAccessor::tryToCreateTable()
+void DBAccessor::setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler)
 {
-    QSqlQuery query(m_connection);
+    QMutexLocker locker(&m_queueMutex);
+    m_removedHandler = handler;
+}
 
-    QStringList columns = {
-            QString("%1 INTEGER PRIMARY KEY AUTOINCREMENT").arg(ColumnId),
-            QString("%1 TEXT").arg(ColumnIcon),
-            QString("%1 TEXT").arg(ColumnSummary),
-            QString("%1 TEXT").arg(ColumnBody),
-            QString("%1 TEXT").arg(ColumnAppName),
-            QString("%1 TEXT").arg(ColumnAppId),
-            QString("%1 TEXT").arg(ColumnCTime),
-            QString("%1 TEXT").arg(ColumnAction),
-            QString("%1 TEXT").arg(ColumnHint),
-            QString("%1 TEXT").arg(ColumnReplacesId),
-            QString("%1 TEXT").arg(ColumnNotifyId),
-            QString("%1 TEXT").arg(ColumnTimeout),
-            QString("%1 INTEGER").arg(ColumnProcessedType)
-    };
+void DBAccessor::sync()
+{
+    QList<EntityCount> removed;
+    {
+        QMutexLocker locker(&m_mutex);
+        flushPendingWrites(removed);
+    }
 
-    QString sql = QString("CREATE TABLE IF NOT EXISTS %1(%2)")
-            .arg(TableName_v2)
-            .arg(columns.join(", "));
+    std::function<void(const QList<EntityCount> &)> removedHandler;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        removedHandler = m_removedHandler;
+    }
+    if (!removed.isEmpty() && removedHandler) {
+        removedHandler(removed);
+    }
+}
 
-    query.prepare(sql);
+void DBAccessor::startWriter()
+{
+    m_writer = QThread::create([this]() {
+        writerLoop();
+    });
+    m_writer->setObjectName("NotificationDBWriter");
+    m_writer->start();
+
+    // DBAccessor::instance() is never destroyed, commit the queue before the process exits.
+    if (qApp) {
+        m_quitConnection = QObject::connect(qApp, &QCoreApplication::aboutToQuit, qApp, [this]() {
+            stopWriter();
+            sync();
+        });
+    }
+}
 
-    if (!query.exec()) {
-        qWarning(notifyDBLog) << "create table failed" << query.lastError().text();
+void DBAccessor::stopWriter()
+{
+    if (!m_writer)
+        return;
+
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_stopping = true;
+        m_queueCondition.wakeAll();
     }
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+}
 
-    // add new columns in history
-    QMap<QString, QString> newColumns;
-    newColumns[ColumnAction] = "TEXT";
-    newColumns[ColumnHint] = "TEXT";
-    newColumns[ColumnReplacesId] = "TEXT";
+void DBAccessor::writerLoop()
+{
+    while (true) {
+        bool migrate = false;
+        bool compact = false;
+        bool idle = false;
+        std::function<void(const QList<EntityCount> &)> removedHandler;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            while (m_pendingWrites.isEmpty() && !m_stopping) {
+                if (!m_migrationPending && !m_compactPending) {
+                    m_queueCondition.wait(&m_queueMutex);
+                } else if (!m_queueCondition.wait(&m_queueMutex, MigrationIntervalMSecs)) {
+                    // rows are migrated before the history is compacted.
+                    migrate = m_migrationPending;
+                    compact = !migrate && m_compactPending;
+                    idle = m_compactIdle;
+                    break;
+                }
+            }
+            if (m_stopping)
+                return;
+
+            // let the batch grow until it's full or the flush interval is reached.
+            QDeadlineTimer deadline(WriteFlushIntervalMSecs);
+            while (!migrate && !compact && m_pendingWrites.size() < WriteBatchSize && !m_stopping) {
+                if (!m_queueCondition.wait(&m_queueMutex, deadline))
+                    break;
+            }
+            removedHandler = m_removedHandler;
+        }
+
+        QList<EntityCount> removed;
+        {
+            QMutexLocker locker(&m_mutex);
+            flushPendingWrites(removed);
+            if (migrate) {
+                migrateNextSlice();
+            } else if (compact) {
+                compactNextSlice(idle, removed);
+            }
+        }
+        // the handler may read from the accessor, m_mutex is released.
+        if (!removed.isEmpty() && removedHandler) {
+            removedHandler(removed);
+        }
+    }
+}
+
+void DBAccessor::enqueueWrite(PendingWrite &&write)
+{
+    QMutexLocker locker(&m_queueMutex);
+    m_pendingWrites.append(std::move(write));
+    const auto size = m_pendingWrites.size();
+    if (size == 1 || size >= WriteBatchSize)
+        m_queueCondition.wakeAll();
+}
+
+// m_mutex must be held by the caller, the counts of the expired entities are appended to removed.
+void DBAccessor::flushPendingWrites(QList<EntityCount> &removed) const
+{
+    QList<PendingWrite> writes;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        writes.swap(m_pendingWrites);
+        m_committingWrites = writes;
+    }
+    if (writes.isEmpty())
+        return;
+
+    BENCHMARK();
+
+    // images referred by the rows are on disk before the rows are committed.
+    NotifyImageStore::instance()->savePendingImages();
+
+    auto execWrites = [this](const PendingWrite &write, QList<EntityCount> &counts) {
+        bool ret = execWrite(write, TableName_v3, counts);
+        // rows which are not migrated yet are still in the legacy table.
+        if (m_readTable == MigrationViewName && write.type != InsertWrite) {
+            ret = execWrite(write, TableName_v2, counts) && ret;
+        }
+        return ret;
+    };
+
+    QSqlDatabase connection(m_connection);
+    QList<EntityCount> batchRemoved;
+    bool committed = false;
+    if (connection.transaction()) {
+        for (const auto &write : writes) {
+            execWrites(write, batchRemoved);
+        }
+        committed = connection.commit();
+        if (!committed) {
+            qWarning(notifyDBLog) << "Commit transaction failed:" << connection.lastError().text();
+            connection.rollback();
+        }
+    } else {
+        qWarning(notifyDBLog) << "Begin transaction failed:" << connection.lastError().text();
+    }
+
+    if (committed) {
+        for (const auto &item : std::as_const(batchRemoved)) {
+            addEntityCount(removed, item.appName, item.processedType, item.count);
+        }
+    } else {
+        // the ids of the writes are returned already, every write is committed by itself,
+        // so a failing one doesn't drop the others.
+        int failedCount = 0;
+        for (const auto &write : writes) {
+            if (!execWrites(write, removed)) {
+                ++failedCount;
+                qWarning(notifyDBLog) << "Dropped the write type:" << write.type << ", id:" << write.id;
+            }
+        }
+        if (failedCount > 0) {
+            qWarning(notifyDBLog) << "Failed to commit writes count" << failedCount << "of" << writes.size();
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_committingWrites.clear();
+    }
+
+    qDebug(notifyDBLog) << "Committed writes count" << writes.size();
+}
+
+// writes which aren't committed yet in the queued order.
+QList<DBAccessor::PendingWrite> DBAccessor::queuedWrites() const
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_committingWrites + m_pendingWrites;
+}
+
+// returns the read only connection of the calling thread, it's closed when the thread exits.
+DBAccessor::ReaderConnection *DBAccessor::readerConnection() const
+{
+    bool migrating = false;
+    QString migrationViewSql;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        migrating = m_migrating;
+        migrationViewSql = m_migrationViewSql;
+    }
+
+    ReaderConnection *reader = nullptr;
+    if (m_readers.hasLocalData()) {
+        reader = m_readers.localData();
+    } else {
+        reader = new ReaderConnection();
+        m_readers.setLocalData(reader);
+        const auto name = QString("%1_reader_%2").arg(m_connectionName).arg(quintptr(reader), 0, 16);
+        reader->connection = QSqlDatabase::cloneDatabase(m_connectionName, name);
+        reader->connection.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=1000");
+        if (!reader->connection.open()) {
+            // it's kept closed, reads of this thread fail rather than wait for the writer.
+            qWarning(notifyDBLog) << "Open reader connection error:" << reader->connection.lastError().text();
+            return reader;
+        }
+
+        QSqlQuery query(reader->connection);
+        if (!query.exec("PRAGMA cache_size=-2000")) {
+            qWarning(notifyDBLog) << "Failed to set cache_size of the reader:" << query.lastError().text();
+        }
+        qDebug(notifyDBLog) << "Open reader connection" << name << "in the thread" << QThread::currentThread();
+    }
+
+    if (reader->connection.isOpen() && reader->migrating != migrating) {
+        // the cached statements refer to the view or to the table.
+        reader->statements.clear();
+        QSqlQuery query(reader->connection);
+        const auto sql = migrating ? migrationViewSql : QString("DROP VIEW IF EXISTS %1").arg(MigrationViewName);
+        if (query.exec(sql)) {
+            reader->migrating = migrating;
+        } else {
+            qWarning(notifyDBLog) << "Failed to update migration view of the reader:" << query.lastError().text();
+        }
+    }
+    return reader;
+}
+
+bool DBAccessor::execWrite(const PendingWrite &write, const QString &table, QList<EntityCount> &removed) const
+{
+    // the caller doesn't know which entities are expired, they're counted for the removed handler.
+    QList<EntityCount> expired;
+    if (write.type == RemoveExpiredWrite) {
+        QSqlQuery &query = statement(FetchExpiredCountsStatement, table);
+        const StatementReset reset(query);
+        query.bindValue(":expiredTime", write.expiredTime);
+        if (!query.exec()) {
+            qWarning(notifyDBLog) << "Count expired entities failed: " << query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            addEntityCount(expired, query.value(0).toString(), query.value(1).toInt(), query.value(2).toInt());
+        }
+    }
+
+    const auto &entity = write.entity;
+    Statement id = InsertStatement;
+    switch (write.type) {
+    case InsertWrite:
+        id = InsertStatement;
+        break;
+    case ReplaceWrite:
+        id = ReplaceStatement;
+        break;
+    case ProcessedTypeWrite:
+        id = UpdateProcessedTypeStatement;
+        break;
+    case RemoveWrite:
+        id = RemoveStatement;
+        break;
+    case RemoveByAppWrite:
+        id = RemoveByAppStatement;
+        break;
+    case RemoveExpiredWrite:
+        id = RemoveExpiredStatement;
+        break;
+    case ClearWrite:
+        id = ClearStatement;
+        break;
+    }
+
+    QSqlQuery &query = statement(id, table);
+    const StatementReset reset(query);
+
+    switch (write.type) {
+    case InsertWrite:
+    case ReplaceWrite:
+        query.bindValue(":id", write.id);
+        query.bindValue(":icon", entity.icon);
+        query.bindValue(":summary", entity.summary);
+        query.bindValue(":body", entity.body);
+        query.bindValue(":appName", entity.appName);
+        query.bindValue(":appId", entity.appId);
+        query.bindValue(":ctime", entity.cTime);
+        query.bindValue(":action", entity.actions);
+        query.bindValue(":hint", entity.hints);
+        query.bindValue(":replacesId", entity.replacesId);
+        query.bindValue(":notifyId", entity.bubbleId);
+        query.bindValue(":processedType", entity.processedType);
+        break;
+    case ProcessedTypeWrite:
+        query.bindValue(":id", write.id);
+        query.bindValue(":processed", write.processedType);
+        break;
+    case RemoveWrite:
+        query.bindValue(":id", write.id);
+        break;
+    case RemoveByAppWrite:
+        query.bindValue(":appName", write.appName);
+        break;
+    case RemoveExpiredWrite:
+        query.bindValue(":expiredTime", write.expiredTime);
+        break;
+    case ClearWrite:
+        break;
+    }
+
+    if (!query.exec()) {
+        qWarning(notifyDBLog) << "Write to database failed: " << query.lastError().text() << query.lastQuery() << write.id << entity.bubbleId;
+        return false;
+    }
+
+    for (const auto &item : std::as_const(expired)) {
+        addEntityCount(removed, item.appName, item.processedType, item.count);
+    }
+
+    qDebug(notifyDBLog) << "Write type:" << write.type << ", id:" << write.id << ", affected rows:" << query.numRowsAffected();
+    return true;
+}
+
+// the entity of the values of a queued write, it's the same as the one read back once the write is committed.
+NotifyEntity DBAccessor::entityOf(qint64 id, const EntityValues &values)
+{
+    NotifyEntity entity(id, values.appName);
+    entity.setAppId(values.appId.isEmpty() ? values.appName : values.appId);
+    entity.setAppIcon(values.icon);
+    entity.setSummary(values.summary);
+    entity.setBody(values.body);
+    entity.setCTime(values.cTime);
+    entity.setHintsData(values.hints);
+    entity.setActionsData(values.actions);
+    entity.setProcessedType(values.processedType);
+    entity.setBubbleId(values.bubbleId);
+    entity.setReplacesId(values.replacesId);
+    return entity;
+}
+
+// applies the queued writes in order to the entity of the id read from the snapshot,
+// a write committed before the snapshot is applied twice, which doesn't change the result.
+NotifyEntity DBAccessor::applyQueuedWrites(qint64 id, NotifyEntity entity, const QList<PendingWrite> &writes)
+{
+    for (const auto &write : writes) {
+        switch (write.type) {
+        case InsertWrite:
+            if (write.id == id)
+                entity = entityOf(id, write.entity);
+            break;
+        case ReplaceWrite:
+            if (write.id == id && entity.isValid())
+                entity = entityOf(id, write.entity);
+            break;
+        case ProcessedTypeWrite:
+            if (write.id == id && entity.isValid())
+                entity.setProcessedType(write.processedType);
+            break;
+        case RemoveWrite:
+            if (write.id == id)
+                entity = {};
+            break;
+        case RemoveByAppWrite:
+            if (entity.isValid() && entity.appName() == write.appName)
+                entity = {};
+            break;
+        case RemoveExpiredWrite:
+            if (entity.isValid() && entity.cTime() < write.expiredTime)
+                entity = {};
+            break;
+        case ClearWrite:
+            entity = {};
+            break;
+        }
+    }
+    return entity;
+}
+
+// called in the thread of the entity's owner, hints and actions are encoded here.
+DBAccessor::EntityValues DBAccessor::entityValues(const NotifyEntity &entity)
+{
+    EntityValues values;
+    values.icon = entity.appIcon();
+    values.summary = entity.summary();
+    values.body = entity.body();
+    values.appName = entity.appName();
+    values.appId = entity.appId();
+    values.cTime = entity.cTime();
+    values.actions = entity.actionsData();
+    values.hints = entity.hintsData();
+    values.replacesId = entity.replacesId();
+    values.bubbleId = entity.bubbleId();
+    values.processedType = entity.processedType();
+    return values;
+}
+
+QString DBAccessor::statementSql(Statement id, const QString &table)
+{
+    switch (id) {
+    case InsertStatement: {
+        QString columns = QStringList{
+                ColumnId,
+                ColumnIcon,
+                ColumnSummary,
+                ColumnBody,
+                ColumnAppName,
+                ColumnAppId,
+                ColumnCTime,
+                ColumnAction,
+                ColumnHint,
+                ColumnReplacesId,
+                ColumnNotifyId,
+                ColumnProcessedType
+        }.join(", ");
+
+        return QString("INSERT INTO %1 (%2) VALUES (%3)")
+                .arg(table)
+                .arg(columns)
+                .arg(":id, :icon, :summary, :body, :appName, :appId, :ctime, :action, :hint, :replacesId, :notifyId, :processedType");
+    }
+    case ReplaceStatement: {
+        QString columns = QStringList{QString("%1 = :icon").arg(ColumnIcon),
+                                      QString("%1 = :summary").arg(ColumnSummary),
+                                      QString("%1 = :body").arg(ColumnBody),
+                                      QString("%1 = :appName").arg(ColumnAppName),
+                                      QString("%1 = :appId").arg(ColumnAppId),
+                                      QString("%1 = :ctime").arg(ColumnCTime),
+                                      QString("%1 = :action").arg(ColumnAction),
+                                      QString("%1 = :hint").arg(ColumnHint),
+                                      QString("%1 = :replacesId").arg(ColumnReplacesId),
+                                      QString("%1 = :notifyId").arg(ColumnNotifyId),
+                                      QString("%1 = :processedType").arg(ColumnProcessedType)}
+                              .join(", ");
+
+        return QString("UPDATE %1 SET %2 WHERE ID = :id").arg(table).arg(columns);
+    }
+    case UpdateProcessedTypeStatement:
+        return QString("UPDATE %1 SET ProcessedType = :processed WHERE ID = :id").arg(table);
+    case RemoveStatement:
+        return QString("DELETE FROM %1 WHERE ID = :id").arg(table);
+    case RemoveByAppStatement:
+        return QString("DELETE FROM %1 WHERE AppName = :appName").arg(table);
+    case RemoveExpiredStatement:
+        return QString("DELETE FROM %1 WHERE CTime < :expiredTime").arg(table);
+    case ClearStatement:
+        return QString("DELETE FROM %1").arg(table);
+    case FetchEntityStatement:
+        return QString("SELECT %1 FROM %2 WHERE ID = :id").arg(EntityFields.join(","), table);
+    case FetchCountStatement:
+        return QString("SELECT COUNT(*) FROM %1 WHERE ProcessedType = :processedType").arg(table);
+    case FetchAppCountStatement:
+        return QString("SELECT COUNT(*) FROM %1 WHERE AppName = :appName AND ProcessedType = :processedType").arg(table);
+    case FetchCountsStatement:
+        return QString("SELECT AppName, COUNT(*) FROM %1 WHERE ProcessedType = :processedType GROUP BY AppName").arg(table);
+    case FetchExpiredCountsStatement:
+        return QString("SELECT AppName, ProcessedType, COUNT(*) FROM %1 WHERE CTime < :expiredTime GROUP BY AppName, ProcessedType").arg(table);
+    case FetchLastEntityStatement:
+        return QString("SELECT %1 FROM %2 WHERE AppName = :appName AND ProcessedType = :processedType ORDER BY CTime DESC LIMIT 1")
+            .arg(EntityFields.join(","), table);
+    case FetchEntitiesStatement:
+        return QString("SELECT %1 FROM %2 WHERE ProcessedType = :processedType ORDER BY CTime DESC LIMIT :limit")
+            .arg(EntityFields.join(","), table);
+    case FetchAppEntitiesStatement:
+        return QString("SELECT %1 FROM %2 WHERE AppName = :appName AND ProcessedType = :processedType ORDER BY CTime DESC LIMIT :limit")
+            .arg(EntityFields.join(","), table);
+    case FetchEntitiesPageStatement:
+        return QString("SELECT %1 FROM %2 WHERE ProcessedType = :processedType AND (CTime, ID) < (:cursorTime, :cursorId) "
+                       "ORDER BY CTime DESC, ID DESC LIMIT :limit")
+            .arg(EntityFields.join(","), table);
+    case FetchAppEntitiesPageStatement:
+        return QString("SELECT %1 FROM %2 WHERE AppName = :appName AND ProcessedType = :processedType AND (CTime, ID) < (:cursorTime, :cursorId) "
+                       "ORDER BY CTime DESC, ID DESC LIMIT :limit")
+            .arg(EntityFields.join(","), table);
+    case FetchLastBubbleStatement:
+        return QString("SELECT %1 FROM %2 WHERE notifyId = :notifyId ORDER BY CTime DESC LIMIT 1").arg(EntityFields.join(","), table);
+    case FetchAppsStatement:
+        return QString("SELECT DISTINCT AppName FROM %1 ORDER BY CTime DESC LIMIT :limit").arg(table);
+    case FetchAppSummariesStatement: {
+        // the top entities of every app with its count and last time, the apps are ordered by the last time.
+        // the windows only read the narrow columns, the other columns of the top entities are joined by the id.
+        QStringList fields;
+        for (const auto &field : EntityFields) {
+            fields << QString("n.%1 AS %1").arg(field);
+        }
+        return QString("SELECT %1, r.AppCount AS AppCount, r.LastCTime AS LastCTime FROM ("
+                       "SELECT ID, AppName, "
+                       "ROW_NUMBER() OVER (PARTITION BY AppName ORDER BY CTime DESC, ID DESC) AS AppRank, "
+                       "COUNT(*) OVER (PARTITION BY AppName) AS AppCount, "
+                       "MAX(CTime) OVER (PARTITION BY AppName) AS LastCTime "
+                       "FROM %2 WHERE ProcessedType = :processedType) AS r "
+                       "JOIN %2 AS n ON n.ID = r.ID "
+                       "WHERE r.AppRank <= :topCount ORDER BY r.LastCTime DESC, r.AppName, r.AppRank")
+            .arg(fields.join(","), table);
+    }
+    }
+    return {};
+}
+
+// m_mutex must be held by the caller.
+QSqlQuery &DBAccessor::statement(Statement id, const QString &table) const
+{
+    return cachedStatement(m_statements[qMakePair(static_cast<int>(id), table)], m_connection, id, table);
+}
+
+// prepares the statement in the slot of a cache if it's empty, statements of all connections are counted here.
+QSqlQuery &DBAccessor::cachedStatement(QSharedPointer<QSqlQuery> &query, const QSqlDatabase &connection, Statement id, const QString &table) const
+{
+    if (query) {
+        ++m_statementHits;
+        return *query;
+    }
+
+    ++m_statementMisses;
+    query.reset(new QSqlQuery(connection));
+    query->setForwardOnly(true);
+    if (!query->prepare(statementSql(id, table))) {
+        qWarning(notifyDBLog) << "Prepare statement failed:" << query->lastError().text() << query->lastQuery();
+    }
+    return *query;
+}
+
+// m_mutex must be held by the caller.
+void DBAccessor::clearStatements() const
+{
+    qInfo(notifyLog) << "Clear statement cache, hits:" << m_statementHits.load() << ", misses:" << m_statementMisses.load();
+    m_statements.clear();
+}
+
+qint64 DBAccessor::statementCacheHits() const
+{
+    return m_statementHits;
+}
+
+qint64 DBAccessor::statementCacheMisses() const
+{
+    return m_statementMisses;
+}
+
+void DBAccessor::tryToCreateTable()
+{
+    QSqlQuery query(m_connection);
+    m_readTable = TableName_v3;
+
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        version = query.value(0).toInt();
+    }
+
+    QStringList columns = {
+            QString("%1 INTEGER PRIMARY KEY AUTOINCREMENT").arg(ColumnId),
+            QString("%1 TEXT").arg(ColumnIcon),
+            QString("%1 TEXT").arg(ColumnSummary),
+            QString("%1 TEXT").arg(ColumnBody),
+            QString("%1 TEXT").arg(ColumnAppName),
+            QString("%1 TEXT").arg(ColumnAppId),
+            QString("%1 INTEGER").arg(ColumnCTime),
+            QString("%1 TEXT").arg(ColumnAction),
+            QString("%1 TEXT").arg(ColumnHint),
+            QString("%1 INTEGER").arg(ColumnReplacesId),
+            QString("%1 INTEGER").arg(ColumnNotifyId),
+            QString("%1 INTEGER").arg(ColumnTimeout),
+            QString("%1 INTEGER").arg(ColumnProcessedType)
+    };
+
+    // auto_vacuum can only be changed before the first table is created, existing databases are converted by compact() when the session is idle.
+    if (!isTableExist(TableName_v3) && !isTableExist(TableName_v2)) {
+        if (!query.exec("PRAGMA auto_vacuum = INCREMENTAL")) {
+            qWarning(notifyDBLog) << "Failed to set auto_vacuum:" << query.lastError().text();
+        }
+    }
+
+    QString sql = QString("CREATE TABLE IF NOT EXISTS %1(%2)")
+            .arg(TableName_v3)
+            .arg(columns.join(", "));
+
+    if (!query.exec(sql)) {
+        qWarning(notifyDBLog) << "create table failed" << query.lastError().text();
+    }
+
+    // fetchEntities/fetchLastEntity/fetchEntityCount filter on app and processed type ordered by time,
+    // pages of all apps filter on processed type ordered by time, fetchLastEntity(notifyId) looks up the latest bubble.
+    const QStringList indexes {
+        QString("CREATE INDEX IF NOT EXISTS idx_%1_app ON %1(%2, %3, %4)").arg(TableName_v3, ColumnAppName, ColumnProcessedType, ColumnCTime),
+        QString("CREATE INDEX IF NOT EXISTS idx_%1_processed ON %1(%2, %3)").arg(TableName_v3, ColumnProcessedType, ColumnCTime),
+        QString("CREATE INDEX IF NOT EXISTS idx_%1_notifyid ON %1(%2, %3)").arg(TableName_v3, ColumnNotifyId, ColumnCTime)
+    };
+    for (const auto &item : indexes) {
+        if (!query.exec(item)) {
+            qWarning(notifyDBLog) << "create index failed" << query.lastError().text();
+        }
+    }
+
+    tryToCreateSearchIndex();
+
+    // the legacy table is kept until all of its rows are moved, which may span several sessions.
+    if (isTableExist(TableName_v2)) {
+        qInfo(notifyLog) << "Upgrade notification schema from version" << version << "to" << SchemaVersion;
+        tryToUpgradeLegacyTable();
+        startMigration();
+    }
+
+    if (version != SchemaVersion && !query.exec(QString("PRAGMA user_version = %1").arg(SchemaVersion))) {
+        qWarning(notifyDBLog) << "Failed to set schema version:" << query.lastError().text();
+    }
+}
+
+void DBAccessor::tryToCreateSearchIndex()
+{
+    QSqlQuery query(m_connection);
+
+    if (!isTableExist(SearchTableName)) {
+        // trigram matches substrings, so words of languages written without spaces can be found,
+        // it needs sqlite 3.34, fallback to the word tokenizer.
+        const QStringList tokenizers {"trigram", "unicode61 remove_diacritics 2"};
+        bool created = false;
+        for (const auto &tokenizer : tokenizers) {
+            const auto sql = QString("CREATE VIRTUAL TABLE %1 USING fts5(%2, %3, %4, content='%5', content_rowid='%6', tokenize='%7')")
+                                 .arg(SearchTableName, ColumnSummary, ColumnBody, ColumnAppName, TableName_v3, ColumnId, tokenizer);
+            if (query.exec(sql)) {
+                created = true;
+                break;
+            }
+            qDebug(notifyDBLog) << "Failed to create search index with tokenizer" << tokenizer << query.lastError().text();
+        }
+        if (!created) {
+            qWarning(notifyDBLog) << "Full-text search isn't available:" << query.lastError().text();
+            return;
+        }
+
+        // index the existing rows, later rows are indexed by the triggers.
+        if (!query.exec(QString("INSERT INTO %1(%1) VALUES('rebuild')").arg(SearchTableName))) {
+            qWarning(notifyDBLog) << "Failed to build search index:" << query.lastError().text();
+        }
+    }
+
+    const auto newValues = QString("new.%1, new.%2, new.%3, new.%4").arg(ColumnId, ColumnSummary, ColumnBody, ColumnAppName);
+    const auto oldValues = QString("old.%1, old.%2, old.%3, old.%4").arg(ColumnId, ColumnSummary, ColumnBody, ColumnAppName);
+    const auto insertSql = QString("INSERT INTO %1(rowid, %2, %3, %4) VALUES (%5);")
+                               .arg(SearchTableName, ColumnSummary, ColumnBody, ColumnAppName, newValues);
+    const auto deleteSql = QString("INSERT INTO %1(%1, rowid, %2, %3, %4) VALUES ('delete', %5);")
+                               .arg(SearchTableName, ColumnSummary, ColumnBody, ColumnAppName, oldValues);
+    const QStringList triggers {
+        QString("CREATE TRIGGER IF NOT EXISTS %1_insert AFTER INSERT ON %2 BEGIN %3 END").arg(SearchTableName, TableName_v3, insertSql),
+        QString("CREATE TRIGGER IF NOT EXISTS %1_delete AFTER DELETE ON %2 BEGIN %3 END").arg(SearchTableName, TableName_v3, deleteSql),
+        // processed type changes don't touch the index.
+        QString("CREATE TRIGGER IF NOT EXISTS %1_update AFTER UPDATE OF %2, %3, %4 ON %5 BEGIN %6 %7 END")
+            .arg(SearchTableName, ColumnSummary, ColumnBody, ColumnAppName, TableName_v3, deleteSql, insertSql)
+    };
+    for (const auto &item : triggers) {
+        if (!query.exec(item)) {
+            qWarning(notifyDBLog) << "Failed to create search trigger:" << query.lastError().text();
+            return;
+        }
+    }
+
+    if (query.exec(QString("SELECT sql FROM SQLITE_MASTER WHERE NAME='%1'").arg(SearchTableName)) && query.next()) {
+        m_searchTokenizer = query.value(0).toString().contains("trigram") ? QString("trigram") : QString("unicode61");
+    }
+}
+
+void DBAccessor::tryToUpgradeLegacyTable()
+{
+    // add new columns in history
+    QMap<QString, QString> newColumns;
+    newColumns[ColumnAction] = "TEXT";
+    newColumns[ColumnHint] = "TEXT";
+    newColumns[ColumnReplacesId] = "TEXT";
     newColumns[ColumnNotifyId] = "TEXT";
     newColumns[ColumnTimeout] = "TEXT";
     newColumns[ColumnProcessedType] = "INTEGER";
@@ -620,13 +1468,348 @@ void DBAccessor::tryToCreateTable()
     for (auto it = newColumns.begin(); it != newColumns.end(); ++it) {
         if (!isAttributeValid(TableName_v2, it.key())) {
             addAttributeToTable(TableName_v2, it.key(), it.value());
+        }
+    }
+
+    // reads filter on the processed type without a NULL branch, so the indexes cover them,
+    // legacy rows without the processed type are processed ones.
+    updateProcessTypeValue();
+}
+
+void DBAccessor::startMigration()
+{
+    QSqlQuery query(m_connection);
+
+    // the view is temporary and only lives in this connection, it unions both schemas with typed columns.
+    QString sql = QString("CREATE TEMP VIEW IF NOT EXISTS %1 AS "
+                          "SELECT %2 FROM %3 UNION ALL "
+                          "SELECT %4 FROM %5")
+                      .arg(MigrationViewName)
+                      .arg(EntityFields.join(","))
+                      .arg(TableName_v3)
+                      .arg(legacyColumns().join(","))
+                      .arg(TableName_v2);
+    if (!query.exec(sql)) {
+        qWarning(notifyDBLog) << "Failed to create migration view, skip migration:" << query.lastError().text();
+        return;
+    }
+
+    qInfo(notifyLog) << "Start migrating notifications to schema version" << SchemaVersion;
+    m_readTable = MigrationViewName;
+    QMutexLocker locker(&m_queueMutex);
+    m_migrationPending = true;
+    m_migrating = true;
+    m_migrationViewSql = sql;
+}
+
+// m_mutex must be held by the caller.
+void DBAccessor::migrateNextSlice()
+{
+    BENCHMARK();
+
+    QSqlQuery query(m_connection);
+    QSqlDatabase connection(m_connection);
+
+    auto stopMigration = [this]() {
+        QMutexLocker locker(&m_queueMutex);
+        m_migrationPending = false;
+    };
+
+    // move the newest rows first, the recent history is the most frequently read.
+    QString sql = QString("SELECT MIN(%1) FROM (SELECT %1 FROM %2 ORDER BY %1 DESC LIMIT %3)")
+                      .arg(ColumnId, TableName_v2)
+                      .arg(MigrationSliceSize);
+    if (!query.exec(sql) || !query.next()) {
+        qWarning(notifyDBLog) << "Failed to query migration slice:" << query.lastError().text();
+        stopMigration();
+        return;
+    }
+
+    if (query.value(0).isNull()) {
+        finishMigration();
+        stopMigration();
+        return;
+    }
+
+    const auto lowerId = query.value(0).toLongLong();
+    connection.transaction();
+    const QStringList sqls {
+        QString("INSERT INTO %1 (%2) SELECT %3 FROM %4 WHERE %5 >= %6")
+            .arg(TableName_v3, EntityFields.join(","), legacyColumns().join(","), TableName_v2, ColumnId)
+            .arg(lowerId),
+        QString("DELETE FROM %1 WHERE %2 >= %3").arg(TableName_v2, ColumnId).arg(lowerId)
+    };
+    for (const auto &item : sqls) {
+        if (!query.exec(item)) {
+            qWarning(notifyDBLog) << "Failed to migrate notifications, keep the legacy table:" << query.lastError().text();
+            connection.rollback();
+            stopMigration();
+            return;
+        }
+    }
+    if (!connection.commit()) {
+        qWarning(notifyDBLog) << "Failed to commit migration slice:" << connection.lastError().text();
+        connection.rollback();
+        stopMigration();
+        return;
+    }
+
+    qDebug(notifyDBLog) << "Migrated notifications from id" << lowerId;
+}
+
+void DBAccessor::finishMigration()
+{
+    {
+        // all rows are in the new table, readers switch to it before the legacy table is dropped.
+        QMutexLocker locker(&m_queueMutex);
+        m_migrating = false;
+    }
+    // cached statements refer to the view and the legacy table, they must be finalized before dropping them.
+    clearStatements();
+
+    QSqlQuery query(m_connection);
+
+    if (!query.exec(QString("DROP VIEW IF EXISTS %1").arg(MigrationViewName))) {
+        qWarning(notifyDBLog) << "Failed to drop migration view:" << query.lastError().text();
+        return;
+    }
+    m_readTable = TableName_v3;
+
+    if (!query.exec(QString("DROP TABLE IF EXISTS %1").arg(TableName_v2))) {
+        qWarning(notifyDBLog) << "Failed to drop legacy table:" << query.lastError().text();
+    }
+
+    qInfo(notifyLog) << "Finished migrating notifications to schema version" << SchemaVersion;
+}
+
+// m_mutex must be held by the caller, the counts of the removed rows are appended to removed.
+void DBAccessor::compactNextSlice(bool idle, QList<EntityCount> &removed)
+{
+    BENCHMARK();
+
+    RetentionPolicy policy;
+    {
+        QMutexLocker locker(&m_queueMutex);
+        policy = m_retentionPolicy;
+    }
+
+    const int removedCount = trimNextSlice(policy, removed);
+    if (removedCount < 0) {
+        // the failed statement isn't retried every slice, the next compaction runs it again.
+        qWarning(notifyLog) << "Stop compacting notifications, failed to trim the history";
+        QMutexLocker locker(&m_queueMutex);
+        m_compactPending = false;
+        m_compactIdle = false;
+        return;
+    }
+    if (removedCount > 0)
+        return;
+
+    if (reclaimNextSlice(idle))
+        return;
+
+    removeUnusedImages();
 
-            // update processed type value for new columns
-            if (it.key() == ColumnProcessedType) {
-                updateProcessTypeValue();
+    // the WAL is folded back into the database and truncated, so it doesn't grow over the uptime.
+    QSqlQuery query(m_connection);
+    if (!query.exec("PRAGMA wal_checkpoint(TRUNCATE)")) {
+        qWarning(notifyDBLog) << "Failed to checkpoint WAL:" << query.lastError().text();
+    }
+    if (!query.exec("PRAGMA optimize")) {
+        qWarning(notifyDBLog) << "Failed to optimize:" << query.lastError().text();
+    }
+
+    qInfo(notifyLog) << "Finished compacting notifications";
+    QMutexLocker locker(&m_queueMutex);
+    m_compactPending = false;
+    m_compactIdle = false;
+}
+
+// removes a slice of the oldest rows which are out of the policy, returns 0 if all rows are kept and -1 on failure.
+int DBAccessor::trimNextSlice(const RetentionPolicy &policy, QList<EntityCount> &removed)
+{
+    QSqlQuery query(m_connection);
+
+    auto removeOldest = [this, &query, &removed](const QString &condition, qint64 count) {
+        // row ids grow with the time, the oldest rows are found by the primary key without sorting.
+        const auto sql = QString("SELECT %2, %3, %4 FROM %1 WHERE %5 ORDER BY %2 LIMIT %6")
+                             .arg(TableName_v3, ColumnId, ColumnAppName, ColumnProcessedType, condition)
+                             .arg(std::min<qint64>(count, RetentionSliceSize));
+        if (!query.exec(sql)) {
+            qWarning(notifyDBLog) << "Failed to query notifications out of the retention policy:" << query.lastError().text();
+            return -1;
+        }
+        QStringList ids;
+        QList<EntityCount> counts;
+        while (query.next()) {
+            ids << query.value(0).toString();
+            addEntityCount(counts, query.value(1).toString(), query.value(2).toInt(), 1);
+        }
+        if (ids.isEmpty())
+            return 0;
+
+        // the counts are reported to the owner of the accessor, which keeps counters of the entities.
+        if (!query.exec(QString("DELETE FROM %1 WHERE %2 IN (%3)").arg(TableName_v3, ColumnId, ids.join(",")))) {
+            qWarning(notifyDBLog) << "Failed to remove notifications out of the retention policy:" << query.lastError().text();
+            return -1;
+        }
+        for (const auto &item : std::as_const(counts)) {
+            addEntityCount(removed, item.appName, item.processedType, item.count);
+        }
+        const int removedCount = ids.size();
+        qDebug(notifyDBLog) << "Removed notifications out of the retention policy" << removedCount << condition;
+        return removedCount;
+    };
+
+    if (policy.maxAgeMSecs > 0) {
+        const auto cutoffTime = QDateTime::currentMSecsSinceEpoch() - policy.maxAgeMSecs;
+        const int removedCount = removeOldest(QString("%1 < %2").arg(ColumnCTime).arg(cutoffTime), RetentionSliceSize);
+        if (removedCount != 0)
+            return removedCount;
+    }
+
+    if (policy.maxCount > 0) {
+        if (!query.exec(QString("SELECT COUNT(*) FROM %1").arg(TableName_v3)) || !query.next()) {
+            qWarning(notifyDBLog) << "Failed to count notifications:" << query.lastError().text();
+            return -1;
+        }
+        const auto excess = query.value(0).toLongLong() - policy.maxCount;
+        if (excess > 0)
+            return removeOldest("1", excess);
+    }
+
+    if (policy.maxBytes > 0) {
+        // pages in the freelist are reused or reclaimed later, they aren't counted.
+        qint64 pageCount = 0, freePageCount = 0, pageSize = 0;
+        if (query.exec("PRAGMA page_count") && query.next())
+            pageCount = query.value(0).toLongLong();
+        if (query.exec("PRAGMA freelist_count") && query.next())
+            freePageCount = query.value(0).toLongLong();
+        if (query.exec("PRAGMA page_size") && query.next())
+            pageSize = query.value(0).toLongLong();
+
+        if ((pageCount - freePageCount) * pageSize > policy.maxBytes)
+            return removeOldest("1", RetentionSliceSize);
+    }
+
+    return 0;
+}
+
+// m_mutex must be held by the caller.
+void DBAccessor::removeUnusedImages()
+{
+    // keys of the images are text in the encoded hints, they're found without decoding the hints.
+    static const QRegularExpression keyPattern("[0-9a-f]{40}");
+
+    QSqlQuery query(m_connection);
+    if (!query.exec(QString("SELECT %1, %2 FROM %3").arg(ColumnIcon, ColumnHint, TableName_v3))) {
+        qWarning(notifyDBLog) << "Failed to query image keys:" << query.lastError().text();
+        return;
+    }
+
+    QSet<QString> usedKeys;
+    while (query.next()) {
+        for (int i = 0; i < 2; ++i) {
+            const auto text = QString::fromLatin1(query.value(i).toByteArray());
+            auto matches = keyPattern.globalMatch(text);
+            while (matches.hasNext()) {
+                usedKeys.insert(matches.next().captured());
             }
         }
     }
+
+    const int removedCount = NotifyImageStore::instance()->removeUnusedImages(usedKeys);
+    if (removedCount > 0) {
+        qInfo(notifyLog) << "Removed unused notification images" << removedCount;
+    }
+}
+
+// reclaims a slice of free pages, returns true if there are pages left.
+bool DBAccessor::reclaimNextSlice(bool idle)
+{
+    QSqlQuery query(m_connection);
+
+    int autoVacuum = 0;
+    qint64 pageCount = 0, freePageCount = 0;
+    if (query.exec("PRAGMA auto_vacuum") && query.next())
+        autoVacuum = query.value(0).toInt();
+    if (query.exec("PRAGMA page_count") && query.next())
+        pageCount = query.value(0).toLongLong();
+    if (query.exec("PRAGMA freelist_count") && query.next())
+        freePageCount = query.value(0).toLongLong();
+
+    if (freePageCount <= 0)
+        return false;
+
+    // databases created before incremental vacuum are rebuilt once, when a quarter of them is free.
+    // the rebuild blocks the writer and copies the whole file, it only runs when the session is idle.
+    const int IncrementalVacuum = 2;
+    if (autoVacuum != IncrementalVacuum) {
+        if (!idle || freePageCount * 4 < pageCount)
+            return false;
+
+        qInfo(notifyLog) << "Rebuild notification database to enable incremental vacuum, free pages:" << freePageCount;
+        // VACUUM can't run while a cached statement is active.
+        clearStatements();
+        if (!query.exec("PRAGMA auto_vacuum = INCREMENTAL") || !query.exec("VACUUM")) {
+            qWarning(notifyDBLog) << "Failed to vacuum:" << query.lastError().text();
+        }
+        return false;
+    }
+
+    if (!query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(VacuumSlicePages))) {
+        qWarning(notifyDBLog) << "Failed to run incremental vacuum:" << query.lastError().text();
+        return false;
+    }
+    // the pragma returns a row for each step, all of them must be stepped.
+    while (query.next()) {
+    }
+    return freePageCount > VacuumSlicePages;
+}
+
+QStringList DBAccessor::legacyColumns() const
+{
+    // legacy table stores numbers as TEXT, convert them to be ordered and compared as numbers.
+    QStringList columns;
+    for (const auto &column : EntityFields) {
+        if (column == ColumnCTime || column == ColumnNotifyId || column == ColumnReplacesId) {
+            columns << QString("CAST(%1 AS INTEGER) AS %1").arg(column);
+        } else if (column == ColumnProcessedType) {
+            columns << QString("COALESCE(%1, %2) AS %1").arg(column).arg(NotifyEntity::Processed);
+        } else {
+            columns << column;
+        }
+    }
+    return columns;
+}
+
+bool DBAccessor::isTableExist(const QString &tableName) const
+{
+    QSqlQuery query(m_connection);
+
+    QString sqlCmd = QString("SELECT 1 FROM SQLITE_MASTER WHERE TYPE='table' AND NAME='%1'").arg(tableName);
+    if (!query.exec(sqlCmd)) {
+        qDebug(notifyDBLog) << sqlCmd << ",lastError:" << query.lastError().text();
+        return false;
+    }
+    return query.next();
+}
+
+qint64 DBAccessor::lastRowId() const
+{
+    QSqlQuery query(m_connection);
+
+    // AUTOINCREMENT never reuses ids of deleted rows, so prefer the sequence over MAX(ID).
+    qint64 rowId = 0;
+    QString sqlCmd = QString("SELECT MAX(seq) FROM sqlite_sequence WHERE name IN ('%1', '%2')").arg(TableName_v2, TableName_v3);
+    if (query.exec(sqlCmd) && query.next()) {
+        rowId = query.value(0).toLongLong();
+    }
+    sqlCmd = QString("SELECT MAX(%1) FROM %2").arg(ColumnId, m_readTable);
+    if (query.exec(sqlCmd) && query.next()) {
+        rowId = qMax(rowId, query.value(0).toLongLong());
+    }
+    return rowId;
 }
 
 bool DBAccessor::isAttributeValid(const QString &tableName, const QString &attributeName) const
@@ -670,7 +1853,8 @@ void DBAccessor::updateProcessTypeValue()
     QSqlQuery query(m_connection);
 
     QString updateCmd = QString("UPDATE %1 SET ProcessedType = %2 WHERE ProcessedType IS NULL")
-            .arg(TableName_v2, NotifyEntity::Processed);
+            .arg(TableName_v2)
+            .arg(NotifyEntity::Processed);
 
     if (!query.exec(updateCmd)) {
         qWarning(notifyDBLog) << "Failed to update ProcessedType NULL values:" << query.lastError();
@@ -685,9 +1869,9 @@ NotifyEntity DBAccessor::parseEntity(const QSqlQuery &query)
     const auto body = query.value(ColumnBody).toString();
     const auto appName = query.value(ColumnAppName).toString();
     const auto appId = query.value(ColumnAppId).toString();
-    const auto time = query.value(ColumnCTime).toString();
-    const auto action = query.value(ColumnAction).toString();
-    const auto hint = query.value(ColumnHint).toString();
+    const auto time = query.value(ColumnCTime).toLongLong();
+    const auto action = query.value(ColumnAction);
+    const auto hint = query.value(ColumnHint);
     const auto processedType = query.value(ColumnProcessedType).toUInt();
     const auto notifyId = query.value(ColumnNotifyId).toUInt();
     const auto replacesId = query.value(ColumnReplacesId).toUInt();
@@ -697,9 +1881,18 @@ NotifyEntity DBAccessor::parseEntity(const QSqlQuery &query)
     entity.setAppIcon(icon);
     entity.setSummary(summary);
     entity.setBody(body);
-    entity.setCTime(time.toLongLong());
-    entity.setHintString(hint);
-    entity.setActionString(action);
+    entity.setCTime(time);
+    // rows written before the binary encoding keep hints and actions as text.
+    if (hint.typeId() == QMetaType::QByteArray) {
+        entity.setHintsData(hint.toByteArray());
+    } else {
+        entity.setHintString(hint.toString());
+    }
+    if (action.typeId() == QMetaType::QByteArray) {
+        entity.setActionsData(action.toByteArray());
+    } else {
+        entity.setActionString(action.toString());
+    }
     entity.setProcessedType(processedType);
     entity.setBubbleId(notifyId);
     entity.setReplacesId(replacesId);
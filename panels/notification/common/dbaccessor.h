@@ -1,20 +1,34 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <QSharedPointer>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QThreadStorage>
+#include <QWaitCondition>
+
+#include <atomic>
 
 #include "dataaccessor.h"
 
+class QThread;
 namespace notification {
 class NotifyEntity;
 
 /**
  * @brief The DBAccessor class
+ * Mutations are queued and committed in batches by a storage thread.
+ * Every reading thread has its own read only connection, reads see the last committed
+ * snapshot and never wait for the writer as WAL allows concurrent readers.
+ * fetchEntity() and fetchLastEntity() apply the queued writes on top of the snapshot, so they see them,
+ * lists are read from the snapshot, fresh entities are handed over by NotifyEntityChannel.
+ * Migration and compaction run in slices when the queue is idle.
  */
 class DBAccessor : public DataAccessor
 {
@@ -34,18 +48,132 @@ public:
 
     NotifyEntity fetchEntity(qint64 id) override;
     int fetchEntityCount(const QString &appName, int processedType) const override;
+    QHash<QString, int> fetchEntityCounts(int processedType) const override;
     NotifyEntity fetchLastEntity(const QString &appName, int processedType) override;
     QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount) override;
+    QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId) override;
     NotifyEntity fetchLastEntity(uint notifyId) override;
     QList<QString> fetchApps(int maxCount) const override;
+    QList<AppSummary> fetchAppSummaries(int processedType, int topCount) override;
+    QList<NotifyEntity> search(const QString &query, const QString &appName, int maxCount, qint64 cursor) override;
 
     void removeEntity(qint64 id) override;
     void removeEntityByApp(const QString &appName) override;
     void removeEntitiesByExpiredTime(qint64 expiredTime) override;
     void clear() override;
 
+    void setRetentionPolicy(const RetentionPolicy &policy) override;
+    void compact(bool idle) override;
+    void setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler) override;
+
+    // commit all queued writes, blocking the caller until they are on disk.
+    void sync();
+
+    qint64 statementCacheHits() const;
+    qint64 statementCacheMisses() const;
+
 private:
+    enum WriteType {
+        InsertWrite,
+        ReplaceWrite,
+        ProcessedTypeWrite,
+        RemoveWrite,
+        RemoveByAppWrite,
+        RemoveExpiredWrite,
+        ClearWrite
+    };
+
+    // values of the entity bound by the storage thread, they're copied when the write is queued,
+    // the entity is explicitly shared and its owner may change it meanwhile.
+    struct EntityValues
+    {
+        QString icon;
+        QString summary;
+        QString body;
+        QString appName;
+        QString appId;
+        qint64 cTime = 0;
+        QByteArray actions;
+        QByteArray hints;
+        uint replacesId = 0;
+        uint bubbleId = 0;
+        int processedType = 0;
+    };
+
+    struct PendingWrite
+    {
+        WriteType type = InsertWrite;
+        qint64 id = 0;
+        EntityValues entity;
+        int processedType = 0;
+        QString appName;
+        qint64 expiredTime = 0;
+    };
+
+    enum Statement {
+        InsertStatement,
+        ReplaceStatement,
+        UpdateProcessedTypeStatement,
+        RemoveStatement,
+        RemoveByAppStatement,
+        RemoveExpiredStatement,
+        ClearStatement,
+        FetchEntityStatement,
+        FetchCountStatement,
+        FetchAppCountStatement,
+        FetchCountsStatement,
+        FetchExpiredCountsStatement,
+        FetchLastEntityStatement,
+        FetchEntitiesStatement,
+        FetchAppEntitiesStatement,
+        FetchEntitiesPageStatement,
+        FetchAppEntitiesPageStatement,
+        FetchLastBubbleStatement,
+        FetchAppsStatement,
+        FetchAppSummariesStatement
+    };
+
+    class ReadScope;
+    struct ReaderConnection
+    {
+        ~ReaderConnection();
+        QSqlDatabase connection;
+        QHash<int, QSharedPointer<QSqlQuery>> statements;
+        // whether the temporary migration view is created in the connection.
+        bool migrating = false;
+    };
+
+    static EntityValues entityValues(const NotifyEntity &entity);
+    static NotifyEntity entityOf(qint64 id, const EntityValues &values);
+    static NotifyEntity applyQueuedWrites(qint64 id, NotifyEntity entity, const QList<PendingWrite> &writes);
+    NotifyEntity lastQueuedEntity(const QString &appName, int processedType, const QList<PendingWrite> &writes);
+    static QString statementSql(Statement id, const QString &table);
+    QSqlQuery &statement(Statement id, const QString &table) const;
+    QSqlQuery &cachedStatement(QSharedPointer<QSqlQuery> &query, const QSqlDatabase &connection, Statement id, const QString &table) const;
+    void clearStatements() const;
+
     void tryToCreateTable();
+    void tryToCreateSearchIndex();
+    void tryToUpgradeLegacyTable();
+    void startMigration();
+    void migrateNextSlice();
+    void finishMigration();
+    void compactNextSlice(bool idle, QList<EntityCount> &removed);
+    int trimNextSlice(const RetentionPolicy &policy, QList<EntityCount> &removed);
+    bool reclaimNextSlice(bool idle);
+    void removeUnusedImages();
+    QStringList legacyColumns() const;
+    bool isTableExist(const QString &tableName) const;
+    qint64 lastRowId() const;
+
+    void startWriter();
+    void stopWriter();
+    void writerLoop();
+    void enqueueWrite(PendingWrite &&write);
+    void flushPendingWrites(QList<EntityCount> &removed) const;
+    QList<PendingWrite> queuedWrites() const;
+    ReaderConnection *readerConnection() const;
+    bool execWrite(const PendingWrite &write, const QString &table, QList<EntityCount> &removed) const;
 
     bool isAttributeValid(const QString &tableName, const QString &attributeName) const;
     bool addAttributeToTable(const QString &tableName, const QString &attributeName, const QString &type) const;
@@ -57,6 +185,34 @@ private:
 private:
     mutable QMutex m_mutex;
     QSqlDatabase m_connection;
+    QString m_connectionName;
     QString m_key;
+    QString m_readTable;
+    // tokenizer of the full-text index, it's empty if search isn't available.
+    QString m_searchTokenizer;
+    // prepared statements keyed by statement and table, they live as long as the connection.
+    mutable QHash<QPair<int, QString>, QSharedPointer<QSqlQuery>> m_statements;
+    // statements of the reader connections are counted too, out of m_mutex.
+    mutable std::atomic<qint64> m_statementHits = 0;
+    mutable std::atomic<qint64> m_statementMisses = 0;
+
+    mutable QMutex m_queueMutex;
+    mutable QWaitCondition m_queueCondition;
+    mutable QList<PendingWrite> m_pendingWrites;
+    // the batch the storage thread is committing, reads apply it until it's committed.
+    mutable QList<PendingWrite> m_committingWrites;
+    // reader connections create the temporary view as well while migrating.
+    bool m_migrating = false;
+    QString m_migrationViewSql;
+    mutable QThreadStorage<ReaderConnection *> m_readers;
+    qint64 m_lastRowId = 0;
+    bool m_stopping = false;
+    bool m_migrationPending = false;
+    bool m_compactPending = false;
+    bool m_compactIdle = false;
+    RetentionPolicy m_retentionPolicy;
+    std::function<void(const QList<EntityCount> &)> m_removedHandler;
+    QThread *m_writer = nullptr;
+    QMetaObject::Connection m_quitConnection;
 };
 }
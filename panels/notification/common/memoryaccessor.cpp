@@ -4,11 +4,26 @@
 
 #include "memoryaccessor.h"
 #include <QDebug>
+#include <QMap>
+#include <QRegularExpression>
+#include <algorithm>
 #include <limits>
 
 namespace notification
 {
 
+template<typename Key>
+static void removeFromBucket(QHash<Key, std::set<quint64>> &index, const Key &key, quint64 sequence)
+{
+    auto iter = index.find(key);
+    if (iter == index.end())
+        return;
+
+    iter->erase(sequence);
+    if (iter->empty())
+        index.erase(iter);
+}
+
 MemoryAccessor::~MemoryAccessor()
 {
 }
@@ -17,27 +32,25 @@ qint64 MemoryAccessor::addEntity(const NotifyEntity &entity)
 {
     static qint64 g_Id = NotifyEntity::InvalidId; // use negative id for in-memory entities
     QMutexLocker locker(&m_mutex);
-    m_entities << entity;
-    return --g_Id;
+    const auto id = --g_Id;
+    NotifyEntity item(entity);
+    item.setId(id);
+    insertItem(++m_sequence, item);
+    return id;
 }
 
 qint64 MemoryAccessor::replaceEntity(qint64 id, const NotifyEntity &entity)
 {
     QMutexLocker locker(&m_mutex);
-    auto iter = std::find_if(m_entities.begin(), m_entities.end(), [id](const NotifyEntity &entity) {
-        if (entity.id() == id)
-            return true;
-        return false;
-    });
-
-    if (iter != m_entities.end()) {
-        const auto index = (iter - m_entities.begin());
-        Q_ASSERT(index >= 0);
-        m_entities[index] = entity;
-        m_entities[index].setId(id);
-    } else {
+    auto iter = m_idIndex.constFind(id);
+    if (iter == m_idIndex.constEnd())
         return NotifyEntity::InvalidId;
-    }
+
+    const auto sequence = iter.value();
+    removeItem(sequence);
+    NotifyEntity item(entity);
+    item.setId(id);
+    insertItem(sequence, item);
 
     return id;
 }
@@ -45,76 +58,160 @@ qint64 MemoryAccessor::replaceEntity(qint64 id, const NotifyEntity &entity)
 void MemoryAccessor::updateEntityProcessedType(qint64 id, int processedType)
 {
     QMutexLocker locker(&m_mutex);
-    auto iter = std::find_if(m_entities.begin(), m_entities.end(), [id](const NotifyEntity &entity) {
-        if (entity.id() == id)
-            return true;
-        return false;
-    });
-    if (iter != m_entities.end()) {
-        iter->setProcessedType(processedType);
-    }
+    auto iter = m_idIndex.constFind(id);
+    if (iter == m_idIndex.constEnd())
+        return;
+
+    const auto sequence = iter.value();
+    NotifyEntity item = m_entities[sequence].entity;
+    removeItem(sequence);
+    item.setProcessedType(processedType);
+    insertItem(sequence, item);
 }
 
 NotifyEntity MemoryAccessor::fetchEntity(qint64 id)
 {
     QMutexLocker locker(&m_mutex);
-    auto iter = std::find_if(m_entities.begin(), m_entities.end(), [id](const NotifyEntity &entity) {
-        if (entity.id() == id)
-            return true;
-        return false;
-    });
-    if (iter != m_entities.end())
-        return *iter;
-    return {};
+    auto iter = m_idIndex.constFind(id);
+    if (iter == m_idIndex.constEnd())
+        return {};
+
+    return m_entities.at(iter.value()).entity;
 }
 
 int MemoryAccessor::fetchEntityCount(const QString &appName, int processedType) const
 {
     QMutexLocker locker(&m_mutex);
-    const auto count = std::count_if(m_entities.begin(), m_entities.end(), [appName, processedType](const NotifyEntity &entity) {
-        if ((entity.appName() == appName || AllApp() == appName) && entity.processedType() == processedType)
-            return true;
-        return false;
-    });
-    return count;
+    if (AllApp() == appName) {
+        auto iter = m_typeIndex.constFind(processedType);
+        return iter != m_typeIndex.constEnd() ? static_cast<int>(iter->size()) : 0;
+    }
+
+    auto iter = m_appIndex.constFind(AppKey(appName, processedType));
+    return iter != m_appIndex.constEnd() ? static_cast<int>(iter->size()) : 0;
+}
+
+QHash<QString, int> MemoryAccessor::fetchEntityCounts(int processedType) const
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, int> ret;
+    for (auto iter = m_appIndex.constBegin(); iter != m_appIndex.constEnd(); ++iter) {
+        if (iter.key().second == processedType)
+            ret[iter.key().first] = static_cast<int>(iter->size());
+    }
+    return ret;
 }
 
 NotifyEntity MemoryAccessor::fetchLastEntity(const QString &appName, int processedType)
 {
     QMutexLocker locker(&m_mutex);
-    auto iter = std::find_if(m_entities.rbegin(), m_entities.rend(), [appName, processedType](const NotifyEntity &entity) {
-        if (entity.appName() == appName && entity.processedType() == processedType)
-            return true;
-        return false;
-    });
-    if (iter != m_entities.rend())
-        return *iter;
-    return {};
+    auto iter = m_appIndex.constFind(AppKey(appName, processedType));
+    if (iter == m_appIndex.constEnd())
+        return {};
+
+    return lastEntity(iter.value());
 }
 
 NotifyEntity MemoryAccessor::fetchLastEntity(uint notifyId)
 {
     QMutexLocker locker(&m_mutex);
-    auto iter = std::find_if(m_entities.rbegin(), m_entities.rend(), [notifyId](const NotifyEntity &entity) {
-        if (entity.bubbleId() == notifyId)
-            return true;
-        return false;
-    });
-    if (iter != m_entities.rend())
-        return *iter;
-    return {};
+    auto iter = m_bubbleIndex.constFind(notifyId);
+    if (iter == m_bubbleIndex.constEnd())
+        return {};
+
+    return lastEntity(iter.value());
 }
 
 QList<NotifyEntity> MemoryAccessor::fetchEntities(const QString &appName, int processedType, int maxCount)
 {
     QMutexLocker locker(&m_mutex);
+    const Bucket *bucket = nullptr;
+    if (AllApp() == appName) {
+        auto iter = m_typeIndex.constFind(processedType);
+        if (iter != m_typeIndex.constEnd())
+            bucket = &iter.value();
+    } else {
+        auto iter = m_appIndex.constFind(AppKey(appName, processedType));
+        if (iter != m_appIndex.constEnd())
+            bucket = &iter.value();
+    }
+    if (!bucket)
+        return {};
+
     QList<NotifyEntity> ret;
-    for (const auto &item : m_entities) {
+    for (const auto sequence : *bucket) {
         if (maxCount >= 0 && ret.count() > maxCount)
             break;
-        if ((item.appName() == appName || AllApp() == appName) && item.processedType() == processedType) {
-            ret.append(item);
-        }
+        ret.append(m_entities.at(sequence).entity);
+    }
+    return ret;
+}
+
+QList<NotifyEntity> MemoryAccessor::fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId)
+{
+    QMutexLocker locker(&m_mutex);
+    const Bucket *bucket = nullptr;
+    if (AllApp() == appName) {
+        auto iter = m_typeIndex.constFind(processedType);
+        if (iter != m_typeIndex.constEnd())
+            bucket = &iter.value();
+    } else {
+        auto iter = m_appIndex.constFind(AppKey(appName, processedType));
+        if (iter != m_appIndex.constEnd())
+            bucket = &iter.value();
+    }
+    if (!bucket)
+        return {};
+
+    const bool firstPage = cursorTime <= 0 && cursorId <= 0;
+    QList<QPair<QPair<qint64, qint64>, NotifyEntity>> entities;
+    for (const auto sequence : *bucket) {
+        const auto &item = m_entities.at(sequence);
+        const auto key = qMakePair(item.entity.cTime(), item.id);
+        if (!firstPage && key >= qMakePair(cursorTime, cursorId))
+            continue;
+        entities.append(qMakePair(key, item.entity));
+    }
+    std::sort(entities.begin(), entities.end(), [](const auto &item1, const auto &item2) {
+        return item1.first > item2.first;
+    });
+
+    QList<NotifyEntity> ret;
+    for (const auto &item : std::as_const(entities)) {
+        if (maxCount >= 0 && ret.count() >= maxCount)
+            break;
+        ret.append(item.second);
+    }
+    return ret;
+}
+
+QList<NotifyEntity> MemoryAccessor::search(const QString &query, const QString &appName, int maxCount, qint64 cursor)
+{
+    const auto terms = query.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (terms.isEmpty())
+        return {};
+
+    QMutexLocker locker(&m_mutex);
+    auto bucket = m_typeIndex.constFind(NotifyEntity::Processed);
+    if (bucket == m_typeIndex.constEnd())
+        return {};
+
+    QList<NotifyEntity> ret;
+    for (auto iter = bucket->rbegin(); iter != bucket->rend(); ++iter) {
+        if (maxCount >= 0 && ret.count() >= maxCount)
+            break;
+        const auto &item = m_entities.at(*iter);
+        if (cursor > 0 && item.id >= cursor)
+            continue;
+        if (appName != AllApp() && item.appName != appName)
+            continue;
+
+        const auto text = QStringList{item.entity.summary(), item.entity.body(), item.appName}.join('\n');
+        const bool matched = std::all_of(terms.begin(), terms.end(), [&text](const QString &term) {
+            return text.contains(term, Qt::CaseInsensitive);
+        });
+        if (matched)
+            ret.append(item.entity);
     }
     return ret;
 }
@@ -122,11 +219,26 @@ QList<NotifyEntity> MemoryAccessor::fetchEntities(const QString &appName, int pr
 QList<QString> MemoryAccessor::fetchApps(int maxCount) const
 {
     QMutexLocker locker(&m_mutex);
-    QList<QString> ret;
-    for (const auto &item : m_entities) {
-        if (!ret.contains(item.appName())) {
-            ret.append(item.appName());
+    // apps are ordered by their first entity.
+    QMap<quint64, QString> firstSequences;
+    QHash<QString, quint64> apps;
+    for (auto iter = m_appIndex.constBegin(); iter != m_appIndex.constEnd(); ++iter) {
+        const auto &appName = iter.key().first;
+        const auto first = *iter->begin();
+        auto app = apps.find(appName);
+        if (app == apps.end()) {
+            apps.insert(appName, first);
+        } else if (first < app.value()) {
+            app.value() = first;
         }
+    }
+    for (auto iter = apps.constBegin(); iter != apps.constEnd(); ++iter) {
+        firstSequences.insert(iter.value(), iter.key());
+    }
+
+    QList<QString> ret;
+    for (const auto &item : std::as_const(firstSequences)) {
+        ret.append(item);
         if (maxCount >= 0 && ret.count() > maxCount)
             break;
     }
@@ -136,31 +248,105 @@ QList<QString> MemoryAccessor::fetchApps(int maxCount) const
 void MemoryAccessor::removeEntity(qint64 id)
 {
     QMutexLocker locker(&m_mutex);
-    m_entities.removeIf([id](const NotifyEntity &entity) {
-        return entity.id() == id;
-    });
+    auto iter = m_idIndex.constFind(id);
+    if (iter == m_idIndex.constEnd())
+        return;
+
+    removeItem(iter.value());
 }
 
 void MemoryAccessor::removeEntityByApp(const QString &appName)
 {
     QMutexLocker locker(&m_mutex);
-    m_entities.removeIf([appName](const NotifyEntity &entity) {
-        return entity.appName() == appName;
-    });
+    QList<quint64> sequences;
+    for (auto iter = m_appIndex.constBegin(); iter != m_appIndex.constEnd(); ++iter) {
+        if (iter.key().first == appName)
+            sequences.append(QList<quint64>(iter->begin(), iter->end()));
+    }
+    for (const auto sequence : std::as_const(sequences)) {
+        removeItem(sequence);
+    }
 }
 
 void MemoryAccessor::removeEntitiesByExpiredTime(qint64 expiredTime)
 {
-    QMutexLocker locker(&m_mutex);
-    m_entities.removeIf([expiredTime](const NotifyEntity &entity) {
-        return entity.cTime() < expiredTime;
-    });
+    QList<EntityCount> removed;
+    std::function<void(const QList<EntityCount> &)> handler;
+    {
+        QMutexLocker locker(&m_mutex);
+        QMap<AppKey, int> counts;
+        QList<quint64> sequences;
+        for (const auto &[sequence, item] : m_entities) {
+            if (item.entity.cTime() < expiredTime) {
+                sequences.append(sequence);
+                ++counts[AppKey(item.appName, item.processedType)];
+            }
+        }
+        for (const auto sequence : std::as_const(sequences)) {
+            removeItem(sequence);
+        }
+        for (auto iter = counts.cbegin(); iter != counts.cend(); ++iter) {
+            removed << EntityCount{iter.key().first, iter.key().second, iter.value()};
+        }
+        handler = m_removedHandler;
+    }
+    // the handler may read from the accessor, m_mutex is released.
+    if (!removed.isEmpty() && handler)
+        handler(removed);
 }
 
 void MemoryAccessor::clear()
 {
     QMutexLocker locker(&m_mutex);
     m_entities.clear();
+    m_idIndex.clear();
+    m_bubbleIndex.clear();
+    m_appIndex.clear();
+    m_typeIndex.clear();
+}
+
+void MemoryAccessor::setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler)
+{
+    QMutexLocker locker(&m_mutex);
+    m_removedHandler = handler;
+}
+
+void MemoryAccessor::insertItem(quint64 sequence, const NotifyEntity &entity)
+{
+    Item item;
+    item.entity = entity;
+    item.id = entity.id();
+    item.appName = entity.appName();
+    item.processedType = entity.processedType();
+    item.bubbleId = entity.bubbleId();
+
+    m_idIndex.insert(item.id, sequence);
+    m_bubbleIndex[item.bubbleId].insert(sequence);
+    m_appIndex[AppKey(item.appName, item.processedType)].insert(sequence);
+    m_typeIndex[item.processedType].insert(sequence);
+    m_entities[sequence] = item;
+}
+
+void MemoryAccessor::removeItem(quint64 sequence)
+{
+    auto iter = m_entities.find(sequence);
+    if (iter == m_entities.end())
+        return;
+
+    const auto &item = iter->second;
+    m_idIndex.remove(item.id);
+    removeFromBucket(m_bubbleIndex, item.bubbleId, sequence);
+    removeFromBucket(m_appIndex, AppKey(item.appName, item.processedType), sequence);
+    removeFromBucket(m_typeIndex, item.processedType, sequence);
+    m_entities.erase(iter);
+}
+
+NotifyEntity MemoryAccessor::lastEntity(const Bucket &bucket) const
+{
+    if (bucket.empty())
+        return {};
+
+    return m_entities.at(*bucket.rbegin()).entity;
 }
 
 }
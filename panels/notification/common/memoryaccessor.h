@@ -1,13 +1,17 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include <QHash>
 #include <QList>
 #include <QMutex>
 #include <QString>
 
+#include <map>
+#include <set>
+
 #include "dataaccessor.h"
 
 namespace notification
@@ -25,19 +29,49 @@ public:
     virtual NotifyEntity fetchEntity(qint64 id) override;
 
     virtual int fetchEntityCount(const QString &appName, int processedType) const override;
+    virtual QHash<QString, int> fetchEntityCounts(int processedType) const override;
     virtual NotifyEntity fetchLastEntity(const QString &appName, int processedType) override;
     virtual NotifyEntity fetchLastEntity(uint notifyId) override;
     virtual QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount) override;
+    virtual QList<NotifyEntity> fetchEntities(const QString &appName, int processedType, int maxCount, qint64 cursorTime, qint64 cursorId) override;
     virtual QList<QString> fetchApps(int maxCount) const override;
+    virtual QList<NotifyEntity> search(const QString &query, const QString &appName, int maxCount, qint64 cursor) override;
 
     virtual void removeEntity(qint64 id) override;
     virtual void removeEntityByApp(const QString &appName) override;
     virtual void removeEntitiesByExpiredTime(qint64 expiredTime) override;
     virtual void clear() override;
 
+    virtual void setRemovedHandler(const std::function<void(const QList<EntityCount> &)> &handler) override;
+
+private:
+    // the keys an entity is indexed by, entities are shared so they're not read back from it.
+    struct Item
+    {
+        NotifyEntity entity;
+        qint64 id = NotifyEntity::InvalidId;
+        QString appName;
+        int processedType = NotifyEntity::None;
+        uint bubbleId = 0;
+    };
+    // sequences of entities in insertion order.
+    using Bucket = std::set<quint64>;
+    using AppKey = QPair<QString, int>;
+
+    void insertItem(quint64 sequence, const NotifyEntity &entity);
+    void removeItem(quint64 sequence);
+    NotifyEntity lastEntity(const Bucket &bucket) const;
+
 private:
-    QList<NotifyEntity> m_entities;
+    // replaced entities keep the position of the original one.
+    std::map<quint64, Item> m_entities;
+    QHash<qint64, quint64> m_idIndex;
+    QHash<uint, Bucket> m_bubbleIndex;
+    QHash<AppKey, Bucket> m_appIndex;
+    QHash<int, Bucket> m_typeIndex;
+    quint64 m_sequence = 0;
     mutable QMutex m_mutex;
+    std::function<void(const QList<EntityCount> &)> m_removedHandler;
 };
 
 }
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "notifyentity.h"
+#include "notifyimagestore.h"
 
 #include <QDateTime>
 #include <QLocale>
@@ -12,10 +13,16 @@
 #include <QBuffer>
 #include <QDBusArgument>
 #include <QRegularExpression>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QMutex>
 
 #include <unicode/reldatefmt.h>
 #include <unicode/smpdtfmt.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 namespace notification {
@@ -27,6 +34,9 @@ Q_LOGGING_CATEGORY(notifyLog, "org.deepin.dde.shell.notification")
 #define LIST_VALUE_SEGMENT (":::")
 
 static const uint NoReplaceId = 0;
+// version of the binary encoding of hints and actions, it's the first element of the encoded array.
+static const int EncodingVersion = 1;
+static const QString ImageDataSignature("(iiibiiay)");
 
 class NotifyData : public QSharedData
 {
@@ -43,6 +53,13 @@ public:
     QString body;
     QStringList actions;
     QVariantMap hints;
+    // encoded hints which are decoded on the first NotifyEntity::hints() call.
+    QByteArray hintsData;
+    bool hintsDecoded = true;
+    // app icon resolved from the hints, it's reset when the hints or the app icon changes.
+    QString resolvedIcon;
+    bool iconResolved = false;
+    QMutex hintsMutex;
     uint bubbleId = 0;
     uint replacesId = NoReplaceId;
     int expireTimeout = 0;
@@ -188,7 +205,9 @@ QString NotifyEntity::appIcon() const
 
 void NotifyEntity::setAppIcon(const QString &appIcon)
 {
+    QMutexLocker locker(&d->hintsMutex);
     d->appIcon = appIcon;
+    d->iconResolved = false;
 }
 
 QStringList NotifyEntity::actions() const
@@ -206,19 +225,57 @@ void NotifyEntity::setActionString(const QString &actionString)
     d->actions = parseAction(actionString);
 }
 
+QByteArray NotifyEntity::actionsData() const
+{
+    return encodeActions(d->actions);
+}
+
+void NotifyEntity::setActionsData(const QByteArray &actionsData)
+{
+    d->actions = decodeActions(actionsData);
+}
+
 QVariantMap NotifyEntity::hints() const
 {
+    QMutexLocker locker(&d->hintsMutex);
+    if (!d->hintsDecoded) {
+        d->hints = decodeHints(d->hintsData);
+        d->hintsDecoded = true;
+    }
     return d->hints;
 }
 
 QString NotifyEntity::hintsString() const
 {
-    return convertHintsToString(d->hints);
+    return convertHintsToString(hints());
 }
 
 void NotifyEntity::setHintString(const QString &hintString)
 {
+    QMutexLocker locker(&d->hintsMutex);
     d->hints = parseHint(hintString);
+    d->hintsData.clear();
+    d->hintsDecoded = true;
+    d->iconResolved = false;
+}
+
+QByteArray NotifyEntity::hintsData() const
+{
+    QMutexLocker locker(&d->hintsMutex);
+    // not decoded yet, it's unchanged since it was set.
+    if (!d->hintsDecoded)
+        return d->hintsData;
+
+    return encodeHints(d->hints);
+}
+
+void NotifyEntity::setHintsData(const QByteArray &hintsData)
+{
+    QMutexLocker locker(&d->hintsMutex);
+    d->hints.clear();
+    d->hintsData = hintsData;
+    d->hintsDecoded = false;
+    d->iconResolved = false;
 }
 
 uint NotifyEntity::replacesId() const
@@ -312,16 +369,10 @@ static inline void copyLineARGB32(QRgb *dst, const char *src, int width)
     }
 }
 
-static QImage decodeImageFromDBusArgument(const QDBusArgument &arg)
+static QImage decodeImageFromRawData(int width, int height, int rowStride, bool hasAlpha, int bitsPerSample, int channels, const QByteArray &pixels)
 {
-    int width, height, rowStride, hasAlpha, bitsPerSample, channels;
-    QByteArray pixels;
-    char *ptr;
-    char *end;
-
-    arg.beginStructure();
-    arg >> width >> height >> rowStride >> hasAlpha >> bitsPerSample >> channels >> pixels;
-    arg.endStructure();
+    const char *ptr;
+    const char *end;
 
 #define SANITY_CHECK(condition) \
 if (!(condition)) { \
@@ -354,7 +405,7 @@ if (!(condition)) { \
     }
 
     QImage image(width, height, format);
-    ptr = pixels.data();
+    ptr = pixels.constData();
     end = ptr + pixels.length();
     for (int y = 0; y < height; ++y, ptr += rowStride) {
         if (ptr + channels * width > end) {
@@ -367,6 +418,19 @@ if (!(condition)) { \
     return image;
 }
 
+static QImage decodeImageFromDBusArgument(const QDBusArgument &arg)
+{
+    int width, height, rowStride, bitsPerSample, channels;
+    bool hasAlpha;
+    QByteArray pixels;
+
+    arg.beginStructure();
+    arg >> width >> height >> rowStride >> hasAlpha >> bitsPerSample >> channels >> pixels;
+    arg.endStructure();
+
+    return decodeImageFromRawData(width, height, rowStride, hasAlpha, bitsPerSample, channels, pixels);
+}
+
 static QString decodeImageToBase64(const QImage &image, const char *format = "PNG")
 {
     QByteArray ba;
@@ -377,6 +441,16 @@ static QString decodeImageToBase64(const QImage &image, const char *format = "PN
     return QString("data:image/%1;base64,%2").arg(QString::fromLatin1(format).toLower()).arg(QString::fromLatin1(ba.toBase64()));
 }
 
+// stores the image once and refers to it by the url of the image provider.
+static QString imageUrlOfImage(const QImage &image)
+{
+    const auto key = NotifyImageStore::instance()->insert(image);
+    if (key.isEmpty())
+        return decodeImageToBase64(image);
+
+    return NotifyImageStore::imageUrl(key);
+}
+
 static QString imagePathOfNotification(const QVariantMap &hints, const QString &appIcon)
 {
     static const QStringList HintsOrder {
@@ -391,12 +465,20 @@ static QString imagePathOfNotification(const QVariantMap &hints, const QString &
         const auto &source = hints[hint];
         if (source.isNull())
             continue;
-        if (source.canConvert<QDBusArgument>()) {
+        if (source.typeId() == QMetaType::QImage) {
+            // image-data decoded from the storage.
+            img = source.value<QImage>();
+            if (!img.isNull())
+                break;
+        } else if (source.canConvert<QDBusArgument>()) {
             img = decodeImageFromDBusArgument(source.value<QDBusArgument>());
             if (!img.isNull())
                 break;
         }
         imageData = source.toString();
+        // image-data stored in the image store.
+        if (!NotifyImageStore::keyOfUrl(imageData).isEmpty())
+            return imageData;
     }
     if (img.isNull()) {
         // check if imageData is a base64 image data.
@@ -406,7 +488,7 @@ static QString imagePathOfNotification(const QVariantMap &hints, const QString &
             return imageData;
         }
     } else {
-        return decodeImageToBase64(img);
+        return imageUrlOfImage(img);
     }
 
     // ui can fallback to application-x-desktop icon.
@@ -415,15 +497,20 @@ static QString imagePathOfNotification(const QVariantMap &hints, const QString &
 
 QString NotifyEntity::appIconResolved() const
 {
-    const QString iconFromHints = imagePathOfNotification(d->hints, d->appIcon);
-    if (!iconFromHints.isEmpty())
-        return iconFromHints;
-
-    if (!d->appIcon.isEmpty()) {
-        return d->appIcon;
+    {
+        QMutexLocker locker(&d->hintsMutex);
+        if (d->iconResolved)
+            return d->resolvedIcon;
     }
 
-    return {};
+    QString icon = imagePathOfNotification(hints(), d->appIcon);
+    if (icon.isEmpty())
+        icon = d->appIcon;
+
+    QMutexLocker locker(&d->hintsMutex);
+    d->resolvedIcon = icon;
+    d->iconResolved = true;
+    return icon;
 }
 
 QString NotifyEntity::convertHintsToString(const QVariantMap &map)
@@ -445,6 +532,8 @@ QString NotifyEntity::convertHintsToString(const QVariantMap &map)
             if (!img.isNull()) {
                 value = decodeImageToBase64(img);
             }
+        } else if (it.value().typeId() == QMetaType::QImage) {
+            value = decodeImageToBase64(it.value().value<QImage>());
         } else {
             value = it.value().toString();
         }
@@ -497,6 +586,301 @@ QVariantMap NotifyEntity::parseHint(const QString &hint)
 
 namespace {
 
+// type of an encoded hint value, the D-Bus type of the value is kept to round-trip it.
+enum HintValueType {
+    VariantHint = 0,
+    StringHint,
+    BoolHint,
+    ByteHint,
+    Int16Hint,
+    UInt16Hint,
+    Int32Hint,
+    UInt32Hint,
+    Int64Hint,
+    UInt64Hint,
+    DoubleHint,
+    StringListHint,
+    ByteArrayHint,
+    ImageHint,
+    // key of the image in NotifyImageStore.
+    ImageKeyHint
+};
+
+QCborMap encodeImage(int width, int height, int rowStride, bool hasAlpha, int bitsPerSample, int channels, const QByteArray &pixels)
+{
+    QCborMap image;
+    image.insert(QLatin1String("width"), width);
+    image.insert(QLatin1String("height"), height);
+    image.insert(QLatin1String("rowStride"), rowStride);
+    image.insert(QLatin1String("hasAlpha"), hasAlpha);
+    image.insert(QLatin1String("bitsPerSample"), bitsPerSample);
+    image.insert(QLatin1String("channels"), channels);
+    image.insert(QLatin1String("pixels"), pixels);
+    return image;
+}
+
+QVariant demarshalValue(const QVariant &value);
+
+// converts a D-Bus argument to plain variants, structures and arrays are lists, dicts are maps.
+QVariant demarshalArgument(const QDBusArgument &arg)
+{
+    switch (arg.currentType()) {
+    case QDBusArgument::StructureType: {
+        QVariantList fields;
+        arg.beginStructure();
+        while (!arg.atEnd()) {
+            fields << demarshalValue(arg.asVariant());
+        }
+        arg.endStructure();
+        return fields;
+    }
+    case QDBusArgument::ArrayType: {
+        // byte and string arrays are demarshalled to QByteArray and QStringList.
+        const auto signature = arg.currentSignature();
+        if (signature == QLatin1String("ay") || signature == QLatin1String("as"))
+            return arg.asVariant();
+
+        QVariantList items;
+        arg.beginArray();
+        while (!arg.atEnd()) {
+            items << demarshalValue(arg.asVariant());
+        }
+        arg.endArray();
+        return items;
+    }
+    case QDBusArgument::MapType: {
+        QVariantMap map;
+        arg.beginMap();
+        while (!arg.atEnd()) {
+            arg.beginMapEntry();
+            const auto key = demarshalValue(arg.asVariant());
+            const auto value = demarshalValue(arg.asVariant());
+            arg.endMapEntry();
+            map.insert(key.toString(), value);
+        }
+        arg.endMap();
+        return map;
+    }
+    default:
+        return demarshalValue(arg.asVariant());
+    }
+}
+
+QVariant demarshalValue(const QVariant &value)
+{
+    if (value.typeId() == qMetaTypeId<QDBusArgument>())
+        return demarshalArgument(value.value<QDBusArgument>());
+    if (value.typeId() == qMetaTypeId<QDBusVariant>())
+        return demarshalValue(value.value<QDBusVariant>().variant());
+    return value;
+}
+
+QCborValue encodeHintValue(const QVariant &value)
+{
+    const auto tagged = [](HintValueType type, const QCborValue &value) {
+        return QCborValue(QCborArray{static_cast<int>(type), value});
+    };
+
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return tagged(StringHint, value.toString());
+    case QMetaType::Bool:
+        return tagged(BoolHint, value.toBool());
+    case QMetaType::UChar:
+        return tagged(ByteHint, value.toInt());
+    case QMetaType::Short:
+        return tagged(Int16Hint, value.toInt());
+    case QMetaType::UShort:
+        return tagged(UInt16Hint, value.toInt());
+    case QMetaType::Int:
+        return tagged(Int32Hint, value.toInt());
+    case QMetaType::UInt:
+        return tagged(UInt32Hint, static_cast<qint64>(value.toUInt()));
+    case QMetaType::LongLong:
+        return tagged(Int64Hint, value.toLongLong());
+    case QMetaType::ULongLong:
+        return tagged(UInt64Hint, static_cast<qint64>(value.toULongLong()));
+    case QMetaType::Double:
+        return tagged(DoubleHint, value.toDouble());
+    case QMetaType::QStringList:
+        return tagged(StringListHint, QCborArray::fromStringList(value.toStringList()));
+    case QMetaType::QByteArray:
+        return tagged(ByteArrayHint, value.toByteArray());
+    case QMetaType::QImage: {
+        const auto key = NotifyImageStore::instance()->insert(value.value<QImage>());
+        if (!key.isEmpty())
+            return tagged(ImageKeyHint, key);
+
+        const auto image = value.value<QImage>().convertToFormat(QImage::Format_RGBA8888);
+        const QByteArray pixels(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes());
+        return tagged(ImageHint, encodeImage(image.width(), image.height(), image.bytesPerLine(), true, 8, 4, pixels));
+    }
+    default:
+        break;
+    }
+
+    if (value.typeId() == qMetaTypeId<QDBusArgument>()) {
+        const auto arg = value.value<QDBusArgument>();
+        if (arg.currentSignature() != ImageDataSignature) {
+            // other structures, arrays and dicts are kept as plain lists and maps.
+            return tagged(VariantHint, QCborValue::fromVariant(demarshalArgument(arg)));
+        }
+        int width, height, rowStride, bitsPerSample, channels;
+        bool hasAlpha;
+        QByteArray pixels;
+        arg.beginStructure();
+        arg >> width >> height >> rowStride >> hasAlpha >> bitsPerSample >> channels >> pixels;
+        arg.endStructure();
+        const auto key = NotifyImageStore::instance()->insert(decodeImageFromRawData(width, height, rowStride, hasAlpha, bitsPerSample, channels, pixels));
+        if (!key.isEmpty())
+            return tagged(ImageKeyHint, key);
+
+        // keep the raw pixels if the image store isn't available.
+        return tagged(ImageHint, encodeImage(width, height, rowStride, hasAlpha, bitsPerSample, channels, pixels));
+    }
+
+    return tagged(VariantHint, QCborValue::fromVariant(demarshalValue(value)));
+}
+
+QVariant decodeHintValue(const QCborValue &value)
+{
+    const auto array = value.toArray();
+    if (array.size() != 2)
+        return {};
+
+    const auto data = array.at(1);
+    switch (array.at(0).toInteger()) {
+    case StringHint:
+        return data.toString();
+    case BoolHint:
+        return data.toBool();
+    case ByteHint:
+        return QVariant::fromValue(static_cast<uchar>(data.toInteger()));
+    case Int16Hint:
+        return QVariant::fromValue(static_cast<short>(data.toInteger()));
+    case UInt16Hint:
+        return QVariant::fromValue(static_cast<ushort>(data.toInteger()));
+    case Int32Hint:
+        return QVariant::fromValue(static_cast<int>(data.toInteger()));
+    case UInt32Hint:
+        return QVariant::fromValue(static_cast<uint>(data.toInteger()));
+    case Int64Hint:
+        return QVariant::fromValue(static_cast<qint64>(data.toInteger()));
+    case UInt64Hint:
+        return QVariant::fromValue(static_cast<quint64>(data.toInteger()));
+    case DoubleHint:
+        return data.toDouble();
+    case StringListHint: {
+        QStringList list;
+        const auto items = data.toArray();
+        for (const auto &item : items) {
+            list << item.toString();
+        }
+        return list;
+    }
+    case ByteArrayHint:
+        return data.toByteArray();
+    case ImageHint: {
+        const auto image = data.toMap();
+        return decodeImageFromRawData(image.value(QLatin1String("width")).toInteger(),
+                                      image.value(QLatin1String("height")).toInteger(),
+                                      image.value(QLatin1String("rowStride")).toInteger(),
+                                      image.value(QLatin1String("hasAlpha")).toBool(),
+                                      image.value(QLatin1String("bitsPerSample")).toInteger(),
+                                      image.value(QLatin1String("channels")).toInteger(),
+                                      image.value(QLatin1String("pixels")).toByteArray());
+    }
+    case ImageKeyHint: {
+        const auto key = data.toString();
+        if (!NotifyImageStore::instance()->contains(key)) {
+            qDebug(notifyLog) << "The stored image doesn't exist" << key;
+            return {};
+        }
+        return NotifyImageStore::imageUrl(key);
+    }
+    case VariantHint:
+        return data.toVariant();
+    default:
+        break;
+    }
+    return {};
+}
+
+// returns the payload of the encoded data, it's invalid if the data isn't the binary encoding.
+QCborValue decodePayload(const QByteArray &data)
+{
+    QCborParserError error;
+    const auto value = QCborValue::fromCbor(data, &error);
+    if (error.error != QCborError::NoError || !value.isArray())
+        return QCborValue(QCborSimpleType::Undefined);
+
+    const auto array = value.toArray();
+    if (array.size() != 2 || array.at(0).toInteger() != EncodingVersion) {
+        qWarning(notifyLog) << "Unsupported encoding version" << array.at(0).toInteger();
+        return QCborValue(QCborSimpleType::Undefined);
+    }
+    return array.at(1);
+}
+
+} // anonymous namespace
+
+QByteArray NotifyEntity::encodeActions(const QStringList &actions)
+{
+    return QCborValue(QCborArray{EncodingVersion, QCborArray::fromStringList(actions)}).toCbor();
+}
+
+QStringList NotifyEntity::decodeActions(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return {};
+
+    const auto payload = decodePayload(data);
+    if (!payload.isArray()) {
+        // actions stored before the binary encoding was introduced.
+        return parseAction(QString::fromUtf8(data));
+    }
+
+    QStringList actions;
+    const auto array = payload.toArray();
+    for (const auto &item : array) {
+        actions << item.toString();
+    }
+    return actions;
+}
+
+QByteArray NotifyEntity::encodeHints(const QVariantMap &hints)
+{
+    QCborMap map;
+    for (auto iter = hints.constBegin(); iter != hints.constEnd(); ++iter) {
+        const auto value = encodeHintValue(iter.value());
+        if (value.isUndefined())
+            continue;
+        map.insert(iter.key(), value);
+    }
+    return QCborValue(QCborArray{EncodingVersion, map}).toCbor();
+}
+
+QVariantMap NotifyEntity::decodeHints(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return {};
+
+    const auto payload = decodePayload(data);
+    if (!payload.isMap()) {
+        // hints stored before the binary encoding was introduced.
+        return parseHint(QString::fromUtf8(data));
+    }
+
+    QVariantMap hints;
+    const auto map = payload.toMap();
+    for (auto iter = map.constBegin(); iter != map.constEnd(); ++iter) {
+        hints.insert(iter.key().toString(), decodeHintValue(iter.value()));
+    }
+    return hints;
+}
+
+namespace {
+
 QString toQString(const icu::UnicodeString &icuString)
 {
     const UChar *ucharData = icuString.getBuffer();
@@ -560,4 +944,28 @@ QString NotifyEntity::formatRelativeTime(qint64 ctimeMs)
     }
 }
 
+qint64 NotifyEntity::nextRelativeTimeChange(qint64 ctimeMs, qint64 currentMs)
+{
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(ctimeMs);
+    if (!time.isValid())
+        return std::numeric_limits<qint64>::max();
+
+    // it's the same as formatRelativeTime, a date is shown after a week.
+    const QDateTime current = QDateTime::fromMSecsSinceEpoch(currentMs);
+    const auto elapsedDay = time.daysTo(current);
+    if (elapsedDay >= 7)
+        return std::numeric_limits<qint64>::max();
+
+    // labels of days change at midnight.
+    qint64 ret = QDateTime(current.date().addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+    if (elapsedDay <= 0) {
+        static const qint64 MinuteMSecs = 60 * 1000;
+        static const qint64 HourMSecs = 60 * MinuteMSecs;
+        const qint64 msec = std::max<qint64>(currentMs - ctimeMs, 0);
+        const qint64 unit = msec < HourMSecs ? MinuteMSecs : HourMSecs;
+        ret = std::min(ret, ctimeMs + (msec / unit + 1) * unit);
+    }
+    return ret;
+}
+
 }
@@ -72,10 +72,17 @@ public:
     QStringList actions() const;
     QString actionsString() const;
     void setActionString(const QString &actionString);
+    // versioned binary encoding of actions, it's used for storage.
+    QByteArray actionsData() const;
+    void setActionsData(const QByteArray &actionsData);
 
     QVariantMap hints() const;
     QString hintsString() const;
     void setHintString(const QString &hintString);
+    // versioned binary encoding of hints, it keeps the D-Bus type of values and image-data.
+    // hints set by it are only decoded when hints() is called.
+    QByteArray hintsData() const;
+    void setHintsData(const QByteArray &hintsData);
 
     uint replacesId() const;
     void setReplacesId(uint replacesId);
@@ -94,18 +101,26 @@ public:
     QString bodyIcon() const;
 
     // Resolves the app icon considering image-data/icon_data hints from the notification spec.
-    // Returns a base64 data URI if image-data/icon_data hint is present, otherwise returns appIcon.
+    // Returns an image://notification/ url of NotifyImageStore if image-data/icon_data hint is present,
+    // otherwise returns appIcon. The result is cached until the hints or appIcon changes.
     QString appIconResolved() const;
 
     // Formats a creation time (ms since epoch) as a locale-aware relative
     // time string. Returns empty string if less than 1 minute or invalid.
     static QString formatRelativeTime(qint64 ctimeMs);
+    // the next time (ms since epoch) after currentMs that the relative time of ctimeMs changes,
+    // returns max of qint64 if it doesn't change anymore.
+    static qint64 nextRelativeTimeChange(qint64 ctimeMs, qint64 currentMs);
 
 private:
     static QString convertHintsToString(const QVariantMap &map);
     static QString convertActionsToString(const QStringList &actions);
     static QStringList parseAction(const QString &actions);
     static QVariantMap parseHint(const QString &hints);
+    static QByteArray encodeActions(const QStringList &actions);
+    static QStringList decodeActions(const QByteArray &data);
+    static QByteArray encodeHints(const QVariantMap &hints);
+    static QVariantMap decodeHints(const QByteArray &data);
 
 private:
     QExplicitlySharedDataPointer<NotifyData> d;
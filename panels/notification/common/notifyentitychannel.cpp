@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifyentitychannel.h"
+
+namespace notification
+{
+
+// state changes are consumed right after they're announced, only the recent ones are kept.
+static const int MaxEntityCount = 64;
+
+NotifyEntityChannel *NotifyEntityChannel::instance()
+{
+    static NotifyEntityChannel *gInstance = nullptr;
+    static QMutex gMutex;
+    QMutexLocker locker(&gMutex);
+    if (!gInstance) {
+        gInstance = new NotifyEntityChannel();
+    }
+    return gInstance;
+}
+
+void NotifyEntityChannel::publish(const NotifyEntity &entity)
+{
+    if (!entity.isValid())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_entities.contains(entity.id()))
+        m_ids.enqueue(entity.id());
+    m_entities.insert(entity.id(), entity);
+
+    while (m_ids.size() > MaxEntityCount) {
+        m_entities.remove(m_ids.dequeue());
+    }
+}
+
+NotifyEntity NotifyEntityChannel::find(qint64 id, int processedType) const
+{
+    QMutexLocker locker(&m_mutex);
+    const auto entity = m_entities.value(id);
+    if (!entity.isValid() || entity.processedType() != processedType)
+        return {};
+
+    return entity;
+}
+
+}
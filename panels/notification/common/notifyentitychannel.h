@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+
+#include "notifyentity.h"
+
+namespace notification
+{
+
+// Hands the entities of state changes from the server to the applets in the same process,
+// receivers only read the store when the entity isn't here, e.g. the server is in another process.
+class NotifyEntityChannel
+{
+public:
+    static NotifyEntityChannel *instance();
+
+    // it's called before the state change is announced.
+    void publish(const NotifyEntity &entity);
+    // returns an invalid entity if it isn't published or its state has changed since.
+    NotifyEntity find(qint64 id, int processedType) const;
+
+private:
+    NotifyEntityChannel() = default;
+
+private:
+    mutable QMutex m_mutex;
+    QHash<qint64, NotifyEntity> m_entities;
+    // publish order of the ids, the oldest ones are evicted.
+    QQueue<qint64> m_ids;
+};
+
+}
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifyimageprovider.h"
+#include "notifyimagestore.h"
+
+#include <QQmlEngine>
+
+namespace notification
+{
+
+NotifyImageProvider::NotifyImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage NotifyImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    QImage image = NotifyImageStore::instance()->image(id);
+    if (size)
+        *size = image.size();
+
+    if (!image.isNull() && !requestedSize.isEmpty() && requestedSize != image.size()) {
+        image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+void NotifyImageProvider::registerTo(QQmlEngine *engine)
+{
+    if (!engine || engine->imageProvider(NotifyImageStore::providerId()))
+        return;
+
+    engine->addImageProvider(NotifyImageStore::providerId(), new NotifyImageProvider());
+}
+
+}
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QQuickImageProvider>
+
+class QQmlEngine;
+namespace notification
+{
+
+// Serves the images of NotifyImageStore as image://notification/<key>.
+class NotifyImageProvider : public QQuickImageProvider
+{
+public:
+    NotifyImageProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    // registers the provider to the engine if it's not registered.
+    static void registerTo(QQmlEngine *engine);
+};
+
+}
@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifyimagestore.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace notification {
+Q_DECLARE_LOGGING_CATEGORY(notifyLog)
+}
+
+namespace notification
+{
+
+static const QString ProviderId("notification");
+static const QString ImageUrlPrefix(QString("image://%1/").arg(ProviderId));
+// cost of the decoded images kept in memory, in KiB.
+static const int ImageCacheCost = 16 * 1024;
+// unused images inserted within this time aren't removed.
+static const qint64 UnusedImageGraceMSecs = 24 * 60 * 60 * 1000;
+
+static QString notificationImageDir()
+{
+    if (qEnvironmentVariableIsSet("DS_NOTIFICATION_IMAGE_PATH"))
+        return qEnvironmentVariable("DS_NOTIFICATION_IMAGE_PATH");
+
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation);
+    const auto subDir = QString("%1/%2/images").arg(qApp->organizationName()).arg(qApp->applicationName());
+    return QDir(dataDir).absoluteFilePath(subDir);
+}
+
+// keys are sha1 hex digests, other ids requested by qml are rejected.
+static bool isValidKey(const QString &key)
+{
+    static const QRegularExpression pattern("^[0-9a-f]{40}$");
+    return pattern.match(key).hasMatch();
+}
+
+static int imageCost(const QImage &image)
+{
+    return static_cast<int>(image.sizeInBytes() / 1024) + 1;
+}
+
+NotifyImageStore::NotifyImageStore()
+    : m_dir(notificationImageDir())
+    , m_images(ImageCacheCost)
+{
+    if (!QDir().mkpath(m_dir)) {
+        qWarning(notifyLog) << "Failed on creating the image dir:" << m_dir;
+        m_dir.clear();
+    }
+    // pending images are written one batch at a time.
+    m_pool.setMaxThreadCount(1);
+}
+
+NotifyImageStore *NotifyImageStore::instance()
+{
+    static NotifyImageStore *gInstance = nullptr;
+    static QMutex gMutex;
+    QMutexLocker locker(&gMutex);
+    if (!gInstance) {
+        gInstance = new NotifyImageStore();
+    }
+    return gInstance;
+}
+
+QString NotifyImageStore::providerId()
+{
+    return ProviderId;
+}
+
+QString NotifyImageStore::imageUrl(const QString &key)
+{
+    return ImageUrlPrefix + key;
+}
+
+QString NotifyImageStore::keyOfUrl(const QString &url)
+{
+    if (!url.startsWith(ImageUrlPrefix))
+        return {};
+
+    return url.mid(ImageUrlPrefix.size());
+}
+
+QString NotifyImageStore::insert(const QImage &image)
+{
+    if (image.isNull() || m_dir.isEmpty())
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const int header[] = {image.width(), image.height(), image.format()};
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(header), sizeof(header)));
+    // the padding at the end of the scanlines isn't initialized, only the pixels are hashed.
+    const qsizetype rowBytes = (static_cast<qsizetype>(image.width()) * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y) {
+        hash.addData(QByteArrayView(reinterpret_cast<const char *>(image.constScanLine(y)), rowBytes));
+    }
+    const QString key = QString::fromLatin1(hash.result().toHex());
+
+    QMutexLocker locker(&m_mutex);
+    m_insertTimes.insert(key, QDateTime::currentMSecsSinceEpoch());
+    if (m_storedKeys.contains(key) || m_pendingImages.contains(key))
+        return key;
+
+    // encoding is slow, it's done by the storage thread before the rows referring to it are committed,
+    // or by the store's thread for the images of the notifications which aren't stored.
+    m_pendingImages.insert(key, image);
+    m_images.insert(key, new QImage(image), imageCost(image));
+    if (!m_saveScheduled) {
+        m_saveScheduled = true;
+        m_pool.start([this]() {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_saveScheduled = false;
+            }
+            savePendingImages();
+        });
+    }
+    return key;
+}
+
+void NotifyImageStore::savePendingImages()
+{
+    QHash<QString, QImage> images;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pendingImages.isEmpty())
+            return;
+        images = m_pendingImages;
+    }
+
+    // the images are still served from memory while they're written.
+    QSet<QString> savedKeys;
+    for (auto iter = images.cbegin(); iter != images.cend(); ++iter) {
+        const auto path = filePath(iter.key());
+        if (!QFileInfo::exists(path)) {
+            // write to a temporary file, a partial image is never visible to readers.
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || !iter.value().save(&file, "PNG") || !file.commit()) {
+                qWarning(notifyLog) << "Failed on storing the image:" << path << ", error:" << file.errorString();
+                continue;
+            }
+        }
+        savedKeys.insert(iter.key());
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (auto iter = images.cbegin(); iter != images.cend(); ++iter) {
+        // an image failing to be written isn't retried, the notification falls back to its app icon.
+        m_pendingImages.remove(iter.key());
+    }
+    m_storedKeys.unite(savedKeys);
+}
+
+int NotifyImageStore::removeUnusedImages(const QSet<QString> &usedKeys)
+{
+    if (m_dir.isEmpty())
+        return 0;
+
+    const auto files = QDir(m_dir).entryList({"*.png"}, QDir::Files);
+    const auto graceTime = QDateTime::currentMSecsSinceEpoch() - UnusedImageGraceMSecs;
+
+    QMutexLocker locker(&m_mutex);
+    for (auto iter = m_insertTimes.begin(); iter != m_insertTimes.end();) {
+        if (iter.value() < graceTime) {
+            iter = m_insertTimes.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    int removedCount = 0;
+    for (const auto &file : files) {
+        const auto key = QFileInfo(file).completeBaseName();
+        if (!isValidKey(key) || usedKeys.contains(key) || m_insertTimes.contains(key) || m_pendingImages.contains(key))
+            continue;
+
+        // the lock is held, an image inserted again meanwhile is written again.
+        if (!QFile::remove(filePath(key))) {
+            qWarning(notifyLog) << "Failed on removing the unused image:" << key;
+            continue;
+        }
+        m_storedKeys.remove(key);
+        m_images.remove(key);
+        ++removedCount;
+    }
+    return removedCount;
+}
+
+QImage NotifyImageStore::image(const QString &key)
+{
+    if (!isValidKey(key))
+        return {};
+
+    QMutexLocker locker(&m_mutex);
+    if (auto image = m_images.object(key))
+        return *image;
+
+    auto pending = m_pendingImages.constFind(key);
+    if (pending != m_pendingImages.constEnd())
+        return pending.value();
+
+    QImage image(filePath(key));
+    if (image.isNull()) {
+        qWarning(notifyLog) << "Failed on loading the image:" << key;
+        return {};
+    }
+    m_storedKeys.insert(key);
+    m_images.insert(key, new QImage(image), imageCost(image));
+    return image;
+}
+
+bool NotifyImageStore::contains(const QString &key)
+{
+    if (!isValidKey(key))
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_storedKeys.contains(key) || m_pendingImages.contains(key))
+        return true;
+
+    if (!QFileInfo::exists(filePath(key)))
+        return false;
+
+    m_storedKeys.insert(key);
+    return true;
+}
+
+QString NotifyImageStore::filePath(const QString &key) const
+{
+    return QDir(m_dir).absoluteFilePath(key + ".png");
+}
+
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+namespace notification
+{
+
+// Content-addressed storage of the images carried by notifications,
+// every image is saved once under the notification data dir and is referenced by its hash.
+class NotifyImageStore
+{
+public:
+    static NotifyImageStore *instance();
+
+    // id of the image provider serving the stored images to qml.
+    static QString providerId();
+    static QString imageUrl(const QString &key);
+    static QString keyOfUrl(const QString &url);
+
+    // returns the key of the image, it's empty if the image can't be stored,
+    // the image is kept in memory until savePendingImages() writes it, it's scheduled by the store as well.
+    QString insert(const QImage &image);
+    QImage image(const QString &key);
+    bool contains(const QString &key);
+
+    // encodes and writes the inserted images, it's called by the storage thread before rows referring to them
+    // are committed, images of the notifications which aren't stored are written by the store's own thread.
+    void savePendingImages();
+    // removes the stored images whose keys aren't used, returns count of the removed images,
+    // images inserted recently are kept, notifications which aren't stored yet may refer to them.
+    int removeUnusedImages(const QSet<QString> &usedKeys);
+
+private:
+    NotifyImageStore();
+    QString filePath(const QString &key) const;
+
+private:
+    QString m_dir;
+    QMutex m_mutex;
+    QSet<QString> m_storedKeys;
+    QHash<QString, QImage> m_pendingImages;
+    // last time each key is inserted by this process.
+    QHash<QString, qint64> m_insertTimes;
+    QCache<QString, QImage> m_images;
+    bool m_saveScheduled = false;
+    QThreadPool m_pool;
+};
+
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifytimeticker.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+
+namespace notification
+{
+
+static const qint64 NoDeadline = std::numeric_limits<qint64>::max();
+
+NotifyTimeTicker::NotifyTimeTicker(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    // labels change at whole minutes, a coarse timer may fire a bit early.
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &NotifyTimeTicker::onTimeout);
+}
+
+NotifyTimeTicker *NotifyTimeTicker::instance()
+{
+    static NotifyTimeTicker *gInstance = nullptr;
+    if (!gInstance) {
+        gInstance = new NotifyTimeTicker(qApp);
+    }
+    return gInstance;
+}
+
+void NotifyTimeTicker::attach(QObject *client, Tick tick)
+{
+    Client item;
+    item.tick = std::move(tick);
+    item.deadline = NoDeadline;
+    m_clients.insert(client, item);
+    connect(client, &QObject::destroyed, this, [this, client] {
+        detach(client);
+    });
+}
+
+void NotifyTimeTicker::detach(QObject *client)
+{
+    if (m_clients.remove(client) > 0) {
+        disconnect(client, &QObject::destroyed, this, nullptr);
+        restart();
+    }
+}
+
+void NotifyTimeTicker::schedule(QObject *client, qint64 deadline)
+{
+    auto iter = m_clients.find(client);
+    if (iter == m_clients.end() || deadline >= iter->deadline)
+        return;
+
+    iter->deadline = deadline;
+    restart();
+}
+
+void NotifyTimeTicker::cancel(QObject *client)
+{
+    auto iter = m_clients.find(client);
+    if (iter == m_clients.end() || iter->deadline == NoDeadline)
+        return;
+
+    iter->deadline = NoDeadline;
+    restart();
+}
+
+void NotifyTimeTicker::onTimeout()
+{
+    const auto current = QDateTime::currentMSecsSinceEpoch();
+    // a client may be detached in its tick.
+    const auto clients = m_clients.keys();
+    for (auto client : clients) {
+        auto iter = m_clients.find(client);
+        if (iter == m_clients.end() || iter->deadline > current)
+            continue;
+
+        const auto tick = iter->tick;
+        const auto deadline = tick(current);
+        iter = m_clients.find(client);
+        if (iter != m_clients.end()) {
+            iter->deadline = deadline;
+        }
+    }
+    restart();
+}
+
+void NotifyTimeTicker::restart()
+{
+    qint64 deadline = NoDeadline;
+    for (const auto &item : std::as_const(m_clients)) {
+        deadline = std::min(deadline, item.deadline);
+    }
+
+    if (deadline == NoDeadline) {
+        m_timer->stop();
+        return;
+    }
+
+    const auto interval = deadline - QDateTime::currentMSecsSinceEpoch();
+    m_timer->start(static_cast<int>(std::clamp<qint64>(interval, 0, std::numeric_limits<int>::max())));
+}
+
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+
+#include <functional>
+
+class QTimer;
+
+namespace notification
+{
+
+// Shared ticker of the relative time labels, e.g. "1 minute ago",
+// it only wakes up at the instant the earliest label of the visible rows changes, and stops if there isn't any.
+class NotifyTimeTicker : public QObject
+{
+    Q_OBJECT
+public:
+    // updates the labels changed at the current time (ms since epoch),
+    // returns the next time any label of the client changes, it's max of qint64 if there isn't any.
+    using Tick = std::function<qint64(qint64 current)>;
+
+    static NotifyTimeTicker *instance();
+
+    // it's called in the gui thread, the client is detached when it's destroyed.
+    void attach(QObject *client, Tick tick);
+    void detach(QObject *client);
+    // ticks the client at the deadline if it's earlier than the scheduled one.
+    void schedule(QObject *client, qint64 deadline);
+    void cancel(QObject *client);
+
+private:
+    explicit NotifyTimeTicker(QObject *parent = nullptr);
+    void onTimeout();
+    void restart();
+
+private:
+    struct Client
+    {
+        Tick tick;
+        qint64 deadline = 0;
+    };
+    QTimer *m_timer = nullptr;
+    QHash<QObject *, Client> m_clients;
+};
+
+}
@@ -198,17 +198,35 @@ NotifyItem {
                 value: 26 + NotifyStyle.contentItem.topMargin + NotifyStyle.contentItem.bottomMargin
             }
 
-            DciIcon {
+            Loader {
                 id: appIcon
-                name: root.iconName !== "" ? root.iconName : "application-x-desktop"
-                sourceSize: Qt.size(24, 24)
+                // images of notifications are served by the image provider, others are icon names.
+                sourceComponent: root.iconName.startsWith("image://") ? imageIconComponent : dciIconComponent
                 implicitWidth: 24
                 implicitHeight: 24
                 Layout.alignment: Qt.AlignLeft | Qt.AlignTop
                 Layout.topMargin: 8
                 Layout.leftMargin: 10
-                palette: DTK.makeIconPalette(impl.palette)
-                theme: impl.ColorSelector.controlTheme
+
+                Component {
+                    id: dciIconComponent
+                    DciIcon {
+                        name: root.iconName !== "" ? root.iconName : "application-x-desktop"
+                        sourceSize: Qt.size(24, 24)
+                        palette: DTK.makeIconPalette(impl.palette)
+                        theme: impl.ColorSelector.controlTheme
+                    }
+                }
+
+                Component {
+                    id: imageIconComponent
+                    Image {
+                        source: root.iconName
+                        sourceSize: Qt.size(24, 24)
+                        fillMode: Image.PreserveAspectFit
+                        asynchronous: true
+                    }
+                }
             }
 
             ColumnLayout {
@@ -4,6 +4,7 @@
 
 #include "dbusadaptor.h"
 #include "notificationmanager.h"
+#include "notifytrace.h"
 
 #include <QDBusConnection>
 #include <QDBusMessage>
@@ -101,6 +102,26 @@ uint DDENotificationDbusAdaptor::recordCount() const
     return manager()->recordCount();
 }
 
+qulonglong DDENotificationDbusAdaptor::coalescedCount() const
+{
+    return manager()->coalescedCount();
+}
+
+qulonglong DDENotificationDbusAdaptor::droppedCount() const
+{
+    return manager()->droppedCount();
+}
+
+qulonglong DDENotificationDbusAdaptor::statementCacheHits() const
+{
+    return manager()->statementCacheHits();
+}
+
+qulonglong DDENotificationDbusAdaptor::statementCacheMisses() const
+{
+    return manager()->statementCacheMisses();
+}
+
 QStringList DDENotificationDbusAdaptor::GetAppList()
 {
     return manager()->GetAppList();
@@ -137,4 +158,19 @@ QDBusVariant DDENotificationDbusAdaptor::GetSystemInfo(uint configItem)
     return QDBusVariant(manager()->GetSystemInfo(configItem));
 }
 
+NotifyTraceDbusAdaptor::NotifyTraceDbusAdaptor(QObject *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+}
+
+QString NotifyTraceDbusAdaptor::DumpTrace()
+{
+    return NotifyTrace::instance()->dump();
+}
+
+bool NotifyTraceDbusAdaptor::SetTraceSampling(const QString &category, uint every)
+{
+    return NotifyTrace::instance()->setSampling(category, every);
+}
+
 } // notification
@@ -39,6 +39,10 @@ class DDENotificationDbusAdaptor : public QDBusAbstractAdaptor
 {
     Q_OBJECT
     Q_PROPERTY(uint recordCount READ recordCount NOTIFY RecordCountChanged)
+    Q_PROPERTY(qulonglong coalescedCount READ coalescedCount)
+    Q_PROPERTY(qulonglong droppedCount READ droppedCount)
+    Q_PROPERTY(qulonglong statementCacheHits READ statementCacheHits)
+    Q_PROPERTY(qulonglong statementCacheMisses READ statementCacheMisses)
     Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.Notification1")
 
 public:
@@ -58,6 +62,10 @@ Q_SIGNALS:
 
 public Q_SLOTS: // methods
     uint recordCount() const;
+    qulonglong coalescedCount() const;
+    qulonglong droppedCount() const;
+    qulonglong statementCacheHits() const;
+    qulonglong statementCacheMisses() const;
 
     QStringList GetAppList();
     QDBusVariant GetAppInfo(const QString &appId, uint configItem);
@@ -85,4 +93,18 @@ Q_SIGNALS:
     void RecordCountChanged(uint count);
 };
 
+// debug methods of the trace of the server, it's only exported if notificationTraceEnabled is set.
+class NotifyTraceDbusAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.Notification1.Trace")
+
+public:
+    explicit NotifyTraceDbusAdaptor(QObject *parent = nullptr);
+
+public Q_SLOTS: // methods
+    QString DumpTrace();
+    bool SetTraceSampling(const QString &category, uint every);
+};
+
 } // notification
@@ -7,6 +7,8 @@
 #include "dbaccessor.h"
 #include "notificationsetting.h"
 #include "notifyentity.h"
+#include "notifyentitychannel.h"
+#include "notifytrace.h"
 
 #include <DDesktopServices>
 #include <DSGApplication>
@@ -16,6 +18,7 @@
 
 #include <QAbstractItemModel>
 #include <QDBusInterface>
+#include <QDBusServiceWatcher>
 #include <QProcess>
 #include <QTimer>
 #include <QLoggingCategory>
@@ -39,24 +42,57 @@ namespace notification {
 static const uint NoReplacesId = 0;
 static const int DefaultTimeOutMSecs = 5000;
 static const int BlockItemTimeout = 1000;
+static const int CompactIntervalMSecs = 60 * 60 * 1000;
+// the periodic compaction is skipped if a notification is received in this interval.
+static const int CompactQuietMSecs = 5 * 60 * 1000;
+// notifications throttled in this interval are merged into one summary of the app.
+static const int CoalesceIntervalMSecs = 1000;
+static const int MaxRateBuckets = 256;
 static const QString NotificationsDBusService = "org.freedesktop.Notifications";
 static const QString NotificationsDBusPath = "/org/freedesktop/Notifications";
 static const QString DDENotifyDBusServer = "org.deepin.dde.Notification1";
 static const QString DDENotifyDBusPath = "/org/deepin/dde/Notification1";
 static const QString SessionDBusService = "org.deepin.dde.SessionManager1";
 static const QString SessionDaemonDBusPath = "/org/deepin/dde/SessionManager1";
+static const QString ScreenSaverDBusService = "org.freedesktop.ScreenSaver";
+static const QString ScreenSaverDBusPath = "/org/freedesktop/ScreenSaver";
 
 NotificationManager::NotificationManager(QObject *parent)
     : QObject(parent)
     , m_persistence(DataAccessorProxy::instance())
     , m_setting(new NotificationSetting(this))
     , m_pendingTimeout(new QTimer(this))
+    , m_compactTimer(new QTimer(this))
+    , m_senderWatcher(new QDBusServiceWatcher(this))
+    , m_coalesceTimer(new QTimer(this))
 {
     m_pendingTimeout->setSingleShot(true);
     connect(m_pendingTimeout, &QTimer::timeout, this, &NotificationManager::onHandingPendingEntities);
+    // the history is trimmed in the background periodically while notifications aren't arriving,
+    // the database is only rebuilt when the screen is locked or the session is idle.
+    m_compactTimer->setInterval(CompactIntervalMSecs);
+    connect(m_compactTimer, &QTimer::timeout, this, [this] {
+        if (m_rateClock.elapsed() - m_lastNotifyPoint < CompactQuietMSecs) {
+            qDebug(notifyLog) << "Skip compacting, notifications are arriving";
+            return;
+        }
+        m_persistence->compact(false);
+    });
+
+    m_coalesceTimer->setSingleShot(true);
+    m_coalesceTimer->setInterval(CoalesceIntervalMSecs);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &NotificationManager::onCoalesceTimeout);
+    m_rateClock.start();
 
     DataAccessorProxy::instance()->setSource(DBAccessor::instance());
 
+    m_senderWatcher->setConnection(QDBusConnection::sessionBus());
+    m_senderWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_senderWatcher, &QDBusServiceWatcher::serviceUnregistered, this, [this](const QString &service) {
+        m_senderAppIds.remove(service);
+        m_senderWatcher->removeWatchedService(service);
+    });
+
     DAppletBridge bridge("org.deepin.ds.dde-apps");
     if (auto apps = bridge.applet()) {
         if (auto model = apps->property("appModel").value<QAbstractItemModel *>()) {
@@ -82,10 +118,26 @@ NotificationManager::NotificationManager(QObject *parent)
     if(!config->value("notificationCleanupDays").isNull()) {
         m_cleanupDays = config->value("notificationCleanupDays").toInt();
     } 
+    RetentionPolicy policy;
+    policy.maxCount = config->value("notificationMaxRecords", 0).toInt();
+    policy.maxBytes = config->value("notificationMaxBytes", 0).toLongLong();
+    policy.maxAgeMSecs = qint64(m_cleanupDays) * 24 * 60 * 60 * 1000;
+    m_persistence->setRetentionPolicy(policy);
+    m_persistence->setRemovedHandler([this](const QList<EntityCount> &) {
+        // called in the storage thread.
+        QMetaObject::invokeMethod(this, &NotificationManager::emitRecordCountChanged, Qt::QueuedConnection);
+    });
+    m_compactTimer->start();
+    m_rateLimit = config->value("notificationRateLimit", 0).toDouble();
+    m_rateBurst = config->value("notificationRateBurst", 0).toInt();
+    m_traceEnabled = config->value("notificationTraceEnabled", false).toBool();
+
     if (QStringLiteral("wayland") != QGuiApplication::platformName() 
         && !QGuiApplication::platformName().isEmpty()) { // for unit test, Subsequent migration to the login1 interface
         initScreenLockedState();
     }
+    QDBusConnection::sessionBus().connect(ScreenSaverDBusService, ScreenSaverDBusPath, ScreenSaverDBusService,
+        "ActiveChanged", this, SLOT(onSessionIdleChanged(bool)));
 }
 
 NotificationManager::~NotificationManager()
@@ -120,7 +172,7 @@ uint NotificationManager::recordCount() const
 
 void NotificationManager::actionInvoked(qint64 id, const QString &actionKey)
 {
-    qInfo(notifyLog) << "Action invoked, id:" << id << ", actionKey" << actionKey;
+    NotifyTrace::instance()->entity(NotifyTrace::ActionCategory, id, 0);
     auto entity = m_persistence->fetchEntity(id);
     if (entity.isValid()) {
         doActionInvoked(entity, actionKey);
@@ -132,7 +184,7 @@ void NotificationManager::actionInvoked(qint64 id, const QString &actionKey)
 
 void NotificationManager::actionInvoked(qint64 id, uint bubbleId, const QString &actionKey)
 {
-    qInfo(notifyLog) << "Action invoked, bubbleId:" << bubbleId << ", id:" << id << ", actionKey" << actionKey;
+    qDebug(notifyLog) << "Action invoked, bubbleId:" << bubbleId << ", id:" << id << ", actionKey" << actionKey;
     actionInvoked(id, actionKey);
 
     if (isExtendedAction(id, actionKey)) {
@@ -164,6 +216,7 @@ void NotificationManager::actionInvoked(qint64 id, uint bubbleId, const QString
 void NotificationManager::notificationClosed(qint64 id, uint bubbleId, uint reason)
 {
     qDebug(notifyLog) << "Close notification id" << id << ", reason" << reason;
+    NotifyTrace::instance()->entity(NotifyTrace::ClosedCategory, id, bubbleId, static_cast<int>(reason));
     updateEntityProcessed(id, reason);
 
     Q_EMIT NotificationClosed(bubbleId, reason);
@@ -200,6 +253,7 @@ void NotificationManager::removeExpiredNotifications()
     qDebug(notifyLog) << "Remove expired notifications.";
     const qint64 cutoffTime = QDateTime::currentDateTime().addDays(-m_cleanupDays).toMSecsSinceEpoch();
     m_persistence->removeEntitiesByExpiredTime(cutoffTime);
+    m_persistence->compact(false);
 
     emitRecordCountChanged();
 }
@@ -216,11 +270,12 @@ uint NotificationManager::Notify(const QString &appName, uint replacesId, const
                                  const QString &body, const QStringList &actions, const QVariantMap &hints,
                                  int expireTimeout)
 {
-    qInfo(notifyLog) << "Notify"
-                     << ", appName:" << appName << ", summary:" << summary << ", appIcon:" << appIcon << ", body size:" << body.size()
-                     << ", actions:" << actions << ", hint: " << hints << ", replaceId:" << replacesId << ", expireTimeout:" << expireTimeout;
+    // the hints may carry images, only a capped record of them is traced.
+    NotifyTrace::instance()->received(appName, replacesId, body, actions, hints, expireTimeout);
+    m_lastNotifyPoint = m_rateClock.elapsed();
 
-    if (calledFromDBus() && m_setting->systemValue(NotificationSetting::CloseNotification).toBool()) {
+    // it's checked before resolving the sender, which is a D-Bus call.
+    if (calledFromDBus() && m_setting->systemPolicy().closeNotification) {
         qDebug(notifyLog) << "Notify has been disabled by CloseNotification setting.";
         return 0;
     }
@@ -228,46 +283,72 @@ uint NotificationManager::Notify(const QString &appName, uint replacesId, const
     QString appId = appIdByAppName(appName);
 
     if (appId.isEmpty() && calledFromDBus()) {
-        QDBusReply<uint> reply = connection().interface()->servicePid(message().service());
-        appId = DSGApplication::getId(reply.value());
+        appId = appIdBySender(message().service());
     }
 
     if (appId.isEmpty())
         appId = appName;
 
-    bool enableAppNotification = m_setting->appValue(appId, NotificationSetting::EnableNotification).toBool();
+    const NotifyArguments arguments{appId, appName, replacesId, appIcon, summary, body, actions, hints, expireTimeout, calledFromDBus()};
+    return deliverNotification(arguments, calledFromDBus());
+}
+
+// the checks are applied again when a throttled notification is delivered, the settings may be changed in between.
+uint NotificationManager::deliverNotification(const NotifyArguments &arguments, bool rateLimited)
+{
+    const auto &appId = arguments.appId;
+    const auto &appName = arguments.appName;
+    const auto replacesId = arguments.replacesId;
+    const auto &hints = arguments.hints;
+    const auto expireTimeout = arguments.expireTimeout;
+
+    const auto systemPolicy = m_setting->systemPolicy();
+    if (arguments.fromDBus && systemPolicy.closeNotification) {
+        qDebug(notifyLog) << "Notify has been disabled by CloseNotification setting.";
+        return 0;
+    }
+
+    // settings of the app are read from one compiled snapshot.
+    const auto policy = m_setting->appPolicy(appId);
+    bool enableAppNotification = policy.enableNotification;
     if (!enableAppNotification && !m_systemApps.contains(appId)) {
         return 0;
     }
 
-    auto tsAppName = m_setting->appValue(appId, NotificationSetting::AppName).toString();
+    if (rateLimited && !acquireRateToken(appId)) {
+        return throttleNotification(arguments);
+    }
+
+    auto tsAppName = policy.appName;
     if (tsAppName.isEmpty()) {
         tsAppName = appName;
     } else {
         qCDebug(notifyLog) << "AppName is translated from AM, which appId is:" << appId;
     }
 
-    QString strBody = body;
+    QString strBody = arguments.body;
     // Unescape backslashes and quotes from %q formatted strings (e.g., \\ -> \, \" -> ", \' -> ')
     strBody.replace(QRegularExpression("\\\\(\\\\|['\"])"), "\\1");
 
-    QString strIcon = appIcon;
+    QString strIcon = arguments.appIcon;
     if (strIcon.isEmpty())
-        strIcon = m_setting->appValue(appId, NotificationSetting::AppIcon).toString();
-    NotifyEntity entity(tsAppName, replacesId, strIcon, summary, strBody, actions, hints, expireTimeout);
+        strIcon = policy.appIcon;
+    NotifyEntity entity(tsAppName, replacesId, strIcon, arguments.summary, strBody, arguments.actions, hints, expireTimeout);
     entity.setAppId(appId);
     entity.setProcessedType(NotifyEntity::None);
     entity.setReplacesId(replacesId);
+    // keys the image of image-data hints for the image provider, it is encoded and written by the storage thread.
+    entity.appIconResolved();
 
     bool lockScreenShow = true;
-    bool dndMode = isDoNotDisturb();
+    bool dndMode = isDoNotDisturb(systemPolicy);
     bool systemNotification = m_systemApps.contains(appId);
     const bool desktopScreen = !m_screenLocked;
 
     if (!systemNotification) {
-        lockScreenShow = m_setting->appValue(appId, NotificationSetting::ShowOnLockScreen).toBool();
+        lockScreenShow = policy.showOnLockScreen;
     }
-    const bool onDesktopShow = m_setting->appValue(appId, NotificationSetting::ShowOnDesktop).toBool();
+    const bool onDesktopShow = policy.showOnDesktop;
 
     // new one
     if (replacesId == NoReplacesId) {
@@ -302,6 +383,7 @@ uint NotificationManager::Notify(const QString &appName, uint replacesId, const
 
         emitRecordCountChanged();
 
+        NotifyEntityChannel::instance()->publish(entity);
         Q_EMIT NotificationStateChanged(entity.id(), entity.processedType());
 
         bool critical = false;
@@ -316,12 +398,38 @@ uint NotificationManager::Notify(const QString &appName, uint replacesId, const
 
     tryPlayNotificationSound(entity, appId, dndMode);
 
-    qInfo(notifyLog) << "Notify done, bubbleId:" << entity.bubbleId() << ", id:" << entity.id() << ", type:" << entity.processedType();
+    NotifyTrace::instance()->entity(NotifyTrace::ShownCategory, entity, entity.processedType());
 
     // If replaces_id is 0, the return value is a UINT32 that represent the notification.
     // If replaces_id is not 0, the returned value is the same value as replaces_id.
     return entity.bubbleId();
 }
+
+quint64 NotificationManager::droppedCount() const
+{
+    return m_droppedCount;
+}
+
+quint64 NotificationManager::statementCacheHits() const
+{
+    return DBAccessor::instance()->statementCacheHits();
+}
+
+quint64 NotificationManager::statementCacheMisses() const
+{
+    return DBAccessor::instance()->statementCacheMisses();
+}
+
+bool NotificationManager::traceEnabled() const
+{
+    return m_traceEnabled;
+}
+
+quint64 NotificationManager::coalescedCount() const
+{
+    return m_coalescedCount;
+}
+
 void NotificationManager::CloseNotification(uint id)
 {
     auto entity = m_persistence->fetchLastEntity(id);
@@ -379,41 +487,39 @@ void NotificationManager::setBlockClosedId(qint64 id)
     }
 
     if(m_blockClosedId != NotifyEntity::InvalidId) {
-        auto findIter = std::find_if(m_pendingTimeoutEntities.begin(), m_pendingTimeoutEntities.end(), [this](const NotifyEntity &entity) {
-            return entity.id() == m_blockClosedId;
-        });
-
         const auto current = QDateTime::currentMSecsSinceEpoch();
-        if (findIter != m_pendingTimeoutEntities.end()) {
-            if (current > findIter.key() - BlockItemTimeout) {
-                qDebug(notifyLog) << "Delay close bubble id:" << m_blockClosedId << "for the new block bubble id:" << id;
-                m_pendingTimeoutEntities.insert(current + BlockItemTimeout, findIter.value());
-                m_pendingTimeoutEntities.erase(findIter);
-            }
+        if (m_blockedEntity.isValid()) {
+            // it has expired while it was blocked.
+            qDebug(notifyLog) << "Delay close bubble id:" << m_blockClosedId << "for the new block bubble id:" << id;
+            m_pendingTimeouts.push(current + BlockItemTimeout, m_blockedEntity);
+        } else if (const auto point = m_pendingTimeouts.deadline(m_blockClosedId); point >= 0 && current > point - BlockItemTimeout) {
+            qDebug(notifyLog) << "Delay close bubble id:" << m_blockClosedId << "for the new block bubble id:" << id;
+            m_pendingTimeouts.reschedule(m_blockClosedId, current + BlockItemTimeout);
         }
     }
+    m_blockedEntity = {};
     m_blockClosedId = id;
     onHandingPendingEntities();
 }
 
-bool NotificationManager::isDoNotDisturb() const
+bool NotificationManager::isDoNotDisturb(const NotificationSetting::SystemPolicy &policy) const
 {
-    if (!m_setting->systemValue(NotificationSetting::DNDMode).toBool())
+    if (!policy.dndMode)
         return false;
 
     // 未点击按钮  任何时候都勿扰模式
-    if (!m_setting->systemValue(NotificationSetting::OpenByTimeInterval).toBool() &&
-        !m_setting->systemValue(NotificationSetting::LockScreenOpenDNDMode).toBool()) {
+    if (!policy.openByTimeInterval && !policy.lockScreenOpenDNDMode) {
         return true;
     }
 
     // 点击锁屏时 并且 锁屏状态 任何时候都勿扰模式
-    if (m_setting->systemValue(NotificationSetting::LockScreenOpenDNDMode).toBool() && m_screenLocked)
+    if (policy.lockScreenOpenDNDMode && m_screenLocked)
         return true;
 
-    QTime currentTime = QTime::fromString(QDateTime::currentDateTime().toString("hh:mm"));
-    QTime startTime = QTime::fromString(m_setting->systemValue(NotificationSetting::StartTime).toString());
-    QTime endTime = QTime::fromString(m_setting->systemValue(NotificationSetting::EndTime).toString());
+    const auto now = QTime::currentTime();
+    const QTime currentTime(now.hour(), now.minute());
+    const QTime &startTime = policy.startTime;
+    const QTime &endTime = policy.endTime;
 
     bool dndMode = true;
     if (startTime < endTime) {
@@ -422,7 +528,7 @@ bool NotificationManager::isDoNotDisturb() const
         dndMode = startTime <= currentTime || endTime >= currentTime;
     }
 
-    return dndMode && m_setting->systemValue(NotificationSetting::OpenByTimeInterval).toBool();
+    return dndMode && policy.openByTimeInterval;
 }
 
 bool NotificationManager::recordNotification(NotifyEntity &entity)
@@ -471,7 +577,7 @@ void NotificationManager::tryPlayNotificationSound(const NotifyEntity &entity, c
     bool playSound = true;
     bool systemNotification = m_systemApps.contains(appId);
     if (!systemNotification)
-        playSound = m_setting->appValue(appId, NotificationSetting::EnableSound).toBool();
+        playSound = m_setting->appPolicy(appId).enableSound;
 
     if (playSound && !dndMode) {
         const auto actions = entity.actions();
@@ -503,14 +609,27 @@ void NotificationManager::pushPendingEntity(const NotifyEntity &entity, int expi
     const int interval = expireTimeout == -1 ? DefaultTimeOutMSecs : expireTimeout;
 
     qint64 point = QDateTime::currentMSecsSinceEpoch() + interval;
-    m_pendingTimeoutEntities.insert(point, entity);
+    m_pendingTimeouts.push(point, entity);
+    updatePendingTimeout();
+}
 
-    if (m_lastTimeoutPoint > point) {
-        m_lastTimeoutPoint = point;
-        auto newInterval = m_lastTimeoutPoint - QDateTime::currentMSecsSinceEpoch();
-        m_pendingTimeout->setInterval(newInterval);
-        m_pendingTimeout->start();
+// arms the timer for the earliest deadline, it's only restarted when the deadline changes.
+void NotificationManager::updatePendingTimeout()
+{
+    const auto point = m_pendingTimeouts.nextDeadline();
+    if (point == m_lastTimeoutPoint && (m_pendingTimeout->isActive() || m_pendingTimeouts.isEmpty()))
+        return;
+
+    // setBlockClosedId may be called out of the manager's thread, let timer start in its thread.
+    m_lastTimeoutPoint = point;
+    if (m_pendingTimeouts.isEmpty()) {
+        QMetaObject::invokeMethod(m_pendingTimeout, "stop", Qt::AutoConnection);
+        return;
     }
+
+    const auto newInterval = std::max<qint64>(m_lastTimeoutPoint - QDateTime::currentMSecsSinceEpoch(), 0);
+    const int interval = static_cast<int>(std::min<qint64>(newInterval, std::numeric_limits<int>::max()));
+    QMetaObject::invokeMethod(m_pendingTimeout, "start", Qt::AutoConnection, Q_ARG(int, interval));
 }
 
 void NotificationManager::updateEntityProcessed(qint64 id, uint reason)
@@ -532,7 +651,7 @@ void NotificationManager::updateEntityProcessed(const NotifyEntity &entity)
 {
     const auto id = entity.id();
     const bool removed = entity.processedType() == NotifyEntity::Removed;
-    bool showInCenter = m_setting->appValue(entity.appId(), NotificationSetting::ShowInCenter).toBool();
+    bool showInCenter = m_setting->appPolicy(entity.appId()).showInCenter;
     if (entity.hints().contains("x-deepin-ShowInNotifyCenter")) {
         showInCenter = entity.hints()["x-deepin-ShowInNotifyCenter"].toBool();
     }
@@ -544,20 +663,118 @@ void NotificationManager::updateEntityProcessed(const NotifyEntity &entity)
         m_persistence->updateEntityProcessedType(id, entity.processedType());
     }
 
+    NotifyEntityChannel::instance()->publish(entity);
     Q_EMIT NotificationStateChanged(entity.id(), entity.processedType());
 
     removePendingEntity(entity);
     emitRecordCountChanged();
 }
 
-QString NotificationManager::appIdByAppName(const QString &appName) const
+// token bucket of the app, it refills notificationRateLimit tokens per second up to notificationRateBurst.
+bool NotificationManager::acquireRateToken(const QString &appId)
 {
-    const auto items = m_setting->appItems();
-    for (const auto &item: items) {
-        if (item.id == appName || item.appName == appName)
-            return item.id;
+    if (m_rateLimit <= 0 || m_rateBurst <= 0 || m_systemApps.contains(appId))
+        return true;
+
+    const auto current = m_rateClock.elapsed();
+    if (m_rateBuckets.size() >= MaxRateBuckets && !m_rateBuckets.contains(appId)) {
+        // buckets which are full again are the same as new ones.
+        const qint64 refillMSecs = m_rateBurst * 1000 / m_rateLimit;
+        m_rateBuckets.removeIf([current, refillMSecs](const QHash<QString, RateBucket>::iterator &iter) {
+            return current - iter.value().lastRefill >= refillMSecs;
+        });
     }
 
+    auto iter = m_rateBuckets.find(appId);
+    if (iter == m_rateBuckets.end()) {
+        iter = m_rateBuckets.insert(appId, {static_cast<double>(m_rateBurst), current});
+    }
+    auto &bucket = iter.value();
+    bucket.tokens = std::min<double>(m_rateBurst, bucket.tokens + (current - bucket.lastRefill) * m_rateLimit / 1000);
+    bucket.lastRefill = current;
+    if (bucket.tokens < 1)
+        return false;
+
+    bucket.tokens -= 1;
+    return true;
+}
+
+// a throttled notification is merged into the summary of its app, a throttled replacement only keeps the latest one.
+uint NotificationManager::throttleNotification(const NotifyArguments &arguments)
+{
+    const auto &appId = arguments.appId;
+    if (!m_coalesceTimer->isActive())
+        m_coalesceTimer->start();
+
+    if (arguments.replacesId != NoReplacesId) {
+        if (m_throttledReplaces.contains(arguments.replacesId)) {
+            ++m_droppedCount;
+        }
+        m_throttledReplaces.insert(arguments.replacesId, arguments);
+        NotifyTrace::instance()->entity(NotifyTrace::ThrottledCategory, 0, arguments.replacesId);
+        qDebug(notifyLog) << "Throttled the replacement of the bubble:" << arguments.replacesId << ", appId:" << appId;
+        return arguments.replacesId;
+    }
+
+    auto &item = m_coalesced[appId];
+    item.appName = arguments.appName;
+    if (!arguments.appIcon.isEmpty())
+        item.appIcon = arguments.appIcon;
+    ++item.count;
+    ++m_coalescedCount;
+    NotifyTrace::instance()->entity(NotifyTrace::ThrottledCategory, 0, 0, item.count);
+    qDebug(notifyLog) << "Throttled the notification of the app:" << appId << ", coalesced count:" << item.count;
+
+    // the id is never shown, replacing or closing it is harmless.
+    return ++m_replacesCount;
+}
+
+void NotificationManager::onCoalesceTimeout()
+{
+    // they're delivered with the app id and the policies of the original call, without the rate limit.
+    const auto replaces = std::exchange(m_throttledReplaces, {});
+    for (const auto &item : replaces) {
+        deliverNotification(item, false);
+    }
+
+    const auto coalesced = std::exchange(m_coalesced, {});
+    QHash<QString, CoalescedSummary> summaries;
+    for (auto iter = coalesced.cbegin(); iter != coalesced.cend(); ++iter) {
+        const auto &item = iter.value();
+        // the summary of an ongoing storm is replaced with the total count.
+        auto summary = m_coalescedSummaries.value(iter.key());
+        summary.count += item.count;
+        // the earlier summary bubble can't be replaced once it's expired or closed, a new one is shown.
+        if (summary.bubbleId > 0 && !m_persistence->fetchLastEntity(summary.bubbleId).isValid()) {
+            summary.bubbleId = 0;
+        }
+
+        qInfo(notifyLog) << "Coalesced notifications of the app:" << iter.key() << ", count:" << summary.count
+                         << ", total coalesced:" << m_coalescedCount << ", total dropped:" << m_droppedCount;
+        const QVariantMap hints {{"x-deepin-PlaySound", false}};
+        const NotifyArguments arguments{iter.key(),
+                                        item.appName,
+                                        summary.bubbleId,
+                                        item.appIcon,
+                                        tr("%n notification(s) merged", nullptr, summary.count),
+                                        tr("%1 is sending notifications too frequently").arg(item.appName),
+                                        {},
+                                        hints,
+                                        -1,
+                                        true};
+        summary.bubbleId = deliverNotification(arguments, false);
+        summaries.insert(iter.key(), summary);
+    }
+    // apps which weren't throttled in this interval start a new summary next time.
+    m_coalescedSummaries = summaries;
+}
+
+QString NotificationManager::appIdByAppName(const QString &appName) const
+{
+    const auto appId = m_setting->appIdByName(appName);
+    if (!appId.isEmpty())
+        return appId;
+
     if (m_appNamesMap.contains(appName)) {
         return m_appNamesMap.value(appName).toString();
     }
@@ -565,6 +782,23 @@ QString NotificationManager::appIdByAppName(const QString &appName) const
     return QString();
 }
 
+// the app of a sender is resolved by its pid once, it's cached until the sender leaves the bus.
+QString NotificationManager::appIdBySender(const QString &sender)
+{
+    if (auto iter = m_senderAppIds.constFind(sender); iter != m_senderAppIds.constEnd())
+        return iter.value();
+
+    QDBusReply<uint> reply = connection().interface()->servicePid(sender);
+    const auto appId = DSGApplication::getId(reply.value());
+    // unique names are never reused by the bus, but well-known names may get a new owner,
+    // an empty id may be a failed lookup, e.g. the app isn't registered yet, it's looked up again.
+    if (sender.startsWith(':') && !appId.isEmpty()) {
+        m_senderAppIds.insert(sender, appId);
+        m_senderWatcher->addWatchedService(sender);
+    }
+    return appId;
+}
+
 bool NotificationManager::isExtendedAction(qint64 id, const QString &actionId) const
 {
     auto entity = m_persistence->fetchEntity(id);
@@ -709,34 +943,11 @@ void NotificationManager::initScreenLockedState()
 
 void NotificationManager::onHandingPendingEntities()
 {
-    QList<NotifyEntity> timeoutEntities;
-
     const auto current = QDateTime::currentMSecsSinceEpoch();
-    for (auto iter = m_pendingTimeoutEntities.begin(); iter != m_pendingTimeoutEntities.end();) {
-        const auto point = iter.key();
-        if (point > current) {
-            iter++;
-            continue;
-        }
+    const auto timeoutEntities = m_pendingTimeouts.takeExpired(current);
 
-        const auto entity = iter.value();;
-        timeoutEntities << entity;
-        iter = m_pendingTimeoutEntities.erase(iter);
-    }
-
-    // update pendingTimeout to deal with m_pendingTimeoutEntities
-    if (!m_pendingTimeoutEntities.isEmpty()) {
-        auto points = m_pendingTimeoutEntities.keys();
-        std::sort(points.begin(), points.end());
-        // find last point to restart pendingTimeout
-        m_lastTimeoutPoint = points.first();
-        auto newInterval = m_lastTimeoutPoint - current;
-        // let timer start in main thread
-        QMetaObject::invokeMethod(m_pendingTimeout, "start", Qt::QueuedConnection, Q_ARG(int, newInterval));
-    } else {
-        // reset m_lastTimeoutPoint
-        m_lastTimeoutPoint = std::numeric_limits<qint64>::max();
-    }
+    // update pendingTimeout to deal with the rest of m_pendingTimeouts
+    updatePendingTimeout();
 
     for (const auto &item : timeoutEntities) {
         // Validate entity before processing timeout to prevent race conditions
@@ -747,32 +958,46 @@ void NotificationManager::onHandingPendingEntities()
         }
 
         if (item.id() == m_blockClosedId) {
+            // it's closed after it's unblocked.
             qDebug(notifyLog) << "bubble id:" << item.bubbleId() << "entity id:" << item.id();
-            m_pendingTimeoutEntities.insert(current, item);
+            m_blockedEntity = item;
             continue;
         }
 
         qDebug(notifyLog) << "Expired for the notification " << item.id() << item.appName();
+        NotifyTrace::instance()->entity(NotifyTrace::ExpiredCategory, item);
         notificationClosed(item.id(), item.bubbleId(), NotifyEntity::Expired);
     }
 }
 
 void NotificationManager::removePendingEntity(const NotifyEntity &entity)
 {
-    for (auto iter = m_pendingTimeoutEntities.begin(); iter != m_pendingTimeoutEntities.end();) {
-        const auto item = iter.value();
-        if (item == entity || (entity.isReplace() && item.bubbleId() == entity.bubbleId())) {
-            m_pendingTimeoutEntities.erase(iter);
-            onHandingPendingEntities();
-            break;
-        }
-        ++iter;
+    if (m_blockedEntity == entity || (entity.isReplace() && m_blockedEntity.isValid() && m_blockedEntity.bubbleId() == entity.bubbleId())) {
+        m_blockedEntity = {};
+    }
+
+    bool removed = m_pendingTimeouts.remove(entity.id());
+    if (!removed && entity.isReplace()) {
+        removed = m_pendingTimeouts.removeByBubbleId(entity.bubbleId()) > 0;
+    }
+    if (removed) {
+        updatePendingTimeout();
     }
 }
 
 void NotificationManager::onScreenLockedChanged(bool screenLocked)
 {
     m_screenLocked = screenLocked;
+    if (m_screenLocked) {
+        m_persistence->compact(true);
+    }
+}
+
+void NotificationManager::onSessionIdleChanged(bool idle)
+{
+    if (idle) {
+        m_persistence->compact(true);
+    }
 }
 
 } // notification
@@ -6,13 +6,17 @@
 
 #include <QDBusContext>
 #include <QDBusVariant>
+#include <QElapsedTimer>
 
+#include "notificationsetting.h"
+#include "notifyentity.h"
+#include "notifytimeoutqueue.h"
+
+class QDBusServiceWatcher;
 class QTimer;
 namespace notification {
 
-class NotifyEntity;
 class DataAccessor;
-class NotificationSetting;
 
 class NotificationManager : public QObject, public QDBusContext
 {
@@ -26,6 +30,14 @@ public:
     bool registerDbusService();
 
     uint recordCount() const;
+    // notifications merged into a summary or superseded while the sender was rate limited.
+    quint64 coalescedCount() const;
+    quint64 droppedCount() const;
+    // statements of the notification database reused from the cache and prepared, of all connections.
+    quint64 statementCacheHits() const;
+    quint64 statementCacheMisses() const;
+    // whether the debug interface of the trace is exported.
+    bool traceEnabled() const;
     Q_INVOKABLE void actionInvoked(qint64 id, const QString &actionKey);
     Q_INVOKABLE void actionInvoked(qint64 id, uint bubbleId, const QString &actionKey);
     Q_INVOKABLE void notificationClosed(qint64 id, uint bubbleId, uint reason);
@@ -70,16 +82,37 @@ public Q_SLOTS:
 
     void setBlockClosedId(qint64 id);
 private:
-    bool isDoNotDisturb() const;
+    bool isDoNotDisturb(const NotificationSetting::SystemPolicy &policy) const;
     bool recordNotification(NotifyEntity &entity);
     void tryPlayNotificationSound(const NotifyEntity &entity, const QString &appId, bool dndMode) const;
     void emitRecordCountChanged();
 
     void pushPendingEntity(const NotifyEntity &entity, int expireTimeout);
+    void updatePendingTimeout();
     void updateEntityProcessed(qint64 id, uint reason);
     void updateEntityProcessed(const NotifyEntity &entity);
 
+    struct NotifyArguments
+    {
+        // the app id resolved by the sender, it's kept as the sender may be gone when they're delivered.
+        QString appId;
+        QString appName;
+        uint replacesId = 0;
+        QString appIcon;
+        QString summary;
+        QString body;
+        QStringList actions;
+        QVariantMap hints;
+        int expireTimeout = -1;
+        // the policies of the D-Bus callers apply to it, e.g. CloseNotification.
+        bool fromDBus = false;
+    };
+    uint deliverNotification(const NotifyArguments &arguments, bool rateLimited);
+    bool acquireRateToken(const QString &appId);
+    uint throttleNotification(const NotifyArguments &arguments);
+
     QString appIdByAppName(const QString &appName) const;
+    QString appIdBySender(const QString &sender);
     void doActionInvoked(const NotifyEntity &entity, const QString &actionId);
     bool isExtendedAction(qint64 id, const QString &actionId) const;
     bool invokeShellAction(const QString &data);
@@ -89,6 +122,8 @@ private slots:
     void onHandingPendingEntities();
     void removePendingEntity(const NotifyEntity &entity);
     void onScreenLockedChanged(bool);
+    void onSessionIdleChanged(bool idle);
+    void onCoalesceTimeout();
 
 private:
     uint m_replacesCount = 0;
@@ -97,8 +132,45 @@ private:
     DataAccessor *m_persistence = nullptr;
     NotificationSetting *m_setting = nullptr;
     QTimer *m_pendingTimeout = nullptr;
+    QTimer *m_compactTimer = nullptr;
+    QDBusServiceWatcher *m_senderWatcher = nullptr;
+    // unique bus names of the senders to their app id.
+    QHash<QString, QString> m_senderAppIds;
+
+    struct RateBucket
+    {
+        double tokens = 0;
+        qint64 lastRefill = 0;
+    };
+    struct CoalescedNotification
+    {
+        QString appName;
+        QString appIcon;
+        int count = 0;
+    };
+    struct CoalescedSummary
+    {
+        uint bubbleId = 0;
+        int count = 0;
+    };
+    // notifications per second of an app and the burst, rate limiting is disabled if any of them is 0.
+    double m_rateLimit = 0;
+    int m_rateBurst = 0;
+    bool m_traceEnabled = false;
+    QElapsedTimer m_rateClock;
+    // the time of the last received notification on m_rateClock.
+    qint64 m_lastNotifyPoint = 0;
+    QHash<QString, RateBucket> m_rateBuckets;
+    QTimer *m_coalesceTimer = nullptr;
+    QHash<QString, CoalescedNotification> m_coalesced;
+    QHash<QString, CoalescedSummary> m_coalescedSummaries;
+    QHash<uint, NotifyArguments> m_throttledReplaces;
+    quint64 m_coalescedCount = 0;
+    quint64 m_droppedCount = 0;
     qint64 m_lastTimeoutPoint = std::numeric_limits<qint64>::max();
-    QMultiHash<qint64, NotifyEntity> m_pendingTimeoutEntities;
+    NotifyTimeoutQueue m_pendingTimeouts;
+    // the blocked entity which has expired, it's closed after it's unblocked.
+    NotifyEntity m_blockedEntity;
     QStringList m_systemApps;
     QMap<QString, QVariant> m_appNamesMap;
     int m_cleanupDays = 7;
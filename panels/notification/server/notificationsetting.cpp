@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -47,7 +47,7 @@ NotificationSetting::NotificationSetting(QObject *parent)
             static const QStringList
                 keys{"dndMode", "openByTimeInterval", "lockScreenOpenDndMode", "startTime", "endTime", "notificationClosed", "maxCount", "bubbleCount"};
             if (keys.contains(key)) {
-                m_systemInfo = {};
+                invalidSystemPolicy();
             }
         }
     });
@@ -102,46 +102,31 @@ void NotificationSetting::setAppValue(const QString &id, AppConfigItem item, con
         m_appsInfo[id] = info;
         m_impl->setValue("appsInfo", m_appsInfo);
     }
+    invalidPolicies();
 
     Q_EMIT appValueChanged(id, item, value);
 }
 
 QVariant NotificationSetting::appValue(const QString &id, AppConfigItem item)
 {
-    const auto app = appItem(id);
+    const auto policy = appPolicy(id);
     switch (item) {
-    case AppName: {
-        return app.appName;
-    }
-    case AppIcon: {
-        return app.appIcon;
-    default:
-        break;
-    }
-    }
-
-    const auto info = appInfo(id);
-    switch (item) {
-    case EnableNotification: {
-        return info.value("enabled", true);
-    }
-    case EnablePreview: {
-        return info.value("enablePreview", true);
-    }
-    case EnableSound: {
-        return info.value("enableSound", true);
-    }
-    case ShowInCenter: {
-        return info.value("showInCenter", true);
-    }
-    case ShowOnLockScreen: {
-        return info.value("showOnLockScreen", true);
-    }
-    case ShowOnDesktop: {
-        return info.value("showOnDesktop", true);
-    }
-    default:
-        break;
+    case AppName:
+        return policy.appName;
+    case AppIcon:
+        return policy.appIcon;
+    case EnableNotification:
+        return policy.enableNotification;
+    case EnablePreview:
+        return policy.enablePreview;
+    case EnableSound:
+        return policy.enableSound;
+    case ShowInCenter:
+        return policy.showInCenter;
+    case ShowOnLockScreen:
+        return policy.showOnLockScreen;
+    case ShowOnDesktop:
+        return policy.showOnDesktop;
     }
 
     return QVariant();
@@ -177,7 +162,7 @@ void NotificationSetting::setSystemValue(NotificationSetting::SystemConfigItem i
     default:
         return;
     }
-    m_systemInfo = {};
+    invalidSystemPolicy();
     Q_EMIT systemValueChanged(item, value);
 }
 
@@ -205,6 +190,43 @@ QVariant NotificationSetting::systemValue(NotificationSetting::SystemConfigItem
     return {};
 }
 
+NotificationSetting::AppPolicy NotificationSetting::appPolicy(const QString &id)
+{
+    QMutexLocker locker(&m_policiesMutex);
+    if (!m_appPoliciesCompiled) {
+        m_appPolicies.clear();
+        for (const auto &item : appItems()) {
+            m_appPolicies.insert(item.id, compileAppPolicy(item.id, item));
+        }
+        m_appPoliciesCompiled = true;
+    }
+
+    if (auto iter = m_appPolicies.constFind(id); iter != m_appPolicies.constEnd())
+        return iter.value();
+
+    // apps out of the app list only have the values of appsInfo.
+    const auto policy = compileAppPolicy(id, {});
+    m_appPolicies.insert(id, policy);
+    return policy;
+}
+
+NotificationSetting::SystemPolicy NotificationSetting::systemPolicy()
+{
+    QMutexLocker locker(&m_policiesMutex);
+    if (!m_systemPolicyCompiled) {
+        SystemPolicy policy;
+        policy.dndMode = systemValue(DNDMode).toBool();
+        policy.lockScreenOpenDNDMode = systemValue(LockScreenOpenDNDMode).toBool();
+        policy.openByTimeInterval = systemValue(OpenByTimeInterval).toBool();
+        policy.startTime = QTime::fromString(systemValue(StartTime).toString());
+        policy.endTime = QTime::fromString(systemValue(EndTime).toString());
+        policy.closeNotification = systemValue(CloseNotification).toBool();
+        m_systemPolicy = policy;
+        m_systemPolicyCompiled = true;
+    }
+    return m_systemPolicy;
+}
+
 QStringList NotificationSetting::apps() const
 {
     QStringList ret;
@@ -235,9 +257,32 @@ QList<NotificationSetting::AppItem> NotificationSetting::appItems() const
 
     QList<NotificationSetting::AppItem> apps = appItemsImpl();
     const_cast<NotificationSetting *>(this)->m_appItems = apps;
+    const_cast<NotificationSetting *>(this)->m_appIds = indexAppIds(apps);
     return m_appItems;
 }
 
+QString NotificationSetting::appIdByName(const QString &name) const
+{
+    // loads the app list if it isn't loaded.
+    appItems();
+
+    QMutexLocker locker(&(const_cast<NotificationSetting *>(this)->m_appItemsMutex));
+    return m_appIds.value(name);
+}
+
+QHash<QString, QString> NotificationSetting::indexAppIds(const QList<AppItem> &apps)
+{
+    QHash<QString, QString> ret;
+    ret.reserve(apps.size() * 2);
+    for (const auto &item : apps) {
+        if (!item.id.isEmpty() && !ret.contains(item.id))
+            ret.insert(item.id, item.id);
+        if (!item.appName.isEmpty() && !ret.contains(item.appName))
+            ret.insert(item.appName, item.id);
+    }
+    return ret;
+}
+
 QList<NotificationSetting::AppItem> NotificationSetting::appItemsImpl() const
 {
     if (!m_appAccessor)
@@ -311,14 +356,48 @@ void NotificationSetting::onAppsChanged()
     {
         QMutexLocker locker(&m_appItemsMutex);
         m_appItems = current;
+        m_appIds = indexAppIds(current);
     }
+    invalidPolicies();
 }
 
 void NotificationSetting::invalidAppItemCached()
 {
-    QMutexLocker locker(&m_appsInfoMutex);
-    m_appsInfo.clear();
-    m_appsInfo[InvalidApp] = QVariant();
+    {
+        QMutexLocker locker(&m_appsInfoMutex);
+        m_appsInfo.clear();
+        m_appsInfo[InvalidApp] = QVariant();
+    }
+    invalidPolicies();
+}
+
+void NotificationSetting::invalidPolicies()
+{
+    QMutexLocker locker(&m_policiesMutex);
+    m_appPoliciesCompiled = false;
+    m_appPolicies.clear();
+}
+
+void NotificationSetting::invalidSystemPolicy()
+{
+    QMutexLocker locker(&m_policiesMutex);
+    m_systemInfo = {};
+    m_systemPolicyCompiled = false;
+}
+
+NotificationSetting::AppPolicy NotificationSetting::compileAppPolicy(const QString &id, const AppItem &app) const
+{
+    const auto info = appInfo(id);
+    AppPolicy policy;
+    policy.appName = app.appName;
+    policy.appIcon = app.appIcon;
+    policy.enableNotification = info.value("enabled", true).toBool();
+    policy.enablePreview = info.value("enablePreview", true).toBool();
+    policy.enableSound = info.value("enableSound", true).toBool();
+    policy.showInCenter = info.value("showInCenter", true).toBool();
+    policy.showOnLockScreen = info.value("showOnLockScreen", true).toBool();
+    policy.showOnDesktop = info.value("showOnDesktop", true).toBool();
+    return policy;
 }
 
 QVariant NotificationSetting::systemValue(const QString &key, const QVariant &fallback)
@@ -1,11 +1,13 @@
-// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2024 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #pragma once
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <QTime>
 #include <QTimer>
 #include <QVariantMap>
 
@@ -51,6 +53,28 @@ public:
         QString appName;
         QString appIcon;
     };
+
+    // settings of an app compiled from the app list and appsInfo, they're rebuilt when any of them changes.
+    struct AppPolicy {
+        QString appName;
+        QString appIcon;
+        bool enableNotification = true;
+        bool enablePreview = true;
+        bool enableSound = true;
+        bool showInCenter = true;
+        bool showOnLockScreen = true;
+        bool showOnDesktop = true;
+    };
+
+    // system settings with the do not disturb time parsed.
+    struct SystemPolicy {
+        bool dndMode = true;
+        bool lockScreenOpenDNDMode = false;
+        bool openByTimeInterval = true;
+        QTime startTime;
+        QTime endTime;
+        bool closeNotification = false;
+    };
     // clang-format on
 
 public:
@@ -65,10 +89,15 @@ public:
     void setSystemValue(SystemConfigItem item, const QVariant &value);
     QVariant systemValue(SystemConfigItem item);
 
+    AppPolicy appPolicy(const QString &id);
+    SystemPolicy systemPolicy();
+
     QStringList apps() const;
     AppItem appItem(const QString &id) const;
     QList<AppItem> appItems() const;
     QList<AppItem> appItemsImpl() const;
+    // id of the app whose id or name is the given name, it's empty if there isn't one.
+    QString appIdByName(const QString &name) const;
 
     QVariantMap appInfo(const QString &id) const;
 
@@ -83,17 +112,28 @@ private slots:
 
 private:
     void updateAppItemValue(const QVariantMap &info, AppItem &app) const;
+    static QHash<QString, QString> indexAppIds(const QList<AppItem> &apps);
     void invalidAppItemCached();
+    void invalidPolicies();
+    void invalidSystemPolicy();
+    AppPolicy compileAppPolicy(const QString &id, const AppItem &app) const;
     QVariant systemValue(const QString &key, const QVariant &fallback);
 
 private:
     Dtk::Core::DConfig *m_impl = nullptr;
     QAbstractItemModel *m_appAccessor = nullptr;
     QList<AppItem> m_appItems;
+    // ids and names of m_appItems to the app id, the first app in the list wins.
+    QHash<QString, QString> m_appIds;
     QMutex m_appItemsMutex;
     QVariantMap m_appsInfo;
     QMutex m_appsInfoMutex;
     QVariantMap m_systemInfo;
+    QHash<QString, AppPolicy> m_appPolicies;
+    bool m_appPoliciesCompiled = false;
+    SystemPolicy m_systemPolicy;
+    bool m_systemPolicyCompiled = false;
+    QMutex m_policiesMutex;
 };
 
 } // notification
@@ -53,6 +53,9 @@ bool NotifyServerApplet::init()
 
     new DbusAdaptor(m_manager);
     new DDENotificationDbusAdaptor(m_manager);
+    if (m_manager->traceEnabled()) {
+        new NotifyTraceDbusAdaptor(m_manager);
+    }
 
     connect(m_manager, &NotificationManager::NotificationStateChanged, this, &NotifyServerApplet::notificationStateChanged);
 
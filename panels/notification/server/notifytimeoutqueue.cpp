@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifytimeoutqueue.h"
+
+#include <limits>
+
+namespace notification {
+
+bool NotifyTimeoutQueue::isEmpty() const
+{
+    return m_heap.isEmpty();
+}
+
+int NotifyTimeoutQueue::size() const
+{
+    return m_heap.size();
+}
+
+bool NotifyTimeoutQueue::contains(qint64 id) const
+{
+    return m_indexes.contains(id);
+}
+
+qint64 NotifyTimeoutQueue::nextDeadline() const
+{
+    if (m_heap.isEmpty())
+        return std::numeric_limits<qint64>::max();
+
+    return m_heap.first().deadline;
+}
+
+qint64 NotifyTimeoutQueue::deadline(qint64 id) const
+{
+    auto iter = m_indexes.constFind(id);
+    if (iter == m_indexes.constEnd())
+        return -1;
+
+    return m_heap.at(iter.value()).deadline;
+}
+
+void NotifyTimeoutQueue::push(qint64 deadline, const NotifyEntity &entity)
+{
+    if (reschedule(entity.id(), deadline))
+        return;
+
+    Node node;
+    node.deadline = deadline;
+    node.sequence = m_sequence++;
+    node.id = entity.id();
+    node.bubbleId = entity.bubbleId();
+    node.entity = entity;
+    m_heap.append(node);
+
+    const int index = m_heap.size() - 1;
+    m_indexes.insert(node.id, index);
+    m_bubbleIds.insert(node.bubbleId, node.id);
+    siftUp(index);
+}
+
+bool NotifyTimeoutQueue::reschedule(qint64 id, qint64 deadline)
+{
+    auto iter = m_indexes.constFind(id);
+    if (iter == m_indexes.constEnd())
+        return false;
+
+    const int index = iter.value();
+    auto &node = m_heap[index];
+    const bool earlier = deadline < node.deadline;
+    node.deadline = deadline;
+    node.sequence = m_sequence++;
+    if (earlier) {
+        siftUp(index);
+    } else {
+        siftDown(index);
+    }
+    return true;
+}
+
+bool NotifyTimeoutQueue::remove(qint64 id)
+{
+    auto iter = m_indexes.constFind(id);
+    if (iter == m_indexes.constEnd())
+        return false;
+
+    removeAt(iter.value());
+    return true;
+}
+
+int NotifyTimeoutQueue::removeByBubbleId(uint bubbleId)
+{
+    const auto ids = m_bubbleIds.values(bubbleId);
+    for (const auto id : ids) {
+        remove(id);
+    }
+    return ids.size();
+}
+
+void NotifyTimeoutQueue::clear()
+{
+    m_heap.clear();
+    m_indexes.clear();
+    m_bubbleIds.clear();
+}
+
+QList<NotifyEntity> NotifyTimeoutQueue::takeExpired(qint64 current)
+{
+    QList<NotifyEntity> ret;
+    while (!m_heap.isEmpty() && m_heap.first().deadline <= current) {
+        ret << m_heap.first().entity;
+        removeAt(0);
+    }
+    return ret;
+}
+
+bool NotifyTimeoutQueue::lessThan(const Node &left, const Node &right)
+{
+    if (left.deadline != right.deadline)
+        return left.deadline < right.deadline;
+
+    return left.sequence < right.sequence;
+}
+
+void NotifyTimeoutQueue::siftUp(int index)
+{
+    while (index > 0) {
+        const int parent = (index - 1) / 2;
+        if (!lessThan(m_heap.at(index), m_heap.at(parent)))
+            break;
+
+        swapNodes(index, parent);
+        index = parent;
+    }
+}
+
+void NotifyTimeoutQueue::siftDown(int index)
+{
+    const int count = m_heap.size();
+    while (true) {
+        int smallest = index;
+        const int left = index * 2 + 1;
+        const int right = left + 1;
+        if (left < count && lessThan(m_heap.at(left), m_heap.at(smallest)))
+            smallest = left;
+        if (right < count && lessThan(m_heap.at(right), m_heap.at(smallest)))
+            smallest = right;
+        if (smallest == index)
+            break;
+
+        swapNodes(index, smallest);
+        index = smallest;
+    }
+}
+
+void NotifyTimeoutQueue::swapNodes(int left, int right)
+{
+    m_heap.swapItemsAt(left, right);
+    m_indexes[m_heap.at(left).id] = left;
+    m_indexes[m_heap.at(right).id] = right;
+}
+
+void NotifyTimeoutQueue::removeAt(int index)
+{
+    const auto &node = m_heap.at(index);
+    m_indexes.remove(node.id);
+    m_bubbleIds.remove(node.bubbleId, node.id);
+
+    const int last = m_heap.size() - 1;
+    if (index != last) {
+        m_heap.swapItemsAt(index, last);
+        m_indexes[m_heap.at(index).id] = index;
+    }
+    m_heap.removeLast();
+
+    if (index < m_heap.size()) {
+        // the moved node may belong either above or below its new position.
+        const auto movedId = m_heap.at(index).id;
+        siftUp(index);
+        siftDown(m_indexes.value(movedId));
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMultiHash>
+
+#include "notifyentity.h"
+
+namespace notification {
+
+// Pending expiry of notifications ordered by the deadline,
+// it's a binary min-heap indexed by the entity id, so push, remove and reschedule are O(log n).
+class NotifyTimeoutQueue
+{
+public:
+    bool isEmpty() const;
+    int size() const;
+    bool contains(qint64 id) const;
+
+    // the earliest deadline, it's max of qint64 if the queue is empty.
+    qint64 nextDeadline() const;
+    // returns -1 if the entity isn't pending.
+    qint64 deadline(qint64 id) const;
+
+    // an entity already pending is rescheduled.
+    void push(qint64 deadline, const NotifyEntity &entity);
+    bool reschedule(qint64 id, qint64 deadline);
+    bool remove(qint64 id);
+    int removeByBubbleId(uint bubbleId);
+    void clear();
+
+    // takes the entities whose deadline is reached, in the order of the deadline.
+    QList<NotifyEntity> takeExpired(qint64 current);
+
+private:
+    struct Node
+    {
+        qint64 deadline = 0;
+        // entities with the same deadline expire in the order they're pushed.
+        quint64 sequence = 0;
+        // keys of the indexes, the shared entity data may change after it's pushed.
+        qint64 id = 0;
+        uint bubbleId = 0;
+        NotifyEntity entity;
+    };
+
+    static bool lessThan(const Node &left, const Node &right);
+    void siftUp(int index);
+    void siftDown(int index);
+    void swapNodes(int left, int right);
+    void removeAt(int index);
+
+private:
+    QList<Node> m_heap;
+    QHash<qint64, int> m_indexes;
+    QMultiHash<uint, qint64> m_bubbleIds;
+    quint64 m_sequence = 0;
+};
+
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notifytrace.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <iterator>
+
+#include "notifyentity.h"
+
+namespace notification {
+
+static const char *const CategoryNames[NotifyTrace::CategoryCount] = {"received", "shown", "throttled", "closed", "action", "expired"};
+
+// copies at most cap characters without allocating, returns the count copied.
+template<int N>
+static quint8 copyString(char16_t (&target)[N], const QString &source)
+{
+    const int size = std::min<int>(source.size(), N);
+    std::copy_n(reinterpret_cast<const char16_t *>(source.utf16()), size, target);
+    return static_cast<quint8>(size);
+}
+
+NotifyTrace::NotifyTrace()
+{
+    m_sampling.fill(1);
+    m_counters.fill(0);
+}
+
+NotifyTrace *NotifyTrace::instance()
+{
+    static NotifyTrace gInstance;
+    return &gInstance;
+}
+
+NotifyTrace::Record *NotifyTrace::append(Category category)
+{
+    const auto every = m_sampling[category];
+    if (every == 0 || m_counters[category]++ % every != 0)
+        return nullptr;
+
+    auto &record = m_records[m_sequence % Capacity];
+    record = Record();
+    record.sequence = m_sequence++;
+    record.time = QDateTime::currentMSecsSinceEpoch();
+    record.category = category;
+    return &record;
+}
+
+void NotifyTrace::received(const QString &appName, uint replacesId, const QString &body, const QStringList &actions,
+                           const QVariantMap &hints, int expireTimeout)
+{
+    QMutexLocker locker(&m_mutex);
+    auto record = append(ReceivedCategory);
+    if (!record)
+        return;
+
+    record->replacesId = replacesId;
+    record->value = expireTimeout;
+    record->bodySize = static_cast<quint32>(body.size());
+    record->actionCount = static_cast<quint16>(std::min<qsizetype>(actions.size(), 0xffff));
+    record->hintCount = static_cast<quint16>(std::min<qsizetype>(hints.size(), 0xffff));
+    record->appNameSize = copyString(record->appName, appName);
+
+    // only the keys of the hints are kept, the values may be images of megabytes.
+    int size = 0;
+    for (auto iter = hints.keyBegin(); iter != hints.keyEnd() && size < HintKeysCap; ++iter) {
+        if (size > 0)
+            record->hintKeys[size++] = u',';
+        const int count = std::min<int>(iter->size(), HintKeysCap - size);
+        std::copy_n(reinterpret_cast<const char16_t *>(iter->utf16()), count, record->hintKeys + size);
+        size += count;
+    }
+    record->hintKeysSize = static_cast<quint8>(std::min(size, HintKeysCap));
+}
+
+void NotifyTrace::entity(Category category, const NotifyEntity &entity, int value)
+{
+    QMutexLocker locker(&m_mutex);
+    auto record = append(category);
+    if (!record)
+        return;
+
+    record->id = entity.id();
+    record->bubbleId = entity.bubbleId();
+    record->replacesId = entity.replacesId();
+    record->value = value;
+    record->appNameSize = copyString(record->appName, entity.appName());
+}
+
+void NotifyTrace::entity(Category category, qint64 id, uint bubbleId, int value)
+{
+    QMutexLocker locker(&m_mutex);
+    auto record = append(category);
+    if (!record)
+        return;
+
+    record->id = id;
+    record->bubbleId = bubbleId;
+    record->value = value;
+}
+
+bool NotifyTrace::setSampling(const QString &category, uint every)
+{
+    const auto iter = std::find(std::begin(CategoryNames), std::end(CategoryNames), category);
+    if (iter == std::end(CategoryNames))
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    const auto index = iter - std::begin(CategoryNames);
+    m_sampling[index] = every;
+    m_counters[index] = 0;
+    return true;
+}
+
+QString NotifyTrace::dump() const
+{
+    QMutexLocker locker(&m_mutex);
+    QStringList lines;
+    const quint64 first = m_sequence > Capacity ? m_sequence - Capacity : 0;
+    for (quint64 sequence = first; sequence < m_sequence; sequence++) {
+        lines << format(m_records[sequence % Capacity]);
+    }
+    return lines.join('\n');
+}
+
+QString NotifyTrace::format(const Record &record)
+{
+    auto ret = QString("%1 #%2 %3")
+                   .arg(QDateTime::fromMSecsSinceEpoch(record.time).toString(Qt::ISODateWithMs))
+                   .arg(record.sequence)
+                   .arg(CategoryNames[record.category]);
+    if (record.id > 0 || record.bubbleId > 0)
+        ret += QString(" id:%1 bubbleId:%2").arg(record.id).arg(record.bubbleId);
+    if (record.appNameSize > 0)
+        ret += QString(" appName:\"%1\"").arg(QString::fromUtf16(record.appName, record.appNameSize));
+    if (record.category == ReceivedCategory) {
+        ret += QString(" replacesId:%1 bodySize:%2 actions:%3 hints:%4[%5] expireTimeout:%6")
+                   .arg(record.replacesId)
+                   .arg(record.bodySize)
+                   .arg(record.actionCount)
+                   .arg(record.hintCount)
+                   .arg(QString::fromUtf16(record.hintKeys, record.hintKeysSize))
+                   .arg(record.value);
+    } else {
+        ret += QString(" value:%1").arg(record.value);
+    }
+    return ret;
+}
+
+}
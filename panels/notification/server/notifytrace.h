@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <array>
+
+namespace notification {
+
+class NotifyEntity;
+
+// Trace of the notification server kept in a ring buffer of fixed size records,
+// the app names are copied up to a cap and the records are only formatted when they're dumped,
+// e.g. by the DumpTrace debug method. The content of the notifications isn't traced.
+class NotifyTrace
+{
+public:
+    enum Category {
+        ReceivedCategory = 0,
+        ShownCategory,
+        ThrottledCategory,
+        ClosedCategory,
+        ActionCategory,
+        ExpiredCategory,
+        CategoryCount
+    };
+
+    static NotifyTrace *instance();
+
+    void received(const QString &appName, uint replacesId, const QString &body, const QStringList &actions,
+                  const QVariantMap &hints, int expireTimeout);
+    // value depends on the category, e.g. the processed type, the closed reason.
+    void entity(Category category, const NotifyEntity &entity, int value = 0);
+    void entity(Category category, qint64 id, uint bubbleId, int value = 0);
+
+    // one of every `every` records of the category is kept, 0 disables the category.
+    bool setSampling(const QString &category, uint every);
+    QString dump() const;
+
+private:
+    static constexpr int AppNameCap = 32;
+    static constexpr int HintKeysCap = 64;
+    static constexpr int Capacity = 1024;
+
+    struct Record
+    {
+        qint64 time = 0;
+        quint64 sequence = 0;
+        qint64 id = 0;
+        uint bubbleId = 0;
+        uint replacesId = 0;
+        int value = 0;
+        quint32 bodySize = 0;
+        quint16 actionCount = 0;
+        quint16 hintCount = 0;
+        quint8 category = 0;
+        quint8 appNameSize = 0;
+        quint8 hintKeysSize = 0;
+        char16_t appName[AppNameCap];
+        char16_t hintKeys[HintKeysCap];
+    };
+
+    NotifyTrace();
+    // returns the slot of the next record, it's null if the record isn't sampled.
+    Record *append(Category category);
+    static QString format(const Record &record);
+
+private:
+    mutable QMutex m_mutex;
+    std::array<Record, Capacity> m_records;
+    quint64 m_sequence = 0;
+    std::array<uint, CategoryCount> m_sampling;
+    std::array<quint64, CategoryCount> m_counters;
+};
+
+}
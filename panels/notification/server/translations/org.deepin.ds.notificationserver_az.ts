@@ -0,0 +1,16 @@
+<?xml version="1.0" ?><!DOCTYPE TS><TS version="2.1" language="az">
+<context>
+    <name>notification::NotificationManager</name>
+    <message numerus="yes">
+        <source>%n notification(s) merged</source>
+        <translation type="unfinished">
+            <numerusform></numerusform>
+            <numerusform></numerusform>
+        </translation>
+    </message>
+    <message>
+        <source>%1 is sending notifications too frequently</source>
+        <translation type="unfinished"></translation>
+    </message>
+</context>
+</TS>
@@ -0,0 +1,269 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "x11utils.h"
+#include "x11windowiconstore.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <xcb/xcb.h>
+#include <xcb/xcb_icccm.h>
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QProcess>
+#include <QStandardPaths>
+
+#define X11 X11Utils::instance()
+
+using namespace dock;
+
+namespace {
+// windows mapped at once, e.g. when the session is restored.
+const int WindowCount = 50;
+const int IconSize = 32;
+const int LatencyRounds = 5;
+
+class X11WindowPropertiesTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (QGuiApplication::platformName() != "xcb")
+            GTEST_SKIP() << "Xvfb isn't available";
+
+        m_connection = X11->getXcbConnection();
+        for (int i = 0; i < WindowCount; ++i) {
+            m_windows << createWindow(i);
+        }
+        xcb_flush(m_connection);
+    }
+
+    void TearDown() override
+    {
+        for (auto window : std::as_const(m_windows)) {
+            xcb_destroy_window(m_connection, window);
+        }
+        if (m_connection)
+            xcb_flush(m_connection);
+    }
+
+    xcb_window_t createWindow(int index)
+    {
+        const xcb_window_t window = xcb_generate_id(m_connection);
+        xcb_create_window(m_connection, XCB_COPY_FROM_PARENT, window, X11->getRootWindow(),
+                          0, 0, 100, 100, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+
+        const QByteArray name = "window " + QByteArray::number(index);
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, window, X11->getAtomByName("_NET_WM_NAME"),
+                            X11->getAtomByName("UTF8_STRING"), 8, name.size(), name.constData());
+
+        // the instance name and the class name are separated by nul.
+        const char wmClass[] = "instance\0Class";
+        xcb_icccm_set_wm_class(m_connection, window, sizeof(wmClass), wmClass);
+
+        setAtoms(window, "_NET_WM_STATE", {"_NET_WM_STATE_FOCUSED"});
+        setAtoms(window, "_NET_WM_WINDOW_TYPE", {"_NET_WM_WINDOW_TYPE_NORMAL"});
+        setAtoms(window, "_NET_WM_ALLOWED_ACTIONS", {"_NET_WM_ACTION_CLOSE", "_NET_WM_ACTION_MINIMIZE"});
+
+        QList<uint32_t> icon(2 + IconSize * IconSize, 0xff3366cc + index);
+        icon[0] = IconSize;
+        icon[1] = IconSize;
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, window, X11->getAtomByName("_NET_WM_ICON"),
+                            XCB_ATOM_CARDINAL, 32, icon.size(), icon.constData());
+
+        const xcb_atom_t motifWMHints = X11->getAtomByName("_MOTIF_WM_HINTS");
+        const uint32_t hints[] = {MotifHintFunctions, MotifFunctionClose, 0, 0, 0};
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, window, motifWMHints, motifWMHints, 32, 5, hints);
+
+        return window;
+    }
+
+    void setAtoms(xcb_window_t window, const char *property, const QList<const char *> &names)
+    {
+        QList<xcb_atom_t> atoms;
+        for (auto name : names) {
+            atoms << X11->getAtomByName(name);
+        }
+        xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, window, X11->getAtomByName(property),
+                            XCB_ATOM_ATOM, 32, atoms.size(), atoms.constData());
+    }
+
+    // properties of the window fetched one by one, like it's done before the batch.
+    WindowProperties sequentialProperties(xcb_window_t window)
+    {
+        WindowProperties ret;
+        ret.properties = AllWindowProperties;
+        ret.pid = X11->getWindowPid(window);
+        ret.wmClass = X11->getWindowWMClass(window);
+        ret.name = X11->getWindowName(window);
+        ret.icon = X11->getWindowIcon(window);
+        ret.state = X11->getWindowState(window);
+        ret.allowedActions = X11->getWindowAllowedActions(window);
+        ret.types = X11->getWindowTypes(window);
+        ret.motifWMHints = X11->getWindowMotifWMHints(window);
+        return ret;
+    }
+
+    QList<WindowProperties> batchProperties(uint properties)
+    {
+        QList<WindowPropertiesCookie> cookies;
+        for (auto window : std::as_const(m_windows)) {
+            cookies << X11->requestWindowProperties(window, properties);
+        }
+
+        QList<WindowProperties> ret;
+        for (const auto &cookie : std::as_const(cookies)) {
+            ret << X11->getWindowProperties(cookie);
+        }
+        return ret;
+    }
+
+    xcb_connection_t *m_connection = nullptr;
+    QList<xcb_window_t> m_windows;
+};
+}
+
+TEST_F(X11WindowPropertiesTest, BatchMatchesGetters)
+{
+    const auto properties = batchProperties(AllWindowProperties);
+    ASSERT_EQ(properties.size(), m_windows.size());
+
+    for (int i = 0; i < m_windows.size(); ++i) {
+        const auto expected = sequentialProperties(m_windows[i]);
+        const auto &actual = properties[i];
+        EXPECT_EQ(actual.properties, uint(AllWindowProperties));
+        EXPECT_EQ(actual.pid, QCoreApplication::applicationPid());
+        EXPECT_EQ(actual.pid, expected.pid);
+        EXPECT_EQ(actual.wmClass, QStringList({"instance", "Class"}));
+        EXPECT_EQ(actual.wmClass, expected.wmClass);
+        EXPECT_EQ(actual.name, QString("window %1").arg(i));
+        EXPECT_EQ(actual.name, expected.name);
+        EXPECT_FALSE(actual.icon.isEmpty());
+        EXPECT_EQ(actual.icon, expected.icon);
+        const auto icon = X11WindowIconStore::instance()->image(X11WindowIconStore::idOfUrl(actual.icon), {});
+        EXPECT_EQ(icon.size(), QSize(IconSize, IconSize));
+        EXPECT_EQ(icon.pixel(0, 0), 0xff3366cc + i);
+        EXPECT_EQ(actual.state, expected.state);
+        EXPECT_TRUE(actual.state.contains(X11->getAtomByName("_NET_WM_STATE_FOCUSED")));
+        EXPECT_EQ(actual.allowedActions, expected.allowedActions);
+        EXPECT_EQ(actual.allowedActions.size(), 2);
+        EXPECT_EQ(actual.types, expected.types);
+        EXPECT_EQ(actual.motifWMHints.flags, uint32_t(MotifHintFunctions));
+        EXPECT_EQ(actual.motifWMHints.functions, uint32_t(MotifFunctionClose));
+    }
+}
+
+TEST_F(X11WindowPropertiesTest, OnlyRequestedPropertiesFetched)
+{
+    const auto properties = batchProperties(WindowNameProperty | WindowStateProperty);
+    ASSERT_EQ(properties.size(), m_windows.size());
+
+    const auto &actual = properties.first();
+    EXPECT_EQ(actual.properties, uint(WindowNameProperty | WindowStateProperty));
+    EXPECT_EQ(actual.name, "window 0");
+    EXPECT_FALSE(actual.state.isEmpty());
+    EXPECT_EQ(actual.pid, 0);
+    EXPECT_TRUE(actual.wmClass.isEmpty());
+    EXPECT_TRUE(actual.icon.isEmpty());
+    EXPECT_TRUE(actual.types.isEmpty());
+}
+
+// the store is used without a display.
+TEST(X11WindowIconStoreTest, EntryMatchesRequestedSize)
+{
+    const xcb_window_t window = 0x1234;
+    // entries of 16, 64 and 32 pixels, every entry is filled by its size.
+    QList<uint32_t> data;
+    for (uint32_t size : {16, 64, 32}) {
+        data << size << size;
+        data.append(QList<uint32_t>(size * size, 0xff000000 + size));
+    }
+
+    auto store = X11WindowIconStore::instance();
+    const auto url = store->insert(window, data.constData(), data.size());
+    ASSERT_TRUE(url.startsWith("image://" + X11WindowIconStore::providerId() + "/"));
+    const auto id = X11WindowIconStore::idOfUrl(url);
+    EXPECT_EQ(store->insert(window, data.constData(), data.size()), url);
+
+    auto image = store->image(id, QSize(24, 24));
+    EXPECT_EQ(image.size(), QSize(32, 32));
+    EXPECT_EQ(image.pixel(0, 0), 0xff000000 + 32);
+    EXPECT_EQ(store->image(id, QSize(32, 32)).size(), QSize(32, 32));
+    EXPECT_EQ(store->image(id, QSize(16, 16)).size(), QSize(16, 16));
+    // the largest entry for a size which isn't covered or isn't given.
+    EXPECT_EQ(store->image(id, QSize(128, 128)).size(), QSize(64, 64));
+    EXPECT_EQ(store->image(id, {}).size(), QSize(64, 64));
+
+    // the url changes with the content.
+    data.last() = 0;
+    const auto changedUrl = store->insert(window, data.constData(), data.size());
+    EXPECT_NE(changedUrl, url);
+
+    // a truncated entry is ignored.
+    data.resize(2 + 16 * 16 + 2 + 10);
+    EXPECT_EQ(store->image(X11WindowIconStore::idOfUrl(store->insert(window, data.constData(), data.size())), {}).size(), QSize(16, 16));
+
+    store->remove(window);
+    EXPECT_TRUE(store->image(id, {}).isNull());
+    EXPECT_TRUE(store->insert(window, nullptr, 0).isEmpty());
+}
+
+// the cost of adding the windows, i.e. fetching all their properties.
+TEST_F(X11WindowPropertiesTest, WindowAddLatency)
+{
+    qint64 sequential = std::numeric_limits<qint64>::max();
+    qint64 batch = std::numeric_limits<qint64>::max();
+    QElapsedTimer timer;
+    for (int round = 0; round < LatencyRounds; ++round) {
+        timer.start();
+        for (auto window : std::as_const(m_windows)) {
+            sequentialProperties(window);
+        }
+        sequential = std::min(sequential, timer.nsecsElapsed());
+
+        timer.start();
+        batchProperties(AllWindowProperties);
+        batch = std::min(batch, timer.nsecsElapsed());
+    }
+
+    const auto sequentialUs = sequential / 1000 / WindowCount;
+    const auto batchUs = batch / 1000 / WindowCount;
+    RecordProperty("windows", WindowCount);
+    RecordProperty("sequential_us_per_window", static_cast<int>(sequentialUs));
+    RecordProperty("batch_us_per_window", static_cast<int>(batchUs));
+    qInfo() << "window add latency of" << WindowCount << "windows, sequential:" << sequentialUs
+            << "us per window, batch:" << batchUs << "us per window";
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    // the tests run against a private Xvfb, they're skipped if it's missing.
+    QProcess xvfb;
+    bool hasDisplay = false;
+    const auto program = QStandardPaths::findExecutable("Xvfb");
+    if (!testing::GTEST_FLAG(list_tests) && !program.isEmpty()) {
+        xvfb.start(program, {"-displayfd", "1", "-screen", "0", "1024x768x24", "-nolisten", "tcp"});
+        if (xvfb.waitForReadyRead(10000)) {
+            qputenv("DISPLAY", ":" + xvfb.readLine().trimmed());
+            hasDisplay = true;
+        }
+    }
+    qputenv("QT_QPA_PLATFORM", hasDisplay ? "xcb" : "offscreen");
+
+    int ret = 0;
+    {
+        QGuiApplication app(argc, argv);
+        ret = RUN_ALL_TESTS();
+    }
+
+    xvfb.terminate();
+    xvfb.waitForFinished();
+    return ret;
+}
@@ -0,0 +1,432 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Load generator of the notification server, it starts a private dbus-daemon, loads the server applet
+// and fires a storm of Notify, replace, close and action calls at the target rate,
+// the latency percentiles, the written rows and the rss growth are reported as json.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+#include "dbaccessor.h"
+#include "notifyentity.h"
+#include "notifyentitychannel.h"
+#include "notifyserverapplet.h"
+
+using namespace notification;
+
+static const QString NotificationsService("org.freedesktop.Notifications");
+static const QString NotificationsPath("/org/freedesktop/Notifications");
+static const QString NotificationsInterface("org.freedesktop.Notifications");
+static const QString DDENotificationService("org.deepin.dde.Notification1");
+static const QString DDENotificationPath("/org/deepin/dde/Notification1");
+static const QString DDENotificationInterface("org.deepin.dde.Notification1");
+
+enum Operation {
+    NotifyOperation = 0,
+    ReplaceOperation,
+    CloseOperation,
+    ActionOperation,
+    OperationCount
+};
+
+static const char *const OperationNames[OperationCount] = {"notify", "replace", "close", "action"};
+
+struct Options
+{
+    int rate = 200;
+    int durationMs = 10000;
+    int drainMs = 2000;
+    int appCount = 8;
+    int expireTimeout = 1000;
+    int weights[OperationCount] = {70, 15, 10, 5};
+    QString output;
+};
+
+struct Samples
+{
+    QList<qint64> latencies;
+    int errors = 0;
+    int skipped = 0;
+};
+
+// dbus-daemon owned by the benchmark, the server never touches the session bus of the user.
+class PrivateBus
+{
+public:
+    ~PrivateBus()
+    {
+        if (m_process.state() != QProcess::NotRunning) {
+            m_process.terminate();
+            if (!m_process.waitForFinished(1000))
+                m_process.kill();
+        }
+    }
+
+    bool start()
+    {
+        m_process.start("dbus-daemon", {"--session", "--nofork", "--nopidfile", "--print-address"});
+        if (!m_process.waitForStarted(3000)) {
+            qWarning() << "Failed on starting dbus-daemon:" << m_process.errorString();
+            return false;
+        }
+        while (!m_process.canReadLine()) {
+            if (!m_process.waitForReadyRead(3000)) {
+                qWarning() << "dbus-daemon doesn't print its address.";
+                return false;
+            }
+        }
+        m_address = QString::fromUtf8(m_process.readLine()).trimmed();
+        return !m_address.isEmpty();
+    }
+
+    QString address() const { return m_address; }
+
+private:
+    QProcess m_process;
+    QString m_address;
+};
+
+// ids of the entities shown as bubbles, the action calls need them.
+class EntityIds
+{
+public:
+    void insert(uint bubbleId, qint64 id)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_ids.insert(bubbleId, id);
+    }
+
+    qint64 take(uint bubbleId)
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_ids.take(bubbleId);
+    }
+
+private:
+    QMutex m_mutex;
+    QHash<uint, qint64> m_ids;
+};
+
+static qint64 residentSetSize()
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    while (!file.atEnd()) {
+        const auto line = file.readLine();
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return -1;
+}
+
+static qint64 percentile(const QList<qint64> &sorted, double ratio)
+{
+    if (sorted.isEmpty())
+        return 0;
+
+    const auto index = static_cast<qsizetype>(std::ceil(ratio * sorted.size())) - 1;
+    return sorted.at(std::clamp<qsizetype>(index, 0, sorted.size() - 1));
+}
+
+static QJsonObject summarize(Samples samples)
+{
+    std::sort(samples.latencies.begin(), samples.latencies.end());
+    QJsonObject ret;
+    ret["count"] = samples.latencies.size();
+    ret["errors"] = samples.errors;
+    ret["skipped"] = samples.skipped;
+    ret["p50_us"] = percentile(samples.latencies, 0.5) / 1000;
+    ret["p99_us"] = percentile(samples.latencies, 0.99) / 1000;
+    ret["p999_us"] = percentile(samples.latencies, 0.999) / 1000;
+    ret["max_us"] = samples.latencies.isEmpty() ? 0 : samples.latencies.last() / 1000;
+    return ret;
+}
+
+static bool parseMix(const QString &mix, Options &options)
+{
+    int weights[OperationCount] = {0, 0, 0, 0};
+    for (const auto &item : mix.split(',', Qt::SkipEmptyParts)) {
+        const auto pair = item.split('=');
+        if (pair.size() != 2)
+            return false;
+
+        const auto iter = std::find(std::begin(OperationNames), std::end(OperationNames), pair.first().trimmed());
+        bool ok = false;
+        const int weight = pair.last().toInt(&ok);
+        if (iter == std::end(OperationNames) || !ok || weight < 0)
+            return false;
+        weights[iter - std::begin(OperationNames)] = weight;
+    }
+    if (std::all_of(std::begin(weights), std::end(weights), [](int weight) { return weight == 0; }))
+        return false;
+
+    std::copy(std::begin(weights), std::end(weights), options.weights);
+    return true;
+}
+
+static Operation pickOperation(const Options &options)
+{
+    int total = 0;
+    for (auto weight : options.weights)
+        total += weight;
+
+    int value = QRandomGenerator::global()->bounded(total);
+    for (int i = 0; i < OperationCount; i++) {
+        if (value < options.weights[i])
+            return static_cast<Operation>(i);
+        value -= options.weights[i];
+    }
+    return NotifyOperation;
+}
+
+static QDBusMessage notifyMessage(const Options &options, quint64 sequence, uint replacesId)
+{
+    auto message = QDBusMessage::createMethodCall(NotificationsService, NotificationsPath, NotificationsInterface, "Notify");
+    const auto appName = QString("benchmark-app-%1").arg(sequence % options.appCount);
+    message << appName << replacesId << QString("dialog-information")
+            << QString("Summary %1").arg(sequence) << QString("Body of the notification %1").arg(sequence)
+            << QStringList{"default", "Open"} << QVariantMap() << options.expireTimeout;
+    return message;
+}
+
+// requests are sent at fixed instants, the latency is measured from the instant a request is due,
+// so a stalled server is charged for the requests queued behind it.
+static QList<Samples> runLoad(const Options &options, QDBusConnection connection, NotifyServerApplet *applet, EntityIds *entityIds)
+{
+    QList<Samples> samples(OperationCount);
+    QList<uint> liveBubbles;
+    const qint64 interval = 1000000000LL / options.rate;
+    const qint64 total = static_cast<qint64>(options.rate) * options.durationMs / 1000;
+
+    QElapsedTimer clock;
+    clock.start();
+    for (qint64 sequence = 0; sequence < total; sequence++) {
+        const qint64 due = sequence * interval;
+        const qint64 wait = due - clock.nsecsElapsed();
+        if (wait > 0)
+            QThread::usleep(static_cast<unsigned long>(wait / 1000));
+
+        auto operation = pickOperation(options);
+        if (operation != NotifyOperation && liveBubbles.isEmpty()) {
+            samples[operation].skipped++;
+            operation = NotifyOperation;
+        }
+
+        bool ok = true;
+        switch (operation) {
+        case NotifyOperation:
+        case ReplaceOperation: {
+            const uint replacesId = operation == ReplaceOperation ? liveBubbles.at(QRandomGenerator::global()->bounded(liveBubbles.size())) : 0;
+            const QDBusReply<uint> reply = connection.call(notifyMessage(options, sequence, replacesId));
+            ok = reply.isValid();
+            if (ok && operation == NotifyOperation && reply.value() > 0) {
+                liveBubbles << reply.value();
+            }
+            break;
+        }
+        case CloseOperation: {
+            const uint bubbleId = liveBubbles.takeAt(QRandomGenerator::global()->bounded(liveBubbles.size()));
+            auto message = QDBusMessage::createMethodCall(NotificationsService, NotificationsPath, NotificationsInterface, "CloseNotification");
+            message << bubbleId;
+            ok = connection.call(message).type() == QDBusMessage::ReplyMessage;
+            entityIds->take(bubbleId);
+            break;
+        }
+        case ActionOperation: {
+            const uint bubbleId = liveBubbles.takeAt(QRandomGenerator::global()->bounded(liveBubbles.size()));
+            const qint64 id = entityIds->take(bubbleId);
+            if (id <= 0) {
+                samples[operation].skipped++;
+                continue;
+            }
+            // actions are invoked by the bubble applet in the gui thread.
+            ok = QMetaObject::invokeMethod(applet, "actionInvoked", Qt::BlockingQueuedConnection,
+                                           Q_ARG(qint64, id), Q_ARG(uint, bubbleId), Q_ARG(QString, QString("default")));
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (!ok) {
+            samples[operation].errors++;
+            continue;
+        }
+        samples[operation].latencies << clock.nsecsElapsed() - due;
+    }
+    return samples;
+}
+
+static QJsonObject databaseStats(const QString &path)
+{
+    QJsonObject ret;
+    {
+        auto connection = QSqlDatabase::addDatabase("QSQLITE", "notification-benchmark");
+        connection.setDatabaseName(path);
+        connection.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (connection.open()) {
+            // ids are assigned in the order of insertion, rows removed since are still counted by it.
+            QSqlQuery query(connection);
+            if (query.exec("SELECT COUNT(*), IFNULL(MAX(ID), 0) FROM notifications3") && query.next()) {
+                ret["db_rows"] = query.value(0).toLongLong();
+                ret["db_rows_written"] = query.value(1).toLongLong();
+            }
+            connection.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("notification-benchmark");
+    return ret;
+}
+
+static QJsonObject serverCounters(QDBusConnection connection)
+{
+    QJsonObject ret;
+    for (const auto property : {"coalescedCount", "droppedCount"}) {
+        auto message = QDBusMessage::createMethodCall(DDENotificationService, DDENotificationPath, DDENotificationInterface, property);
+        const QDBusReply<qulonglong> reply = connection.call(message);
+        ret[property] = reply.isValid() ? static_cast<qint64>(reply.value()) : -1;
+    }
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("notification-benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Notification server load generator.");
+    parser.addHelpOption();
+    parser.addOption({"rate", "Requests per second.", "rate", "200"});
+    parser.addOption({"duration", "Duration of the load in ms.", "ms", "10000"});
+    parser.addOption({"drain", "Time in ms to wait for the server to settle after the load.", "ms", "2000"});
+    parser.addOption({"apps", "Number of distinct app names.", "count", "8"});
+    parser.addOption({"expire", "Expire timeout of the notifications in ms.", "ms", "1000"});
+    parser.addOption({"mix", "Weights of the operations.", "mix", "notify=70,replace=15,close=10,action=5"});
+    parser.addOption({"output", "Json file of the result, it's printed if it's empty.", "file"});
+    parser.process(app);
+
+    Options options;
+    options.rate = parser.value("rate").toInt();
+    options.durationMs = parser.value("duration").toInt();
+    options.drainMs = parser.value("drain").toInt();
+    options.appCount = parser.value("apps").toInt();
+    options.expireTimeout = parser.value("expire").toInt();
+    options.output = parser.value("output");
+    if (options.rate <= 0 || options.durationMs <= 0 || options.appCount <= 0 || !parseMix(parser.value("mix"), options)) {
+        qWarning() << "Invalid options.";
+        return 2;
+    }
+
+    // the database and the images are written to a scratch dir.
+    QTemporaryDir dataDir;
+    const auto dbPath = dataDir.filePath("data.db");
+    qputenv("DS_NOTIFICATION_DB_PATH", dbPath.toUtf8());
+    qputenv("DS_NOTIFICATION_IMAGE_PATH", dataDir.filePath("images").toUtf8());
+
+    PrivateBus bus;
+    if (!bus.start())
+        return 1;
+    // it must be set before the session bus is connected.
+    qputenv("DBUS_SESSION_BUS_ADDRESS", bus.address().toUtf8());
+
+    const auto rssStart = residentSetSize();
+    NotifyServerApplet applet;
+    if (!applet.init()) {
+        qWarning() << "Failed on initializing the notification server.";
+        return 1;
+    }
+
+    EntityIds entityIds;
+    QObject::connect(&applet, &NotifyServerApplet::notificationStateChanged, &applet, [&entityIds](qint64 id, int processedType) {
+        if (processedType != NotifyEntity::NotProcessed)
+            return;
+        const auto entity = NotifyEntityChannel::instance()->find(id, processedType);
+        if (entity.isValid()) {
+            entityIds.insert(entity.bubbleId(), id);
+        }
+    }, Qt::DirectConnection);
+
+    auto client = QDBusConnection::connectToBus(bus.address(), "notification-benchmark-client");
+    QList<Samples> samples;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    auto loader = QThread::create([&] {
+        samples = runLoad(options, client, &applet, &entityIds);
+    });
+    QObject::connect(loader, &QThread::finished, &app, [&app, &options] {
+        QTimer::singleShot(options.drainMs, &app, &QCoreApplication::quit);
+    });
+    loader->start();
+    app.exec();
+    loader->wait();
+    delete loader;
+    const auto elapsedMs = elapsed.elapsed();
+
+    DBAccessor::instance()->sync();
+    const auto rssEnd = residentSetSize();
+
+    QJsonObject operations;
+    Samples all;
+    for (int i = 0; i < OperationCount; i++) {
+        operations[OperationNames[i]] = summarize(samples.value(i));
+        all.latencies << samples.value(i).latencies;
+        all.errors += samples.value(i).errors;
+        all.skipped += samples.value(i).skipped;
+    }
+
+    QJsonObject result;
+    result["rate"] = options.rate;
+    result["duration_ms"] = options.durationMs;
+    result["elapsed_ms"] = elapsedMs;
+    result["apps"] = options.appCount;
+    result["mix"] = parser.value("mix");
+    result["operations"] = operations;
+    result["total"] = summarize(all);
+    result["rss_start_kb"] = rssStart;
+    result["rss_end_kb"] = rssEnd;
+    result["rss_growth_kb"] = rssEnd - rssStart;
+    const auto database = databaseStats(dbPath);
+    for (auto iter = database.begin(); iter != database.end(); ++iter)
+        result[iter.key()] = iter.value();
+    const auto counters = serverCounters(client);
+    for (auto iter = counters.begin(); iter != counters.end(); ++iter)
+        result[iter.key()] = iter.value();
+
+    const auto json = QJsonDocument(result).toJson(QJsonDocument::Indented);
+    if (options.output.isEmpty()) {
+        QTextStream(stdout) << json;
+    } else {
+        QFile file(options.output);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "Failed on writing the result:" << options.output;
+            return 1;
+        }
+        file.write(json);
+    }
+    return 0;
+}
@@ -0,0 +1,425 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <memory>
+
+#include "dbaccessor.h"
+#include "notifyentity.h"
+
+using namespace notification;
+
+namespace {
+// legacy rows are migrated in slices of 1000, the fixture spans several of them.
+const int LegacyCount = 2500;
+const qint64 BaseTime = 1700000000000;
+
+template<typename Predicate>
+bool waitFor(Predicate predicate, int timeout = 10000)
+{
+    QDeadlineTimer deadline(timeout);
+    while (!predicate()) {
+        if (deadline.hasExpired())
+            return false;
+        QThread::msleep(20);
+    }
+    return true;
+}
+
+class DBAccessorTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(m_dir.isValid());
+        m_path = m_dir.filePath("data.db");
+        qputenv("DS_NOTIFICATION_DB_PATH", m_path.toLocal8Bit());
+    }
+
+    void TearDown() override
+    {
+        m_accessor.reset();
+        qunsetenv("DS_NOTIFICATION_DB_PATH");
+    }
+
+    DBAccessor *openAccessor()
+    {
+        static int count = 0;
+        m_accessor.reset(new DBAccessor(QString("test%1").arg(++count)));
+        return m_accessor.get();
+    }
+
+    static NotifyEntity createEntity(int index, const QString &appName = "app", const QString &body = {})
+    {
+        NotifyEntity entity(appName, 0, "icon", QString("summary %1").arg(index), body.isEmpty() ? QString("body %1").arg(index) : body,
+                            {"default", "Open"}, {{"urgency", 1}}, -1);
+        entity.setCTime(BaseTime + index);
+        entity.setBubbleId(index + 1);
+        entity.setProcessedType(NotifyEntity::Processed);
+        return entity;
+    }
+
+    // runs a query on a separate connection, it sees what the accessor committed.
+    QVariant queryValue(const QString &sql)
+    {
+        QVariant ret;
+        {
+            QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", "inspect");
+            connection.setDatabaseName(m_path);
+            if (connection.open()) {
+                QSqlQuery query(connection);
+                if (query.exec(sql) && query.next())
+                    ret = query.value(0);
+            }
+        }
+        QSqlDatabase::removeDatabase("inspect");
+        return ret;
+    }
+
+    qint64 usedBytes()
+    {
+        return (queryValue("PRAGMA page_count").toLongLong() - queryValue("PRAGMA freelist_count").toLongLong())
+            * queryValue("PRAGMA page_size").toLongLong();
+    }
+
+    void createLegacyFixture()
+    {
+        {
+            QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", "fixture");
+            connection.setDatabaseName(m_path);
+            ASSERT_TRUE(connection.open());
+            QSqlQuery query(connection);
+            // the schema v2 stores numbers as text.
+            ASSERT_TRUE(query.exec("CREATE TABLE notifications2(ID INTEGER PRIMARY KEY AUTOINCREMENT, Icon TEXT, Summary TEXT, Body TEXT, "
+                                   "AppName TEXT, AppId TEXT, CTime TEXT, Action TEXT, Hint TEXT, ReplacesId TEXT, NotifyId TEXT, "
+                                   "Timeout TEXT, ProcessedType INTEGER)"))
+                << query.lastError().text().toStdString();
+            ASSERT_TRUE(connection.transaction());
+            ASSERT_TRUE(query.prepare("INSERT INTO notifications2(Icon, Summary, Body, AppName, AppId, CTime, Action, Hint, ReplacesId, "
+                                      "NotifyId, Timeout, ProcessedType) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+            for (int i = 0; i < LegacyCount; ++i) {
+                query.addBindValue("icon");
+                query.addBindValue(QString("legacy %1").arg(i));
+                query.addBindValue(QString("body %1").arg(i));
+                query.addBindValue(i % 2 ? "odd" : "even");
+                query.addBindValue(i % 2 ? "odd" : "even");
+                query.addBindValue(QString::number(BaseTime + i));
+                query.addBindValue("default|Open");
+                query.addBindValue("urgency!!!1");
+                query.addBindValue("0");
+                query.addBindValue(QString::number(i + 1));
+                query.addBindValue("-1");
+                // rows of old versions have no processed type, they're processed ones.
+                query.addBindValue(i % 10 == 0 ? QVariant() : QVariant(int(NotifyEntity::Processed)));
+                ASSERT_TRUE(query.exec()) << query.lastError().text().toStdString();
+            }
+            ASSERT_TRUE(connection.commit());
+        }
+        QSqlDatabase::removeDatabase("fixture");
+    }
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    std::unique_ptr<DBAccessor> m_accessor;
+};
+}
+
+TEST_F(DBAccessorTest, MigrateLegacyTable)
+{
+    createLegacyFixture();
+    auto accessor = openAccessor();
+
+    // the rows are readable while they're being migrated.
+    EXPECT_EQ(accessor->fetchEntityCount(DataAccessor::AllApp(), NotifyEntity::Processed), LegacyCount);
+
+    ASSERT_TRUE(waitFor([this]() {
+        return queryValue("SELECT COUNT(*) FROM sqlite_master WHERE name = 'notifications2'").toInt() == 0;
+    })) << "legacy table isn't migrated";
+
+    EXPECT_EQ(queryValue("SELECT COUNT(*) FROM notifications3").toInt(), LegacyCount);
+    EXPECT_EQ(queryValue("SELECT COUNT(*) FROM notifications3 WHERE ProcessedType IS NULL").toInt(), 0);
+    EXPECT_EQ(queryValue("SELECT typeof(CTime) FROM notifications3 LIMIT 1").toString(), "integer");
+
+    EXPECT_EQ(accessor->fetchEntityCount(DataAccessor::AllApp(), NotifyEntity::Processed), LegacyCount);
+    EXPECT_EQ(accessor->fetchEntityCount("even", NotifyEntity::Processed), LegacyCount / 2);
+
+    // times are ordered as numbers, not as text.
+    const auto entities = accessor->fetchEntities("even", NotifyEntity::Processed, 3);
+    ASSERT_EQ(entities.size(), 3);
+    EXPECT_EQ(entities[0].summary(), QString("legacy %1").arg(LegacyCount - 2));
+    EXPECT_EQ(entities[0].cTime(), BaseTime + LegacyCount - 2);
+    EXPECT_EQ(entities[0].actions(), QStringList({"default", "Open"}));
+    EXPECT_EQ(entities[0].hints().value("urgency").toString(), "1");
+    EXPECT_GT(entities[0].cTime(), entities[1].cTime());
+
+    const auto first = accessor->fetchEntity(1);
+    EXPECT_EQ(first.summary(), "legacy 0");
+    EXPECT_EQ(first.processedType(), NotifyEntity::Processed);
+
+    // ids of new rows follow the legacy ones.
+    EXPECT_GT(accessor->addEntity(createEntity(LegacyCount)), LegacyCount);
+}
+
+TEST_F(DBAccessorTest, ReadsSeeQueuedWrites)
+{
+    auto accessor = openAccessor();
+
+    QList<qint64> ids;
+    for (int i = 0; i < 100; ++i) {
+        ids << accessor->addEntity(createEntity(i));
+    }
+    // no sync, the queued writes of the id are applied to the snapshot.
+    const auto last = accessor->fetchEntity(ids.last());
+    EXPECT_EQ(last.summary(), "summary 99");
+    EXPECT_EQ(last.actions(), QStringList({"default", "Open"}));
+    EXPECT_EQ(last.hints().value("urgency").toInt(), 1);
+
+    auto replaced = createEntity(5);
+    replaced.setSummary("replaced");
+    accessor->replaceEntity(ids[5], replaced);
+    EXPECT_EQ(accessor->fetchEntity(ids[5]).summary(), "replaced");
+
+    accessor->updateEntityProcessedType(ids[6], NotifyEntity::NotProcessed);
+    EXPECT_EQ(accessor->fetchEntity(ids[6]).processedType(), NotifyEntity::NotProcessed);
+
+    accessor->removeEntity(ids[7]);
+    EXPECT_FALSE(accessor->fetchEntity(ids[7]).isValid());
+    accessor->replaceEntity(ids[7], replaced);
+    EXPECT_FALSE(accessor->fetchEntity(ids[7]).isValid());
+
+    accessor->removeEntityByApp("other");
+    EXPECT_TRUE(accessor->fetchEntity(ids[8]).isValid());
+
+    // the last entity of the app skips the removed ones and finds the queued ones.
+    accessor->removeEntity(ids[99]);
+    EXPECT_EQ(accessor->fetchLastEntity("app", NotifyEntity::Processed).id(), ids[98]);
+    const auto newId = accessor->addEntity(createEntity(200));
+    EXPECT_EQ(accessor->fetchLastEntity("app", NotifyEntity::Processed).id(), newId);
+
+    // lists are read from the committed snapshot.
+    accessor->sync();
+    EXPECT_EQ(accessor->fetchEntityCount("app", NotifyEntity::Processed), 98);
+    EXPECT_EQ(accessor->fetchEntityCount("app", NotifyEntity::NotProcessed), 1);
+    EXPECT_EQ(accessor->fetchLastEntity("app", NotifyEntity::Processed).id(), newId);
+    EXPECT_EQ(accessor->fetchEntity(ids[5]).summary(), "replaced");
+    EXPECT_FALSE(accessor->fetchEntity(ids[7]).isValid());
+
+    // the queue holds the values of the entity, later changes of it aren't written.
+    auto entity = createEntity(100);
+    const auto id = accessor->addEntity(entity);
+    entity.setSummary("changed");
+    EXPECT_EQ(accessor->fetchEntity(id).summary(), "summary 100");
+}
+
+// reads of other threads go through their own read only connections.
+TEST_F(DBAccessorTest, ReaderThreadsSeeCommittedWrites)
+{
+    auto accessor = openAccessor();
+
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            accessor->addEntity(createEntity(round * 100 + i));
+        }
+        accessor->sync();
+
+        int count = 0;
+        int repeatedCount = 0;
+        qint64 hits = 0;
+        qint64 repeatedHits = 0;
+        QString lastSummary;
+        std::unique_ptr<QThread> reader(QThread::create([&]() {
+            count = accessor->fetchEntityCount("app", NotifyEntity::Processed);
+            const auto entities = accessor->fetchEntities("app", NotifyEntity::Processed, 1);
+            if (!entities.isEmpty())
+                lastSummary = entities.first().summary();
+            // the statement prepared by the first call is reused.
+            hits = accessor->statementCacheHits();
+            repeatedCount = accessor->fetchEntityCount("app", NotifyEntity::Processed);
+            repeatedHits = accessor->statementCacheHits();
+        }));
+        reader->start();
+        ASSERT_TRUE(reader->wait(10000));
+        EXPECT_EQ(count, round * 50);
+        EXPECT_EQ(repeatedCount, count);
+        EXPECT_EQ(lastSummary, QString("summary %1").arg(round * 100 + 49));
+        // statements of the reader connections are cached as well.
+        EXPECT_GT(repeatedHits, hits);
+    }
+}
+
+TEST_F(DBAccessorTest, TrimByCount)
+{
+    auto accessor = openAccessor();
+
+    QList<qint64> ids;
+    for (int i = 0; i < 1200; ++i) {
+        ids << accessor->addEntity(createEntity(i));
+    }
+    accessor->sync();
+
+    QMutex mutex;
+    QList<EntityCount> removed;
+    accessor->setRemovedHandler([&](const QList<EntityCount> &counts) {
+        QMutexLocker locker(&mutex);
+        removed << counts;
+    });
+    RetentionPolicy policy;
+    policy.maxCount = 1000;
+    accessor->setRetentionPolicy(policy);
+    accessor->compact(false);
+
+    ASSERT_TRUE(waitFor([accessor]() {
+        return accessor->fetchEntityCount("app", NotifyEntity::Processed) <= 1000;
+    }));
+    EXPECT_EQ(accessor->fetchEntityCount("app", NotifyEntity::Processed), 1000);
+    // the oldest rows are removed.
+    EXPECT_FALSE(accessor->fetchEntity(ids[199]).isValid());
+    EXPECT_TRUE(accessor->fetchEntity(ids[200]).isValid());
+    EXPECT_TRUE(accessor->fetchEntity(ids.last()).isValid());
+
+    // the handler is told how many rows of each app are removed.
+    auto removedCount = [&]() {
+        QMutexLocker locker(&mutex);
+        int count = 0;
+        for (const auto &item : std::as_const(removed)) {
+            EXPECT_EQ(item.appName, "app");
+            EXPECT_EQ(item.processedType, NotifyEntity::Processed);
+            count += item.count;
+        }
+        return count;
+    };
+    ASSERT_TRUE(waitFor([&]() {
+        return removedCount() >= 200;
+    }));
+    // the handler refers to the locals.
+    accessor->setRemovedHandler({});
+    EXPECT_EQ(removedCount(), 200);
+}
+
+TEST_F(DBAccessorTest, RemoveExpiredReportsCounts)
+{
+    auto accessor = openAccessor();
+
+    for (int i = 0; i < 100; ++i) {
+        accessor->addEntity(createEntity(i, i % 2 ? "odd" : "even"));
+    }
+
+    QMutex mutex;
+    QHash<QString, int> counts;
+    accessor->setRemovedHandler([&](const QList<EntityCount> &removed) {
+        QMutexLocker locker(&mutex);
+        for (const auto &item : removed) {
+            EXPECT_EQ(item.processedType, NotifyEntity::Processed);
+            counts[item.appName] += item.count;
+        }
+    });
+    accessor->removeEntitiesByExpiredTime(BaseTime + 50);
+
+    // the handler is called in the thread which commits the write.
+    ASSERT_TRUE(waitFor([&]() {
+        QMutexLocker locker(&mutex);
+        return counts.value("even") + counts.value("odd") >= 50;
+    }));
+    // the handler refers to the locals.
+    accessor->setRemovedHandler({});
+    QMutexLocker locker(&mutex);
+    EXPECT_EQ(counts.value("even"), 25);
+    EXPECT_EQ(counts.value("odd"), 25);
+    EXPECT_EQ(accessor->fetchEntityCount(DataAccessor::AllApp(), NotifyEntity::Processed), 50);
+}
+
+TEST_F(DBAccessorTest, TrimByBytes)
+{
+    auto accessor = openAccessor();
+
+    const int count = 1000;
+    QList<qint64> ids;
+    for (int i = 0; i < count; ++i) {
+        ids << accessor->addEntity(createEntity(i, "app", QString("body %1 ").arg(i).repeated(250)));
+    }
+    accessor->sync();
+
+    const auto maxBytes = usedBytes() * 4 / 5;
+    ASSERT_GT(maxBytes, 0);
+    RetentionPolicy policy;
+    policy.maxBytes = maxBytes;
+    accessor->setRetentionPolicy(policy);
+    accessor->compact(false);
+
+    ASSERT_TRUE(waitFor([this, maxBytes]() {
+        return usedBytes() <= maxBytes;
+    }));
+    const auto remained = accessor->fetchEntityCount("app", NotifyEntity::Processed);
+    EXPECT_GT(remained, 0);
+    EXPECT_LT(remained, count);
+    EXPECT_FALSE(accessor->fetchEntity(ids.first()).isValid());
+    EXPECT_TRUE(accessor->fetchEntity(ids.last()).isValid());
+}
+
+TEST_F(DBAccessorTest, Search)
+{
+    auto accessor = openAccessor();
+
+    QList<qint64> ids;
+    for (int i = 0; i < 120; ++i) {
+        ids << accessor->addEntity(createEntity(i, i % 3 ? "app" : "other", QString("%1 message %2").arg(i % 2 ? "odd" : "even").arg(i)));
+    }
+    accessor->sync();
+
+    // the newest matches come first, the next page starts after the id of the last one.
+    auto page = accessor->search("even message", DataAccessor::AllApp(), 50, 0);
+    ASSERT_EQ(page.size(), 50);
+    EXPECT_EQ(page.first().id(), ids[118]);
+    EXPECT_EQ(page.last().id(), ids[20]);
+    page = accessor->search("even message", DataAccessor::AllApp(), 50, page.last().id());
+    ASSERT_EQ(page.size(), 10);
+    EXPECT_EQ(page.first().id(), ids[18]);
+    EXPECT_EQ(page.last().id(), ids[0]);
+    EXPECT_TRUE(accessor->search("even message", DataAccessor::AllApp(), 50, page.last().id()).isEmpty());
+
+    // the app and the summary are matched too.
+    page = accessor->search("even", "other", 100, 0);
+    EXPECT_EQ(page.size(), 20);
+    EXPECT_EQ(accessor->search("summary 117", DataAccessor::AllApp(), 10, 0).value(0).id(), ids[117]);
+
+    // the index follows the updated and the removed rows.
+    auto replaced = createEntity(118, "app", "renamed message");
+    accessor->replaceEntity(ids[118], replaced);
+    accessor->sync();
+    EXPECT_EQ(accessor->search("renamed", DataAccessor::AllApp(), 10, 0).value(0).id(), ids[118]);
+    EXPECT_EQ(accessor->search("even message", DataAccessor::AllApp(), 100, 0).size(), 59);
+
+    accessor->removeEntity(ids[116]);
+    accessor->sync();
+    page = accessor->search("even message", DataAccessor::AllApp(), 100, 0);
+    EXPECT_EQ(page.size(), 58);
+    EXPECT_EQ(page.first().id(), ids[114]);
+
+    // only processed notifications are found.
+    accessor->updateEntityProcessedType(ids[114], NotifyEntity::NotProcessed);
+    accessor->sync();
+    EXPECT_EQ(accessor->search("even message", DataAccessor::AllApp(), 100, 0).value(0).id(), ids[112]);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    // sql drivers are loaded as plugins, they need the application.
+    QCoreApplication app(argc, argv);
+    // the image store is shared by the tests, it mustn't write to the data dir of the user.
+    QTemporaryDir imageDir;
+    qputenv("DS_NOTIFICATION_IMAGE_PATH", imageDir.path().toLocal8Bit());
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QObject>
+
+#include "notifyentity.h"
+
+using namespace notification;
+
+namespace {
+// hints are demarshalled by D-Bus, the values of complex types are QDBusArgument.
+class HintsReceiver : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.deepin.dde.NotificationTest")
+public:
+    QVariantMap hints;
+
+public Q_SLOTS:
+    void Receive(const QVariantMap &hints) { this->hints = hints; }
+};
+
+const QString ReceiverPath = "/org/deepin/dde/NotificationTest";
+}
+
+TEST(NotifyEntityTest, EncodeStructHints)
+{
+    auto connection = QDBusConnection::sessionBus();
+    if (!connection.isConnected())
+        GTEST_SKIP() << "The session bus isn't available";
+
+    HintsReceiver receiver;
+    ASSERT_TRUE(connection.registerObject(ReceiverPath, &receiver, QDBusConnection::ExportAllSlots));
+
+    QDBusArgument structure;
+    structure.beginStructure();
+    structure << 7 << QString("seven") << QStringList{"a", "b"};
+    structure.endStructure();
+    QDBusArgument map;
+    map.beginMap(QMetaType::fromType<QString>(), QMetaType::fromType<int>());
+    map.beginMapEntry();
+    map << QString("count") << 3;
+    map.endMapEntry();
+    map.endMap();
+
+    // calls of the own connection are marshalled as they're sent to the bus.
+    auto message = QDBusMessage::createMethodCall(connection.baseService(), ReceiverPath, "org.deepin.dde.NotificationTest", "Receive");
+    message << QVariantMap{{"x-struct", QVariant::fromValue(structure)}, {"x-map", QVariant::fromValue(map)}, {"urgency", QVariant::fromValue<uchar>(1)}};
+    const auto reply = connection.call(message);
+    connection.unregisterObject(ReceiverPath);
+    ASSERT_NE(reply.type(), QDBusMessage::ErrorMessage) << reply.errorMessage().toStdString();
+    ASSERT_EQ(receiver.hints.value("x-struct").typeId(), qMetaTypeId<QDBusArgument>());
+
+    const auto hints = NotifyEntity::decodeHints(NotifyEntity::encodeHints(receiver.hints));
+    const auto fields = hints.value("x-struct").toList();
+    ASSERT_EQ(fields.size(), 3);
+    EXPECT_EQ(fields.at(0).toInt(), 7);
+    EXPECT_EQ(fields.at(1).toString(), "seven");
+    EXPECT_EQ(fields.at(2).toStringList(), QStringList({"a", "b"}));
+    EXPECT_EQ(hints.value("x-map").toMap().value("count").toInt(), 3);
+    EXPECT_EQ(hints.value("urgency").toInt(), 1);
+}
+
+#include "notifyentity_test.moc"
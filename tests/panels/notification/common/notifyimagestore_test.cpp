@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QThread>
+
+#include "notifyimagestore.h"
+
+using namespace notification;
+
+namespace {
+QString imagePath(const QString &key)
+{
+    return QDir(qEnvironmentVariable("DS_NOTIFICATION_IMAGE_PATH")).filePath(key + ".png");
+}
+
+QImage createImage(QRgb color)
+{
+    QImage image(8, 8, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+}
+
+TEST(NotifyImageStoreTest, SavePendingImages)
+{
+    auto store = NotifyImageStore::instance();
+    const auto image = createImage(qRgb(255, 0, 0));
+    const auto key = store->insert(image);
+    ASSERT_FALSE(key.isEmpty());
+    EXPECT_EQ(store->insert(image), key);
+
+    // it's served from memory until it's written.
+    EXPECT_TRUE(store->contains(key));
+    EXPECT_EQ(store->image(key), image);
+
+    // the store writes it by itself, without a flush of the database.
+    QDeadlineTimer deadline(10000);
+    while (!QFileInfo::exists(imagePath(key)) && !deadline.hasExpired()) {
+        QThread::msleep(10);
+    }
+    EXPECT_TRUE(QFileInfo::exists(imagePath(key)));
+    store->savePendingImages();
+    EXPECT_EQ(store->image(key), image);
+}
+
+TEST(NotifyImageStoreTest, KeyIgnoresScanlinePadding)
+{
+    // 3 RGB888 pixels take 9 bytes, the scanlines are padded to 12 bytes.
+    auto createPaddedImage = [](char padding) {
+        QImage image(3, 2, QImage::Format_RGB888);
+        for (int y = 0; y < image.height(); ++y) {
+            auto line = reinterpret_cast<char *>(image.scanLine(y));
+            for (int x = 0; x < image.bytesPerLine(); ++x) {
+                line[x] = x < image.width() * 3 ? char(x + y) : padding;
+            }
+        }
+        return image;
+    };
+    const auto firstImage = createPaddedImage(0x11);
+    const auto secondImage = createPaddedImage(0x22);
+    ASSERT_GT(firstImage.bytesPerLine(), firstImage.width() * 3);
+
+    auto store = NotifyImageStore::instance();
+    const auto key = store->insert(firstImage);
+    ASSERT_FALSE(key.isEmpty());
+    EXPECT_EQ(store->insert(secondImage), key);
+    store->savePendingImages();
+}
+
+TEST(NotifyImageStoreTest, RemoveUnusedImages)
+{
+    auto store = NotifyImageStore::instance();
+    const auto key = store->insert(createImage(qRgb(0, 255, 0)));
+    ASSERT_FALSE(key.isEmpty());
+    store->savePendingImages();
+
+    // images written by an earlier process.
+    const QString usedKey(40, 'a');
+    const QString unusedKey(40, 'b');
+    ASSERT_TRUE(createImage(qRgb(0, 0, 255)).save(imagePath(usedKey)));
+    ASSERT_TRUE(createImage(qRgb(0, 0, 255)).save(imagePath(unusedKey)));
+    EXPECT_TRUE(store->contains(unusedKey));
+
+    EXPECT_EQ(store->removeUnusedImages({usedKey}), 1);
+    EXPECT_TRUE(QFileInfo::exists(imagePath(usedKey)));
+    EXPECT_FALSE(QFileInfo::exists(imagePath(unusedKey)));
+    EXPECT_FALSE(store->contains(unusedKey));
+    // it's inserted recently, a notification which isn't stored yet may refer to it.
+    EXPECT_TRUE(QFileInfo::exists(imagePath(key)));
+}
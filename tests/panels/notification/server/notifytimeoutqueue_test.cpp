@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "notifytimeoutqueue.h"
+
+using namespace notification;
+
+static NotifyEntity createEntity(qint64 id, uint bubbleId)
+{
+    NotifyEntity entity(id, "test");
+    entity.setBubbleId(bubbleId);
+    return entity;
+}
+
+TEST(NotifyTimeoutQueueTest, ExpireInOrderOfDeadline)
+{
+    NotifyTimeoutQueue queue;
+    queue.push(300, createEntity(1, 1));
+    queue.push(100, createEntity(2, 2));
+    queue.push(200, createEntity(3, 3));
+    queue.push(100, createEntity(4, 4));
+
+    EXPECT_EQ(queue.nextDeadline(), 100);
+
+    const auto expired = queue.takeExpired(200);
+    ASSERT_EQ(expired.size(), 3);
+    EXPECT_EQ(expired[0].id(), 2);
+    EXPECT_EQ(expired[1].id(), 4);
+    EXPECT_EQ(expired[2].id(), 3);
+    EXPECT_EQ(queue.size(), 1);
+    EXPECT_EQ(queue.nextDeadline(), 300);
+}
+
+TEST(NotifyTimeoutQueueTest, RemoveAndReschedule)
+{
+    NotifyTimeoutQueue queue;
+    for (int i = 1; i <= 100; i++) {
+        queue.push(i * 10, createEntity(i, i % 10));
+    }
+
+    EXPECT_TRUE(queue.remove(1));
+    EXPECT_FALSE(queue.remove(1));
+    EXPECT_EQ(queue.nextDeadline(), 20);
+
+    EXPECT_TRUE(queue.reschedule(50, 5));
+    EXPECT_EQ(queue.nextDeadline(), 5);
+    EXPECT_EQ(queue.deadline(50), 5);
+
+    // pushing a pending entity again reschedules it.
+    queue.push(2000, createEntity(50, 0));
+    EXPECT_EQ(queue.deadline(50), 2000);
+    EXPECT_EQ(queue.size(), 99);
+
+    EXPECT_EQ(queue.removeByBubbleId(3), 10);
+    EXPECT_FALSE(queue.contains(13));
+
+    qint64 last = 0;
+    const auto expired = queue.takeExpired(std::numeric_limits<qint64>::max());
+    for (const auto &entity : expired) {
+        const auto point = entity.id() == 50 ? 2000 : entity.id() * 10;
+        EXPECT_GE(point, last);
+        last = point;
+    }
+    EXPECT_EQ(expired.size(), 89);
+    EXPECT_TRUE(queue.isEmpty());
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "notifytrace.h"
+
+using namespace notification;
+
+// the sequence of a dumped line, i.e. "time #sequence category ...".
+static quint64 sequenceOf(const QString &line)
+{
+    return line.section(' ', 1, 1).mid(1).toULongLong();
+}
+
+TEST(NotifyTraceTest, WrapAround)
+{
+    auto trace = NotifyTrace::instance();
+    ASSERT_TRUE(trace->setSampling("received", 1));
+
+    const int capacity = 1024;
+    const int extra = 10;
+    for (int i = 0; i < capacity + extra; i++) {
+        trace->received("test", 0, "body", {}, {}, -1);
+    }
+
+    const auto lines = trace->dump().split('\n');
+    ASSERT_EQ(lines.size(), capacity);
+    // the oldest records are overwritten, the rest are dumped in order.
+    const auto first = sequenceOf(lines.first());
+    EXPECT_GE(first, quint64(extra));
+    for (int i = 0; i < lines.size(); i++) {
+        EXPECT_EQ(sequenceOf(lines[i]), first + i);
+    }
+    EXPECT_TRUE(lines.last().contains("received"));
+    EXPECT_TRUE(lines.last().contains("appName:\"test\""));
+    EXPECT_TRUE(lines.last().contains("bodySize:4"));
+}
+
+TEST(NotifyTraceTest, Sampling)
+{
+    auto trace = NotifyTrace::instance();
+    EXPECT_FALSE(trace->setSampling("unknown", 1));
+
+    ASSERT_TRUE(trace->setSampling("closed", 4));
+    for (int i = 1; i <= 8; i++) {
+        trace->entity(NotifyTrace::ClosedCategory, i, 0);
+    }
+
+    // one of every 4 records is kept, starting with the first one.
+    const auto lines = trace->dump().split('\n');
+    ASSERT_GE(lines.size(), 2);
+    EXPECT_TRUE(lines[lines.size() - 2].contains("closed id:1 "));
+    EXPECT_TRUE(lines.last().contains("closed id:5 "));
+    EXPECT_EQ(sequenceOf(lines.last()), sequenceOf(lines[lines.size() - 2]) + 1);
+
+    // the category is disabled.
+    ASSERT_TRUE(trace->setSampling("closed", 0));
+    trace->entity(NotifyTrace::ClosedCategory, 9, 0);
+    EXPECT_EQ(trace->dump().split('\n').last(), lines.last());
+
+    ASSERT_TRUE(trace->setSampling("closed", 1));
+}